@@ -102,9 +102,30 @@ extern "C" {
 #define FENIX_DATA_MEMBER_ATTRIBUTE_SIZE     14
 #define FENIX_DATA_SNAPSHOT_LATEST           -1
 #define FENIX_DATA_SNAPSHOT_ALL              16
+#define FENIX_DATA_MEMBER_ATTRIBUTE_BUFFER_LIST 17
+#define FENIX_DATA_MEMBER_ATTRIBUTE_PARITY_UPDATE 18
+#define FENIX_DATA_PARITY_UPDATE_REDUCE       0
+#define FENIX_DATA_PARITY_UPDATE_DELTA        1
+#define FENIX_DATA_MEMBER_ATTRIBUTE_CHUNK_SIZE 19
+#define FENIX_DATA_MEMBER_ATTRIBUTE_SNAPSHOT_STORAGE 20
+#define FENIX_DATA_SNAPSHOT_STORAGE_FULL        0
+#define FENIX_DATA_SNAPSHOT_STORAGE_INCREMENTAL 1
+#define FENIX_DATA_MEMBER_ATTRIBUTE_DIRTY_TRACKING 21
+#define FENIX_DATA_MEMBER_ATTRIBUTE_CONTENT_HASH 22
+#define FENIX_DATA_MEMBER_ATTRIBUTE_SKIPPED_BYTES 23
+#define FENIX_DATA_MEMBER_ATTRIBUTE_COMPRESSION 24
+#define FENIX_DATA_COMPRESSION_NONE       0
+#define FENIX_DATA_COMPRESSION_SHUFFLE_LZ 1
+#define FENIX_DATA_MEMBER_ATTRIBUTE_NUMA_NODE 25
 #define FENIX_DATA_SUBSET_CREATED             2
 
 #define FENIX_DATA_POLICY_IN_MEMORY_RAID 13
+#define FENIX_DATA_POLICY_ERASURE_CODE   14
+#define FENIX_DATA_POLICY_LOCAL_DISK     15
+#define FENIX_DATA_POLICY_AGGREGATED_FILE 16
+//rank_separation of an in-memory RAID policy that picks partners by node
+//instead, on the nearest other nodes.
+#define FENIX_DATA_RANK_SEPARATION_AUTO  -1
 
 typedef enum {
     FENIX_ROLE_INITIAL_RANK = 0,
@@ -112,11 +133,29 @@ typedef enum {
     FENIX_ROLE_SURVIVOR_RANK = 2
 } Fenix_Rank_role;
 
+struct __fenix_data_request;
+
 typedef struct {
     MPI_Request mpi_send_req;
     MPI_Request mpi_recv_req;
+    struct __fenix_data_request *data_request;
 } Fenix_Request;
 
+struct __fenix_store_plan;
+
+//Stores the same members with the same subset over and over, see
+//Fenix_Data_store_plan_create.
+typedef struct __fenix_store_plan *Fenix_Store_plan;
+
+//Data of a member split over several user allocations. The member's data is
+//the concatenation of the buffers, so the counts (in elements of the
+//member's datatype) must add up to the member's count.
+typedef struct {
+    int num_buffers;
+    void **buffers;
+    int *counts;
+} Fenix_Data_buffer_list;
+
 extern const Fenix_Data_subset  FENIX_DATA_SUBSET_FULL;
 extern const Fenix_Data_subset  FENIX_DATA_SUBSET_EMPTY;
 
@@ -161,17 +200,25 @@ int Fenix_Data_test(Fenix_Request request, int *flag);
 int Fenix_Data_member_store(int group_id, int member_id,
                             Fenix_Data_subset subset_specifier);
 
-int Fenix_Data_member_storev(int member_id, int group_id,
+int Fenix_Data_member_storev(int group_id, int member_id,
                              Fenix_Data_subset subset_specifier);
 
-int Fenix_Data_member_istore(int member_id, int group_id,
+int Fenix_Data_member_istore(int group_id, int member_id,
                              Fenix_Data_subset subset_specifier,
                              Fenix_Request *request);
 
-int Fenix_Data_member_istorev(int member_id, int group_id,
+int Fenix_Data_member_istorev(int group_id, int member_id,
                               Fenix_Data_subset subset_specifier,
                               Fenix_Request *request);
 
+int Fenix_Data_store_plan_create(int group_id, int member_id,
+                                 Fenix_Data_subset subset_specifier,
+                                 Fenix_Store_plan *plan);
+
+int Fenix_Data_plan_store(Fenix_Store_plan plan);
+
+int Fenix_Data_store_plan_free(Fenix_Store_plan *plan);
+
 int Fenix_Data_commit(int group_id, int *time_stamp);
 
 int Fenix_Data_commit_barrier(int group_id, int *time_stamp);
@@ -0,0 +1,93 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//
+//            _|_|_|_|  _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//            _|        _|        _|_|    _|    _|      _|  _|
+//            _|_|_|    _|_|_|    _|  _|  _|    _|        _|
+//            _|        _|        _|    _|_|    _|      _|  _|
+//            _|        _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//
+//
+//
+//
+// Copyright (C) 2016 Rutgers University and Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author Marc Gamell, Eric Valenzuela, Keita Teranishi, Manish Parashar,
+//        Michael Heroux, and Matthew Whitlock
+//
+// Questions? Contact Keita Teranishi (knteran@sandia.gov) and
+//                    Marc Gamell (mgamell@cac.rutgers.edu)
+//
+// ************************************************************************
+//@HEADER
+*/
+#ifndef __FENIX_ARENA_H__
+#define __FENIX_ARENA_H__
+
+#include <stddef.h>
+
+//Pool allocator backed by a few large mappings. Freed allocations go on a
+//free list for their size and are handed out again to the next allocation of
+//that size, the mappings themselves are only released when the arena is.
+
+#define __FENIX_ARENA_PAGES_DEFAULT 0
+//Backs the arena with transparent huge pages where the kernel allows it.
+#define __FENIX_ARENA_PAGES_ADVISE  1
+//Asks for reserved huge pages, falling back to advising if there are none.
+#define __FENIX_ARENA_PAGES_HUGETLB 2
+
+typedef struct __fenix_arena fenix_arena_t;
+
+//placement is one of the __FENIX_NUMA_* policies, applied to every mapping.
+fenix_arena_t* __fenix_arena_create(int pages, int placement);
+
+//Returns all of the arena's memory, including anything still allocated.
+void __fenix_arena_destroy(fenix_arena_t* arena);
+
+//Allocations are 64 byte aligned.
+void* __fenix_arena_alloc(fenix_arena_t* arena, size_t size);
+void* __fenix_arena_calloc(fenix_arena_t* arena, size_t count, size_t size);
+
+//NULL is ignored, like free. The memory goes back on the arena's free list,
+//never to the system: an arena's footprint is its peak until it's destroyed
+//with its group.
+void __fenix_arena_free(fenix_arena_t* arena, void* ptr);
+
+//Calls on_map with every mapping the arena has made so far and, from then on,
+//with each new one, e.g. to register them for RMA. NULL stops the calls.
+void __fenix_arena_watch(fenix_arena_t* arena,
+      void (*on_map)(void* base, size_t size, void* arg), void* arg);
+
+#endif //__FENIX_ARENA_H__
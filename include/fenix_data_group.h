@@ -67,6 +67,7 @@
 
 typedef struct __fenix_group_vtbl fenix_group_vtbl_t;
 typedef struct __fenix_group fenix_group_t;
+typedef struct __fenix_data_request fenix_data_request_t;
 
 //This defines the functions which must be implemented by the group
 typedef struct __fenix_group_vtbl {
@@ -91,6 +92,26 @@ typedef struct __fenix_group_vtbl {
    int (*member_istorev)(fenix_group_t* group, int member_id, 
            Fenix_Data_subset subset_specifier, Fenix_Request *request);
 
+   //Stores every member of the group, coalescing their exchanges where it
+   //can. specifiers is indexed like group->member->member_entry. May be
+   //NULL, then members are stored one at a time.
+   int (*member_store_all)(fenix_group_t* group, Fenix_Data_subset* specifiers);
+
+   //Store plans: the policy's part of a plan storing memberids with subset,
+   //which it is free to prepare as much of up front as it likes. May be
+   //NULL, then plans store their members one at a time.
+   void* (*store_plan_create)(fenix_group_t* group, int* memberids, int num_memberids,
+           Fenix_Data_subset* subset);
+
+   int (*store_plan_start)(fenix_group_t* group, void* plan);
+
+   void (*store_plan_free)(fenix_group_t* group, void* plan);
+
+   int (*request_wait)(fenix_group_t* group, fenix_data_request_t* request);
+
+   int (*request_test)(fenix_group_t* group, fenix_data_request_t* request,
+           int* flag);
+
    int (*commit)(fenix_group_t* group);
 
    int (*snapshot_delete)(fenix_group_t* group, int time_stamp);
@@ -119,6 +140,11 @@ typedef struct __fenix_group_vtbl {
    int (*member_set_attribute)(fenix_group_t* group, fenix_member_entry_t* mentry, 
            int attributename, void* attributevalue, int* flag);
 
+   //Drives outstanding istores without blocking and returns how many are
+   //still in flight. Called from the progress thread, NULL if the policy has
+   //no asynchronous traffic, see fenix_progress.h
+   int (*progress)(fenix_group_t* group);
+
 } fenix_group_vtbl_t;
 
 //We keep basic bookkeeping info here, policy specific
@@ -134,8 +160,19 @@ typedef struct __fenix_group {
     int depth;
     int policy_name;
     fenix_member_t *member;
+    //Store plans made for the group, released along with it.
+    struct __fenix_store_plan *plans;
 } fenix_group_t;
 
+//Bookkeeping for a nonblocking store. Policies extend this with whatever
+//they need to finish the store, the same way they extend fenix_group_t.
+//Once the policy has finished the store it sets completed and releases its
+//own resources, fenix core frees the request when the user waits on it.
+typedef struct __fenix_data_request {
+    fenix_group_t* group;
+    int completed;
+} fenix_data_request_t;
+
 typedef struct __fenix_data_recovery {
     size_t count;
     size_t total_size;
@@ -153,6 +190,8 @@ fenix_data_recovery_t * __fenix_data_recovery_init();
 
 int __fenix_group_delete(int groupid);
 
+void __fenix_group_release_plans(fenix_group_t *group);
+
 int __fenix_member_delete(int groupid, int memberid);
 
 void __fenix_data_recovery_destroy( fenix_data_recovery_t *fx_data_recovery );
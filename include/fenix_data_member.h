@@ -59,6 +59,7 @@
 #include <mpi.h>
 #include "fenix_data_packet.h"
 #include "fenix_util.h"
+#include "fenix_dirty.h"
 
 
 #define __FENIX_DEFAULT_MEMBER_SIZE 512
@@ -70,6 +71,12 @@ typedef struct __fenix_member_entry {
     MPI_Datatype current_datatype;
     int datatype_size;
     int current_count;
+    //Scatter-gather layout of user_data, num_buffers is 0 if unused.
+    int num_buffers;
+    void **buffers;
+    int *buffer_counts;
+    //Pages of user_data written since they were stored, NULL if untracked.
+    fenix_dirty_region_t *dirty;
 } fenix_member_entry_t;
 
 typedef struct __fenix_member {
@@ -98,6 +105,12 @@ int __fenix_data_member_send_metadata(int groupid, int memberid, int dest_rank);
 int __fenix_data_member_recv_metadata(int groupid, int src_rank, 
         fenix_member_entry_packet_t* packet);
 
+int __fenix_data_member_set_buffer_list(fenix_member_entry_t* mentry,
+        Fenix_Data_buffer_list* list);
+void __fenix_data_member_free_buffer_list(fenix_member_entry_t* mentry);
+void __fenix_data_member_gather_buffers(fenix_member_entry_t* mentry,
+        Fenix_Data_subset* subset, void* dest);
+
 int __fenix_search_memberid(fenix_member_t* member, int memberid);
 int __fenix_find_next_member_position(fenix_member_t *m);
 
@@ -60,6 +60,12 @@
 #include <mpi.h>
 #include "fenix_data_group.h"
 
+//How RAID 1 stores get the partner its copy, see fenix.data_transport.
+#define __FENIX_IMR_TRANSPORT_MESSAGE 0
+//Partners expose their copies in an RMA window and stores put straight into
+//them, without waiting for the partner to store too.
+#define __FENIX_IMR_TRANSPORT_RMA     1
+
 void __fenix_policy_in_memory_raid_get_group(fenix_group_t** group, MPI_Comm comm, 
       int timestart, int depth, void* policy_value, int* flag);
 
@@ -84,6 +84,7 @@
 #define STORE_SIZE_TAG  2002
 #define STORE_DATA_TAG  2003
 #define STORE_PAYLOAD_TAG  2004
+#define STORE_DELTA_TAG    2005
 
 #define PARTNER_STATUS_TAG       1900
 #define RECOVER_GROUP_TAG        1901
@@ -94,6 +95,23 @@
 #define RECOVER_SIZE_TAG         1906
 #define RECOVER_DATA_TAG         1907
 
+//A store plan. Members with dirty tracking change shape from one store to
+//the next, so those always take the regular path; the policy plans the rest.
+//Plans are listed on their group. Turning a member's dirty tracking on or off
+//makes them stale, they split their members again on the next store. Deleting
+//the group releases the policy plans and leaves group NULL.
+typedef struct __fenix_store_plan {
+    int groupid;
+    fenix_group_t *group;
+    int num_members;
+    int *memberids;
+    int *tracked;
+    Fenix_Data_subset subset;
+    void *policy_plan;
+    int stale;
+    struct __fenix_store_plan *next;
+} fenix_store_plan_t;
+
 
 
 
@@ -114,10 +132,19 @@ int __fenix_group_get_redundancy_policy(int, int*, int*, int*);
 int __fenix_member_create(int, int, void *, int, MPI_Datatype);
 int __fenix_data_wait(Fenix_Request);
 int __fenix_data_test(Fenix_Request, int *);
+void __fenix_data_repair_deferred();
 int __fenix_member_store(int, int, Fenix_Data_subset);
+int __fenix_member_store_all(fenix_group_t *, Fenix_Data_subset);
 int __fenix_member_storev(int, int, Fenix_Data_subset);
 int __fenix_member_istore(int, int, Fenix_Data_subset, Fenix_Request *);
 int __fenix_member_istorev(int, int, Fenix_Data_subset, Fenix_Request *);
+int __fenix_store_plan_create(int, int, Fenix_Data_subset, Fenix_Store_plan *);
+int __fenix_plan_store(Fenix_Store_plan);
+void __fenix_store_plan_split(fenix_store_plan_t *);
+int __fenix_store_plan_free(Fenix_Store_plan *);
+int __fenix_member_collect_dirty(fenix_group_t *, fenix_member_entry_t *, Fenix_Data_subset *);
+void __fenix_member_retrack_dirty(fenix_member_entry_t *);
+void __fenix_group_commit_dirty(fenix_group_t *);
 int __fenix_data_commit(int, int *);
 int __fenix_data_commit_barrier(int, int *);
 int __fenix_data_barrier(int);
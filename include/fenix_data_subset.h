@@ -92,6 +92,11 @@ void* __fenix_data_subset_serialize(Fenix_Data_subset* ss, void* src,
       size_t type_size, size_t max_size, size_t* output_size);
 void __fenix_data_subset_deserialize(Fenix_Data_subset* ss, void* src, 
       void* dest, size_t max_size, size_t type_size);
+int __fenix_data_subset_get_regions(Fenix_Data_subset* ss, size_t max_size,
+      int** starts, int** lengths);
+void __fenix_data_subset_get_type(Fenix_Data_subset* ss, size_t type_size,
+      size_t max_size, MPI_Datatype* type);
+void __fenix_data_subset_free_type_cache();
 void __fenix_data_subset_send(Fenix_Data_subset* ss, int dest, int tag, MPI_Comm comm);
 void __fenix_data_subset_recv(Fenix_Data_subset* ss, int src, int tag, MPI_Comm comm);
 int __fenix_data_subset_is_full(Fenix_Data_subset* ss, size_t data_length);
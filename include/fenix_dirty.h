@@ -0,0 +1,94 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//
+//            _|_|_|_|  _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//            _|        _|        _|_|    _|    _|      _|  _|
+//            _|_|_|    _|_|_|    _|  _|  _|    _|        _|
+//            _|        _|        _|    _|_|    _|      _|  _|
+//            _|        _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//
+//
+//
+//
+// Copyright (C) 2016 Rutgers University and Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author Marc Gamell, Eric Valenzuela, Keita Teranishi, Manish Parashar,
+//        Michael Heroux, and Matthew Whitlock
+//
+// Questions? Contact Keita Teranishi (knteran@sandia.gov) and
+//                    Marc Gamell (mgamell@cac.rutgers.edu)
+//
+// ************************************************************************
+//@HEADER
+*/
+#ifndef __FENIX_DIRTY_H__
+#define __FENIX_DIRTY_H__
+
+#include <stddef.h>
+#include <mpi.h>
+#include "fenix_data_subset.h"
+
+//Page granularity write tracking for member buffers. Tracked pages are kept
+//read-only, the first write to one faults into a SIGSEGV handler which marks
+//it dirty and makes it writable again. Only pages wholly inside the buffer
+//are tracked, the partial pages at either end may hold other allocations and
+//are stored every time.
+//Writes made by the kernel (read(2), MPI transports which receive through
+//it) are not supported: they don't fault, they fail with EFAULT. Buffers
+//filled that way must not be tracked.
+
+typedef struct __fenix_dirty_region fenix_dirty_region_t;
+
+//Starts tracking size bytes at data, every page starts out needing a store.
+//NULL if the tracking state can't be allocated.
+fenix_dirty_region_t* __fenix_dirty_track(void* data, size_t size);
+
+void __fenix_dirty_untrack(fenix_dirty_region_t* region);
+
+//Fills subset with the elements on pages written since they were last
+//collected, plus any whose last stored copy would fall out of a history of
+//depth+1 snapshots at the next commit, then protects those pages again.
+//Collective over comm, every rank gets the union so partners store alike.
+void __fenix_dirty_collect(fenix_dirty_region_t* region, int type_size, int count,
+        int depth, MPI_Comm comm, Fenix_Data_subset* subset);
+
+//Called when the member's group commits.
+void __fenix_dirty_commit(fenix_dirty_region_t* region);
+
+//Forgets what has been stored, so the next collect covers every page. Pages
+//are writable until then.
+void __fenix_dirty_reset(fenix_dirty_region_t* region);
+
+#endif //__FENIX_DIRTY_H__
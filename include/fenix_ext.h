@@ -94,11 +94,19 @@ typedef struct {
     MPI_Comm new_world;            // Global MPI communicator identical to g_world but without spare ranks
     MPI_Comm *user_world;           // MPI communicator with repaired ranks
     MPI_Op   agree_op;              // This is reserved for the global agreement call for Fenix data recovery API
+    MPI_Op   xor_op;                // Vectorized bitwise XOR used for parity, see fenix_xor.h
     
     
     MPI_Errhandler mpi_errhandler;  // This stores callback info for our custom error handler
     int ignore_errs;                // Set this to return errors instead of using the error handler normally. (Don't forget to unset!)
     int print_unhandled;            // Set this to print the error string for MPI errors of an unhandled return type.
+    int data_pages;                 // Page backing of in-memory redundancy data, see fenix_arena.h
+    int data_placement;             // NUMA placement of in-memory redundancy data, see fenix_numa.h
+    char* data_spill_dir;           // Where in-memory groups spill snapshots past data_memory_budget, NULL to never spill
+    size_t data_memory_budget;      // Bytes of snapshots an in-memory group keeps resident, 0 for no limit
+    int data_progress;              // Whether a background thread drives istores, see fenix_progress.h
+    int data_progress_queue;        // Most istores a group keeps in flight before a new one waits, 0 for no limit
+    int data_transport;             // How in-memory RAID 1 stores reach the partner, see fenix_data_policy_in_memory_raid.h
 
 
 
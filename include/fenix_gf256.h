@@ -0,0 +1,84 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//
+//            _|_|_|_|  _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//            _|        _|        _|_|    _|    _|      _|  _|
+//            _|_|_|    _|_|_|    _|  _|  _|    _|        _|
+//            _|        _|        _|    _|_|    _|      _|  _|
+//            _|        _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//
+//
+//
+//
+// Copyright (C) 2016 Rutgers University and Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author Marc Gamell, Eric Valenzuela, Keita Teranishi, Manish Parashar,
+//        Michael Heroux, and Matthew Whitlock
+//
+// Questions? Contact Keita Teranishi (knteran@sandia.gov) and
+//                    Marc Gamell (mgamell@cac.rutgers.edu)
+//
+// ************************************************************************
+//@HEADER
+*/
+#ifndef __FENIX_GF256_H__
+#define __FENIX_GF256_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+//Arithmetic over GF(2^8) with the 0x11d polynomial, as used for RAID 6 style
+//Reed-Solomon parity. Addition is XOR. __fenix_gf256_init must be called once
+//before anything else here. Region multiplies use SSSE3 or AVX2 byte shuffles
+//when the CPU has them.
+
+void __fenix_gf256_init();
+
+uint8_t __fenix_gf256_mul(uint8_t a, uint8_t b);
+//b must be nonzero.
+uint8_t __fenix_gf256_div(uint8_t a, uint8_t b);
+//The generator (2) raised to power.
+uint8_t __fenix_gf256_exp(int power);
+
+//dest = c*src over n bytes.
+void __fenix_gf256_mul_region(uint8_t c, const void* src, void* dest, size_t n);
+//dest ^= c*src over n bytes.
+void __fenix_gf256_mul_region_xor(uint8_t c, const void* src, void* dest, size_t n);
+
+//Inverts the size x size row-major matrix into inverse, destroying matrix.
+//Returns nonzero if matrix is singular.
+int __fenix_gf256_invert_matrix(uint8_t* matrix, uint8_t* inverse, int size);
+
+#endif //__FENIX_GF256_H__
@@ -0,0 +1,98 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//
+//            _|_|_|_|  _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//            _|        _|        _|_|    _|    _|      _|  _|
+//            _|_|_|    _|_|_|    _|  _|  _|    _|        _|
+//            _|        _|        _|    _|_|    _|      _|  _|
+//            _|        _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//
+//
+//
+//
+// Copyright (C) 2016 Rutgers University and Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author Marc Gamell, Eric Valenzuela, Keita Teranishi, Manish Parashar,
+//        Michael Heroux, and Matthew Whitlock
+//
+// Questions? Contact Keita Teranishi (knteran@sandia.gov) and
+//                    Marc Gamell (mgamell@cac.rutgers.edu)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef __FENIX_PROGRESS_H__
+#define __FENIX_PROGRESS_H__
+
+//Background progress of asynchronous redundancy traffic. With the
+//FENIX_DATA_PROGRESS_THREAD info key set and MPI_THREAD_MULTIPLE available, a
+//thread keeps testing every group's outstanding stores so their exchanges
+//move along while the application computes. Everything else is a no-op.
+//
+//Group state is shared with the thread, so every data API entry point runs
+//holding the progress lock.
+//
+//The thread can't repair a failure itself. It flags the request that hit it
+//and defers the MPI error, and the calling thread repairs from the error when
+//it next waits on or tests a request.
+
+//Starts the thread if it was asked for and MPI allows it.
+void __fenix_progress_start();
+
+//Joins the thread, must come before the groups are destroyed.
+void __fenix_progress_stop();
+
+//Locking while already holding the lock does nothing, and returns 1 so the
+//caller knows not to expect it to be dropped early. Unlocking without
+//holding it does nothing either, so an entry point left through a repair's
+//longjmp can give the lock up on its way out.
+int __fenix_progress_lock();
+void __fenix_progress_unlock();
+
+//Wakes the thread up after new traffic has been started, lock held.
+void __fenix_progress_kick();
+
+//Whether the caller is the progress thread itself.
+int __fenix_progress_is_engine();
+
+//Keeps the first MPI error the thread hit, lock held.
+void __fenix_progress_defer_error(int error);
+
+//Returns the deferred error, or MPI_SUCCESS if there is none, and forgets
+//it. Lock held.
+int __fenix_progress_take_error();
+
+#endif //__FENIX_PROGRESS_H__
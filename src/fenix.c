@@ -58,6 +58,7 @@
 #include "fenix_process_recovery.h"
 #include "fenix_util.h"
 #include "fenix_ext.h"
+#include "fenix_progress.h"
 #include "fenix.h"
 
 const Fenix_Data_subset  FENIX_DATA_SUBSET_FULL = {0, NULL, NULL, NULL, 0, __FENIX_SUBSET_FULL};
@@ -79,47 +80,103 @@ int Fenix_Finalize() {
 
 int Fenix_Data_group_create( int group_id, MPI_Comm comm, int start_time_stamp, int depth, int policy_name, 
         void* policy_value, int* flag) {
-    return __fenix_group_create(group_id, comm, start_time_stamp, depth, policy_name, policy_value, flag);
+    __fenix_progress_lock();
+    int retval = __fenix_group_create(group_id, comm, start_time_stamp, depth, policy_name, policy_value, flag);
+    __fenix_progress_unlock();
+    return retval;
 }
 
 int Fenix_Data_member_create( int group_id, int member_id, void *buffer, int count, MPI_Datatype datatype ) {
-    return __fenix_member_create(group_id, member_id, buffer, count, datatype);
+    __fenix_progress_lock();
+    int retval = __fenix_member_create(group_id, member_id, buffer, count, datatype);
+    __fenix_progress_unlock();
+    return retval;
 }
 
 int Fenix_Data_group_get_redundancy_policy( int group_id, int* policy_name, void *policy_value, int *flag ) {
-    return __fenix_group_get_redundancy_policy( group_id, policy_name, policy_value, flag );
+    __fenix_progress_lock();
+    int retval = __fenix_group_get_redundancy_policy( group_id, policy_name, policy_value, flag );
+    __fenix_progress_unlock();
+    return retval;
 }
 
 int Fenix_Data_wait(Fenix_Request request) {
-    return __fenix_data_wait(request);
+    __fenix_progress_lock();
+    int retval = __fenix_data_wait(request);
+    __fenix_progress_unlock();
+    return retval;
 }
 
 int Fenix_Data_test(Fenix_Request request, int *flag) {
-    return __fenix_data_test(request, flag);
+    __fenix_progress_lock();
+    int retval = __fenix_data_test(request, flag);
+    __fenix_progress_unlock();
+    return retval;
 }
 
 int Fenix_Data_member_store(int group_id, int member_id, Fenix_Data_subset subset_specifier) {
-    return __fenix_member_store(group_id, member_id, subset_specifier);
+    __fenix_progress_lock();
+    int retval = __fenix_member_store(group_id, member_id, subset_specifier);
+    __fenix_progress_unlock();
+    return retval;
 }
 
 int Fenix_Data_member_storev(int group_id, int member_id, Fenix_Data_subset subset_specifier) {
-    return 0;
+    __fenix_progress_lock();
+    int retval = __fenix_member_storev(group_id, member_id, subset_specifier);
+    __fenix_progress_unlock();
+    return retval;
 }
 
 int Fenix_Data_member_istore(int group_id, int member_id, Fenix_Data_subset subset_specifier, Fenix_Request *request) {
-    return 0;
+    __fenix_progress_lock();
+    int retval = __fenix_member_istore(group_id, member_id, subset_specifier, request);
+    __fenix_progress_kick();
+    __fenix_progress_unlock();
+    return retval;
 }
 
 int Fenix_Data_member_istorev(int group_id, int member_id, Fenix_Data_subset subset_specifier, Fenix_Request *request) {
-    return 0;
+    __fenix_progress_lock();
+    int retval = __fenix_member_istorev(group_id, member_id, subset_specifier, request);
+    __fenix_progress_kick();
+    __fenix_progress_unlock();
+    return retval;
+}
+
+int Fenix_Data_store_plan_create(int group_id, int member_id, Fenix_Data_subset subset_specifier, Fenix_Store_plan *plan) {
+    __fenix_progress_lock();
+    int retval = __fenix_store_plan_create(group_id, member_id, subset_specifier, plan);
+    __fenix_progress_unlock();
+    return retval;
+}
+
+int Fenix_Data_plan_store(Fenix_Store_plan plan) {
+    __fenix_progress_lock();
+    int retval = __fenix_plan_store(plan);
+    __fenix_progress_unlock();
+    return retval;
+}
+
+int Fenix_Data_store_plan_free(Fenix_Store_plan *plan) {
+    __fenix_progress_lock();
+    int retval = __fenix_store_plan_free(plan);
+    __fenix_progress_unlock();
+    return retval;
 }
 
 int Fenix_Data_commit(int group_id, int *time_stamp) {
-    return __fenix_data_commit(group_id, time_stamp);
+    __fenix_progress_lock();
+    int retval = __fenix_data_commit(group_id, time_stamp);
+    __fenix_progress_unlock();
+    return retval;
 }
 
 int Fenix_Data_commit_barrier(int group_id, int *time_stamp) {
-    return __fenix_data_commit_barrier(group_id, time_stamp);
+    __fenix_progress_lock();
+    int retval = __fenix_data_commit_barrier(group_id, time_stamp);
+    __fenix_progress_unlock();
+    return retval;
 }
 
 int Fenix_Data_barrier(int group_id) {
@@ -127,11 +184,17 @@ int Fenix_Data_barrier(int group_id) {
 }
 
 int Fenix_Data_member_restore(int group_id, int member_id, void *target_buffer, int max_count, int time_stamp, Fenix_Data_subset* data_found) {
-    return __fenix_member_restore(group_id, member_id, target_buffer, max_count, time_stamp, data_found);
+    __fenix_progress_lock();
+    int retval = __fenix_member_restore(group_id, member_id, target_buffer, max_count, time_stamp, data_found);
+    __fenix_progress_unlock();
+    return retval;
 }
 
-int Fenix_Data_member_resore_from_rank(int group_id, int member_id, void *target_buffer, int max_count, int time_stamp, int source_rank) {
-    return 0;
+int Fenix_Data_member_restore_from_rank(int member_id, void *target_buffer, int max_count, int time_stamp, int group_id, int source_rank) {
+    __fenix_progress_lock();
+    int retval = __fenix_member_restore_from_rank(group_id, member_id, target_buffer, max_count, time_stamp, source_rank);
+    __fenix_progress_unlock();
+    return retval;
 }
 
 int Fenix_Data_subset_create(int num_blocks, int start_offset, int end_offset, int stride, Fenix_Data_subset *subset_specifier) {
@@ -155,31 +218,52 @@ int Fenix_Data_group_get_member_at_position(int group_id, int *member_id, int po
 }
 
 int Fenix_Data_group_get_number_of_snapshots(int group_id, int *number_of_snapshots) {
-    return __fenix_get_number_of_snapshots(group_id, number_of_snapshots);
+    __fenix_progress_lock();
+    int retval = __fenix_get_number_of_snapshots(group_id, number_of_snapshots);
+    __fenix_progress_unlock();
+    return retval;
 }
 
 int Fenix_Data_group_get_snapshot_at_position(int group_id, int position, int *time_stamp) {
-    return __fenix_get_snapshot_at_position(group_id, position, time_stamp);
+    __fenix_progress_lock();
+    int retval = __fenix_get_snapshot_at_position(group_id, position, time_stamp);
+    __fenix_progress_unlock();
+    return retval;
 }
 
 int Fenix_Data_member_attr_get(int group_id, int member_id, int attributename, void *attributevalue, int *flag, int source_rank) {
-    return __fenix_member_get_attribute(group_id, member_id, attributename, attributevalue, flag, source_rank);
+    __fenix_progress_lock();
+    int retval = __fenix_member_get_attribute(group_id, member_id, attributename, attributevalue, flag, source_rank);
+    __fenix_progress_unlock();
+    return retval;
 }
 
 int Fenix_Data_member_attr_set(int group_id, int member_id, int attribute_name, void *attribute_value, int *flag) {
-    return __fenix_member_set_attribute(group_id, member_id, attribute_name, attribute_value, flag);
+    __fenix_progress_lock();
+    int retval = __fenix_member_set_attribute(group_id, member_id, attribute_name, attribute_value, flag);
+    __fenix_progress_unlock();
+    return retval;
 }
 
 int Fenix_Data_snapshot_delete(int group_id, int time_stamp) {
-    return __fenix_snapshot_delete(group_id, time_stamp);
+    __fenix_progress_lock();
+    int retval = __fenix_snapshot_delete(group_id, time_stamp);
+    __fenix_progress_unlock();
+    return retval;
 }
 
 int Fenix_Data_group_delete(int group_id) {
-    return __fenix_group_delete(group_id);
+    __fenix_progress_lock();
+    int retval = __fenix_group_delete(group_id);
+    __fenix_progress_unlock();
+    return retval;
 }
 
 int Fenix_Data_member_delete(int group_id, int member_id) {
-    return __fenix_member_delete(group_id, member_id);
+    __fenix_progress_lock();
+    int retval = __fenix_member_delete(group_id, member_id);
+    __fenix_progress_unlock();
+    return retval;
 }
 
 int Fenix_Process_fail_list(int** fail_list){
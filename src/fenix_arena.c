@@ -0,0 +1,228 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//
+//            _|_|_|_|  _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//            _|        _|        _|_|    _|    _|      _|  _|
+//            _|_|_|    _|_|_|    _|  _|  _|    _|        _|
+//            _|        _|        _|    _|_|    _|      _|  _|
+//            _|        _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//
+//
+//
+//
+// Copyright (C) 2016 Rutgers University and Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author Marc Gamell, Eric Valenzuela, Keita Teranishi, Manish Parashar,
+//        Michael Heroux, and Matthew Whitlock
+//
+// Questions? Contact Keita Teranishi (knteran@sandia.gov) and
+//                    Marc Gamell (mgamell@cac.rutgers.edu)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#include <string.h>
+#include <sys/mman.h>
+#include "fenix_opt.h"
+#include "fenix_util.h"
+#include "fenix_arena.h"
+#include "fenix_numa.h"
+
+#define __FENIX_ARENA_ALIGNMENT 64
+//Mappings are made in multiples of this, so that they can be huge pages.
+#define __FENIX_ARENA_MAPPING_SIZE (2*1024*1024)
+#define __FENIX_ARENA_BLOCK_SIZE (32*1024*1024)
+//Larger allocations are rounded to whole pages, so that slightly different
+//sizes still share a free list.
+#define __FENIX_ARENA_PAGE_ROUNDING (64*1024)
+
+typedef struct __fenix_arena_block {
+   size_t size;
+   size_t used;
+   struct __fenix_arena_block* next;
+} fenix_arena_block_t;
+
+//Free allocations of one size, linked through their first word.
+typedef struct __fenix_arena_bin {
+   size_t size;
+   void* free;
+   struct __fenix_arena_bin* next;
+} fenix_arena_bin_t;
+
+//Sits in front of every allocation.
+typedef union __fenix_arena_header {
+   fenix_arena_bin_t* bin;
+   char padding[__FENIX_ARENA_ALIGNMENT];
+} fenix_arena_header_t;
+
+typedef struct __fenix_arena {
+   int pages;
+   int placement;
+   fenix_arena_block_t* blocks;
+   fenix_arena_bin_t* bins;
+   void (*on_map)(void* base, size_t size, void* arg);
+   void* on_map_arg;
+} fenix_arena_t;
+
+static size_t __fenix_arena_round(size_t size, size_t multiple){
+   return (size + multiple - 1)/multiple*multiple;
+}
+
+fenix_arena_block_t* __fenix_arena_map(fenix_arena_t* arena, size_t size){
+   size = __fenix_arena_round(size, __FENIX_ARENA_MAPPING_SIZE);
+
+   void* mapping = MAP_FAILED;
+#ifdef MAP_HUGETLB
+   if(arena->pages == __FENIX_ARENA_PAGES_HUGETLB){
+      mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+   }
+#endif
+   if(mapping == MAP_FAILED){
+      mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+#ifdef MADV_HUGEPAGE
+      if(mapping != MAP_FAILED && arena->pages != __FENIX_ARENA_PAGES_DEFAULT){
+         madvise(mapping, size, MADV_HUGEPAGE);
+      }
+#endif
+   }
+   if(mapping == MAP_FAILED){
+      debug_print("Out of memory: mmap failed on arena block of %lu bytes.\n", (unsigned long) size);
+      return NULL;
+   }
+   //Before the header below touches the first page.
+   __fenix_numa_place(mapping, size, arena->placement);
+
+   fenix_arena_block_t* block = (fenix_arena_block_t*) mapping;
+   block->size = size;
+   block->used = __fenix_arena_round(sizeof(fenix_arena_block_t), __FENIX_ARENA_ALIGNMENT);
+   block->next = arena->blocks;
+   arena->blocks = block;
+   if(arena->on_map != NULL) arena->on_map(block, block->size, arena->on_map_arg);
+   return block;
+}
+
+fenix_arena_t* __fenix_arena_create(int pages, int placement){
+   fenix_arena_t* arena = (fenix_arena_t*) s_malloc(sizeof(fenix_arena_t));
+   arena->pages = pages;
+   arena->placement = placement;
+   arena->blocks = NULL;
+   arena->bins = NULL;
+   arena->on_map = NULL;
+   arena->on_map_arg = NULL;
+   return arena;
+}
+
+void __fenix_arena_destroy(fenix_arena_t* arena){
+   if(arena == NULL) return;
+
+   while(arena->bins != NULL){
+      fenix_arena_bin_t* bin = arena->bins;
+      arena->bins = bin->next;
+      free(bin);
+   }
+   while(arena->blocks != NULL){
+      fenix_arena_block_t* block = arena->blocks;
+      arena->blocks = block->next;
+      munmap(block, block->size);
+   }
+   free(arena);
+}
+
+fenix_arena_bin_t* __fenix_arena_bin(fenix_arena_t* arena, size_t size){
+   fenix_arena_bin_t* bin = arena->bins;
+   while(bin != NULL && bin->size != size) bin = bin->next;
+   if(bin == NULL){
+      bin = (fenix_arena_bin_t*) s_malloc(sizeof(fenix_arena_bin_t));
+      bin->size = size;
+      bin->free = NULL;
+      bin->next = arena->bins;
+      arena->bins = bin;
+   }
+   return bin;
+}
+
+void* __fenix_arena_alloc(fenix_arena_t* arena, size_t size){
+   size = __fenix_arena_round(size > 0 ? size : 1,
+         size < __FENIX_ARENA_PAGE_ROUNDING ? __FENIX_ARENA_ALIGNMENT : __FENIX_ARENA_PAGE_ROUNDING);
+   fenix_arena_bin_t* bin = __fenix_arena_bin(arena, size);
+
+   if(bin->free != NULL){
+      void* ptr = bin->free;
+      bin->free = *(void**)ptr;
+      return ptr;
+   }
+
+   //Carve from the first block with room left at its end, so the tail a
+   //large allocation's block was rounded up with, or a block abandoned when
+   //a bigger request didn't fit, still gets used.
+   size_t needed = sizeof(fenix_arena_header_t) + size;
+   fenix_arena_block_t* block = arena->blocks;
+   while(block != NULL && block->size - block->used < needed) block = block->next;
+   if(block == NULL){
+      block = __fenix_arena_map(arena, needed + sizeof(fenix_arena_header_t) > __FENIX_ARENA_BLOCK_SIZE ?
+            needed + sizeof(fenix_arena_header_t) : __FENIX_ARENA_BLOCK_SIZE);
+      if(block == NULL) return NULL;
+   }
+
+   fenix_arena_header_t* header = (fenix_arena_header_t*)((char*)block + block->used);
+   header->bin = bin;
+   block->used += needed;
+   return header + 1;
+}
+
+void* __fenix_arena_calloc(fenix_arena_t* arena, size_t count, size_t size){
+   void* ptr = __fenix_arena_alloc(arena, count*size);
+   if(ptr != NULL) memset(ptr, 0, count*size);
+   return ptr;
+}
+
+void __fenix_arena_watch(fenix_arena_t* arena,
+      void (*on_map)(void* base, size_t size, void* arg), void* arg){
+   arena->on_map = on_map;
+   arena->on_map_arg = arg;
+   if(on_map == NULL) return;
+   for(fenix_arena_block_t* block = arena->blocks; block != NULL; block = block->next){
+      on_map(block, block->size, arg);
+   }
+}
+
+void __fenix_arena_free(fenix_arena_t* arena, void* ptr){
+   if(ptr == NULL) return;
+
+   fenix_arena_bin_t* bin = ((fenix_arena_header_t*)ptr - 1)->bin;
+   *(void**)ptr = bin->free;
+   bin->free = ptr;
+}
@@ -0,0 +1,226 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//
+//            _|_|_|_|  _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//            _|        _|        _|_|    _|    _|      _|  _|
+//            _|_|_|    _|_|_|    _|  _|  _|    _|        _|
+//            _|        _|        _|    _|_|    _|      _|  _|
+//            _|        _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//
+//
+//
+//
+// Copyright (C) 2016 Rutgers University and Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author Marc Gamell, Eric Valenzuela, Keita Teranishi, Manish Parashar,
+//        Michael Heroux, and Matthew Whitlock
+//
+// Questions? Contact Keita Teranishi (knteran@sandia.gov) and
+//                    Marc Gamell (mgamell@cac.rutgers.edu)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fenix_compress.h"
+
+#define __FENIX_LZ_HASH_BITS 14
+#define __FENIX_LZ_MIN_MATCH 4
+#define __FENIX_LZ_MAX_OFFSET 65535
+//Matches stop this far from the end so the final sequence is all literals.
+#define __FENIX_LZ_END_LITERALS 8
+
+static inline uint32_t __fenix_lz_read32(const uint8_t* p){
+   uint32_t v;
+   memcpy(&v, p, sizeof(v));
+   return v;
+}
+
+static inline uint32_t __fenix_lz_hash(uint32_t sequence){
+   return (sequence * 2654435761u) >> (32 - __FENIX_LZ_HASH_BITS);
+}
+
+void __fenix_shuffle(const uint8_t* src, uint8_t* dest, size_t n, int type_size){
+   size_t count = n/type_size;
+   for(size_t i = 0; i < count; i++){
+      for(int byte = 0; byte < type_size; byte++){
+         dest[byte*count + i] = src[i*type_size + byte];
+      }
+   }
+   memcpy(dest + count*type_size, src + count*type_size, n - count*type_size);
+}
+
+void __fenix_unshuffle(const uint8_t* src, uint8_t* dest, size_t n, int type_size){
+   size_t count = n/type_size;
+   for(size_t i = 0; i < count; i++){
+      for(int byte = 0; byte < type_size; byte++){
+         dest[i*type_size + byte] = src[byte*count + i];
+      }
+   }
+   memcpy(dest + count*type_size, src + count*type_size, n - count*type_size);
+}
+
+//Lengths past 15 spill into extra bytes of 255 each plus a remainder.
+static inline size_t __fenix_lz_length_bytes(size_t length){
+   return length < 15 ? 0 : (length - 15)/255 + 1;
+}
+
+static inline uint8_t* __fenix_lz_put_length(uint8_t* op, size_t length){
+   if(length < 15) return op;
+   length -= 15;
+   for(; length >= 255; length -= 255) *op++ = 255;
+   *op++ = (uint8_t)length;
+   return op;
+}
+
+//Each sequence is a token of literal and match lengths, the literals, then
+//a two byte offset back to the match. The last sequence has no match.
+//Returns 0 if the output would pass max.
+size_t __fenix_lz_compress(const uint8_t* in, size_t n, uint8_t* out, size_t max){
+   uint32_t* table = (uint32_t*) calloc(1 << __FENIX_LZ_HASH_BITS, sizeof(uint32_t));
+   uint8_t* op = out;
+   uint8_t* op_end = out + max;
+   size_t ip = 0, anchor = 0;
+   size_t match_limit = n > __FENIX_LZ_END_LITERALS ? n - __FENIX_LZ_END_LITERALS : 0;
+
+   while(ip + __FENIX_LZ_MIN_MATCH <= match_limit){
+      uint32_t sequence = __fenix_lz_read32(in + ip);
+      uint32_t* entry = table + __fenix_lz_hash(sequence);
+      size_t ref = *entry;
+      *entry = (uint32_t)ip;
+
+      if(ref >= ip || ip - ref > __FENIX_LZ_MAX_OFFSET || __fenix_lz_read32(in + ref) != sequence){
+         //Step faster through data that isn't matching.
+         ip += 1 + ((ip - anchor) >> 6);
+         continue;
+      }
+
+      size_t length = __FENIX_LZ_MIN_MATCH;
+      while(ip + length < match_limit && in[ref + length] == in[ip + length]) length++;
+
+      size_t literals = ip - anchor;
+      size_t match = length - __FENIX_LZ_MIN_MATCH;
+      if(op + 1 + __fenix_lz_length_bytes(literals) + literals + 2 + __fenix_lz_length_bytes(match) > op_end){
+         free(table);
+         return 0;
+      }
+      *op++ = (uint8_t)(((literals < 15 ? literals : 15) << 4) | (match < 15 ? match : 15));
+      op = __fenix_lz_put_length(op, literals);
+      memcpy(op, in + anchor, literals);
+      op += literals;
+      *op++ = (uint8_t)(ip - ref);
+      *op++ = (uint8_t)((ip - ref) >> 8);
+      op = __fenix_lz_put_length(op, match);
+
+      ip += length;
+      anchor = ip;
+   }
+
+   size_t literals = n - anchor;
+   if(op + 1 + __fenix_lz_length_bytes(literals) + literals > op_end){
+      free(table);
+      return 0;
+   }
+   *op++ = (uint8_t)((literals < 15 ? literals : 15) << 4);
+   op = __fenix_lz_put_length(op, literals);
+   memcpy(op, in + anchor, literals);
+   op += literals;
+
+   free(table);
+   return op - out;
+}
+
+static inline size_t __fenix_lz_get_length(const uint8_t** ip, size_t length){
+   if(length < 15) return length;
+   uint8_t byte;
+   do{
+      byte = *(*ip)++;
+      length += byte;
+   } while(byte == 255);
+   return length;
+}
+
+void __fenix_lz_decompress(const uint8_t* in, size_t compressed, uint8_t* out){
+   const uint8_t* ip = in;
+   const uint8_t* ip_end = in + compressed;
+   uint8_t* op = out;
+
+   while(ip < ip_end){
+      uint8_t token = *ip++;
+      size_t literals = __fenix_lz_get_length(&ip, token >> 4);
+      memcpy(op, ip, literals);
+      ip += literals;
+      op += literals;
+      if(ip >= ip_end) break;
+
+      size_t offset = ip[0] | (ip[1] << 8);
+      ip += 2;
+      size_t length = __fenix_lz_get_length(&ip, token & 15) + __FENIX_LZ_MIN_MATCH;
+      //Matches may overlap what they produce, in which case go a byte at a time.
+      const uint8_t* match = op - offset;
+      if(offset >= length) memcpy(op, match, length);
+      else for(size_t i = 0; i < length; i++) op[i] = match[i];
+      op += length;
+   }
+}
+
+size_t __fenix_compress(const void* src, size_t n, int type_size, void* dest, size_t max){
+   if(max <= __FENIX_COMPRESS_HEADER_SIZE) return 0;
+
+   uint8_t* shuffled = (uint8_t*) malloc(n);
+   __fenix_shuffle((const uint8_t*)src, shuffled, n, type_size);
+
+   uint32_t header = type_size;
+   memcpy(dest, &header, sizeof(header));
+   size_t size = __fenix_lz_compress(shuffled, n, (uint8_t*)dest + __FENIX_COMPRESS_HEADER_SIZE,
+         max - __FENIX_COMPRESS_HEADER_SIZE);
+
+   free(shuffled);
+   return size == 0 ? 0 : size + __FENIX_COMPRESS_HEADER_SIZE;
+}
+
+void __fenix_decompress(const void* src, size_t compressed, void* dest, size_t n){
+   uint32_t type_size;
+   memcpy(&type_size, src, sizeof(type_size));
+
+   uint8_t* shuffled = (uint8_t*) malloc(n);
+   __fenix_lz_decompress((const uint8_t*)src + __FENIX_COMPRESS_HEADER_SIZE,
+         compressed - __FENIX_COMPRESS_HEADER_SIZE, shuffled);
+   __fenix_unshuffle(shuffled, (uint8_t*)dest, n, type_size);
+   free(shuffled);
+}
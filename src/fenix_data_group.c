@@ -117,6 +117,9 @@ int __fenix_member_delete(int groupid, int memberid) {
       member->count--;
       fenix_member_entry_t *mentry = &(member->member_entry[member_index]);
       mentry->state = DELETED;
+      __fenix_data_member_free_buffer_list(mentry);
+      __fenix_dirty_untrack(mentry->dirty);
+      mentry->dirty = NULL;
     }
 
     if (fenix.options.verbose == 38) {
@@ -146,6 +149,7 @@ int __fenix_group_delete_direct(fenix_group_t* group){
     //to the policy, as it may be using that as a reference for
     //knowing how many members there are during its own deletion
     //process.
+    __fenix_group_release_plans(group);
     
     return group->vtbl.group_delete(group);
 }
@@ -96,6 +96,13 @@ fenix_member_t *__fenix_data_member_init() {
 }
 
 void __fenix_data_member_destroy( fenix_member_t *member ) {
+  int member_index;
+  for (member_index = 0; member_index < member->total_size; member_index++) {
+    if (member->member_entry[member_index].state == OCCUPIED) {
+      __fenix_data_member_free_buffer_list(&(member->member_entry[member_index]));
+      __fenix_dirty_untrack(member->member_entry[member_index].dirty);
+    }
+  }
   free( member->member_entry );
   free( member );
 }
@@ -151,6 +158,10 @@ fenix_member_entry_t* __fenix_data_member_add_entry(fenix_member_t* member,
     mentry->user_data = data;
     mentry->current_count = count;
     mentry->current_datatype = datatype;
+    mentry->num_buffers = 0;
+    mentry->buffers = NULL;
+    mentry->buffer_counts = NULL;
+    mentry->dirty = NULL;
     
     int dsize;
     MPI_Type_size(datatype, &dsize);
@@ -161,6 +172,97 @@ fenix_member_entry_t* __fenix_data_member_add_entry(fenix_member_t* member,
     return mentry;
 }
 
+/**
+ * @brief Keep a private copy of the user's buffer list for the storev calls.
+ * @param mentry
+ * @param list, NULL or an empty list goes back to using user_data
+ */
+int __fenix_data_member_set_buffer_list(fenix_member_entry_t* mentry,
+        Fenix_Data_buffer_list* list){
+  int total_count = 0;
+  if (list != NULL) {
+    for (int buffer = 0; buffer < list->num_buffers; buffer++) {
+      if (list->counts[buffer] < 0 || (list->counts[buffer] > 0 && list->buffers[buffer] == NULL)) {
+        debug_print("ERROR Fenix_Data_member_attr_set: invalid buffer <%d> in buffer list\n",
+                    buffer);
+        return FENIX_ERROR_INVALID_ATTRIBUTE_VALUE;
+      }
+      total_count += list->counts[buffer];
+    }
+  }
+
+  if (list != NULL && list->num_buffers > 0 && total_count != mentry->current_count) {
+    debug_print("ERROR Fenix_Data_member_attr_set: buffer list holds <%d> elements, member has <%d>\n",
+                total_count, mentry->current_count);
+    return FENIX_ERROR_INVALID_ATTRIBUTE_VALUE;
+  }
+
+  __fenix_data_member_free_buffer_list(mentry);
+
+  if (list != NULL && list->num_buffers > 0) {
+    mentry->num_buffers = list->num_buffers;
+    mentry->buffers = (void **) s_malloc(list->num_buffers * sizeof(void *));
+    mentry->buffer_counts = (int *) s_malloc(list->num_buffers * sizeof(int));
+    memcpy(mentry->buffers, list->buffers, list->num_buffers * sizeof(void *));
+    memcpy(mentry->buffer_counts, list->counts, list->num_buffers * sizeof(int));
+  }
+
+  return FENIX_SUCCESS;
+}
+
+void __fenix_data_member_free_buffer_list(fenix_member_entry_t* mentry){
+  free(mentry->buffers);
+  free(mentry->buffer_counts);
+  mentry->num_buffers = 0;
+  mentry->buffers = NULL;
+  mentry->buffer_counts = NULL;
+}
+
+/**
+ * @brief Copy the subset of a member's data out of its buffer list (or
+ *        user_data if it has none) into the contiguous buffer dest.
+ * @param mentry
+ * @param subset
+ * @param dest, laid out like user_data
+ */
+void __fenix_data_member_gather_buffers(fenix_member_entry_t* mentry,
+        Fenix_Data_subset* subset, void* dest){
+  if (mentry->num_buffers == 0) {
+    __fenix_data_subset_copy_data(subset, dest, mentry->user_data,
+            mentry->datatype_size, mentry->current_count);
+    return;
+  }
+
+  int *starts, *lengths;
+  int num_regions = __fenix_data_subset_get_regions(subset, mentry->current_count,
+          &starts, &lengths);
+
+  //Regions and buffers are both in order, so walk them together.
+  int buffer = 0, buffer_start = 0;
+  for (int region = 0; region < num_regions; region++) {
+    int position = starts[region];
+    int region_end = starts[region] + lengths[region];
+
+    while (position < region_end && buffer < mentry->num_buffers) {
+      int buffer_end = buffer_start + mentry->buffer_counts[buffer];
+      if (position >= buffer_end) {
+        buffer_start = buffer_end;
+        buffer++;
+        continue;
+      }
+
+      int to_copy = (region_end < buffer_end ? region_end : buffer_end) - position;
+      memcpy((char *)dest + (size_t)position*mentry->datatype_size,
+             (char *)mentry->buffers[buffer] + (size_t)(position - buffer_start)*mentry->datatype_size,
+             (size_t)to_copy*mentry->datatype_size);
+      position += to_copy;
+    }
+  }
+
+  free(starts);
+  free(lengths);
+}
+
 /**
  * @brief
  * @param
@@ -287,6 +389,10 @@ void __fenix_data_member_reinit(fenix_member_t *m, fenix_two_container_packet_t
     fenix_member_entry_t *mentry = &(member->member_entry[member_index]);
     mentry->memberid = -1;
     mentry->state = mystatus;
+    mentry->num_buffers = 0;
+    mentry->buffers = NULL;
+    mentry->buffer_counts = NULL;
+    mentry->dirty = NULL;
     if (fenix.options.verbose == 50) {
       verbose_print("c-rank: %d, role: %d, m-memberid: %d, m-state: %d\n",
                       __fenix_get_current_rank(fenix.new_world), fenix.role,
@@ -55,6 +55,9 @@
 
 #include <mpi.h>
 #include "fenix_data_policy_in_memory_raid.h"
+#include "fenix_data_policy_erasure_code.h"
+#include "fenix_data_policy_local_disk.h"
+#include "fenix_data_policy_aggregated_file.h"
 #include "fenix_data_policy.h"
 #include "fenix_data_group.h"
 #include "fenix_opt.h"
@@ -75,6 +78,21 @@ int __fenix_policy_get_group(fenix_group_t** group, MPI_Comm comm,
                depth, policy_value, flag);
          retval = FENIX_SUCCESS;
          break;
+      case FENIX_DATA_POLICY_ERASURE_CODE:
+         __fenix_policy_erasure_code_get_group(group, comm, timestart, 
+               depth, policy_value, flag);
+         retval = FENIX_SUCCESS;
+         break;
+      case FENIX_DATA_POLICY_LOCAL_DISK:
+         __fenix_policy_local_disk_get_group(group, comm, timestart, 
+               depth, policy_value, flag);
+         retval = FENIX_SUCCESS;
+         break;
+      case FENIX_DATA_POLICY_AGGREGATED_FILE:
+         __fenix_policy_aggregated_file_get_group(group, comm, timestart, 
+               depth, policy_value, flag);
+         retval = FENIX_SUCCESS;
+         break;
       default:
          debug_print("ERROR Fenix_Data_group_create: the specified policy <%d> is not supported.\n", policy_name);
          retval = -1;
@@ -0,0 +1,1126 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//
+//            _|_|_|_|  _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//            _|        _|        _|_|    _|    _|      _|  _|
+//            _|_|_|    _|_|_|    _|  _|  _|    _|        _|
+//            _|        _|        _|    _|_|    _|      _|  _|
+//            _|        _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//
+//
+//
+//
+// Copyright (C) 2016 Rutgers University and Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author Marc Gamell, Eric Valenzuela, Keita Teranishi, Manish Parashar,
+//        Michael Heroux, and Matthew Whitlock
+//
+// Questions? Contact Keita Teranishi (knteran@sandia.gov) and
+//                    Marc Gamell (mgamell@cac.rutgers.edu)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#include <mpi.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "fenix.h"
+#include "fenix_opt.h"
+#include "fenix_util.h"
+#include "fenix_data_subset.h"
+#include "fenix_data_recovery.h"
+#include "fenix_data_policy.h"
+#include "fenix_data_group.h"
+#include "fenix_data_member.h"
+#include "fenix_ext.h"
+
+#define __FENIX_AF_DEFAULT_MENTRY_NUM 10
+#define __FENIX_AF_NO_MEMBERS 16000
+#define __FENIX_AF_MAGIC 0x46414758
+#define __FENIX_AF_BLOB_TAG 97857
+//Blobs go to the node leader in pieces of at most this many bytes, so no
+//message outgrows an int count.
+#define __FENIX_AF_PIECE_SIZE (256*1024*1024)
+
+//Snapshots are written to a shared directory with one file per node rather
+//than per rank, so that the file system's metadata servers see a handful of
+//creates per commit. At commit every rank packs its members into a blob, and
+//the ranks of a node gather their blobs on the node's leader, which writes them
+//as <directory>/g<groupid>_t<timestamp>_n<file>:
+//   long long {magic, timestamp, num_entries}
+//   long long {rank, offset, size} per entry
+//   the blobs
+//A blob is an int member count, then per member
+//   int {memberid, datatype_size, count, subset ints}, the subset packed as in
+//   __fenix_data_subset_send, then long long data size and the serialized data.
+//Once every leader is done, rank 0 publishes <directory>/g<groupid>_t<timestamp>.idx:
+//   int {magic, timestamp, num_ranks, num_files} and the file of each rank.
+//A snapshot counts only once its index exists.
+//
+//Restores find the rank's blob through the index, so a job of any size can
+//read the snapshots. Fenix_Data_member_restore reads the data this rank held,
+//Fenix_Data_member_restore_from_rank reads any old rank's data. Both are
+//collective over the group, as are commits.
+
+typedef struct __fenix_af_mentry{
+   int memberid;
+   void* staging;
+   size_t staging_size;
+   Fenix_Data_subset staging_regions;
+} fenix_af_mentry_t;
+
+//A member's data in one snapshot, as read back from its blob.
+typedef struct __fenix_af_record{
+   int found;
+   int datatype_size;
+   int count;
+   Fenix_Data_subset regions;
+   void* data;
+} fenix_af_record_t;
+
+//Where a member's record sits in a node file.
+typedef struct __fenix_af_locator{
+   int memberid;
+   long long offset;
+   long long size;
+} fenix_af_locator_t;
+
+typedef struct __fenix_af_group{
+   fenix_group_t base;
+   char* directory;
+   MPI_Comm node_comm;
+   //MPI_COMM_NULL on everyone but node leaders.
+   MPI_Comm leader_comm;
+   int file;
+   //Node leaders only, the group rank of each node rank.
+   int* node_ranks;
+   //Rank 0 only, the file each group rank's blob goes to.
+   int* file_of_rank;
+   int num_files;
+   int entries_size;
+   int entries_count;
+   fenix_af_mentry_t* entries;
+   //Snapshots in the directory, oldest first, the same on every rank. Loaded
+   //at the first commit or restore, which may follow a restart.
+   int loaded;
+   int* timestamp;
+   int num_snapshots;
+   int next_timestamp;
+   //What restores have read of the snapshots so far, so that restoring each
+   //member doesn't read the indexes and blobs over again. Per snapshot, the
+   //file each old rank's blob went to, and where located_source's members
+   //are in it (num_located is -1 until it has been looked at). Dropped by
+   //anything that changes the snapshots.
+   int indexed;
+   int** index_files;
+   int* index_ranks;
+   int located_source;
+   fenix_af_locator_t** located;
+   int* num_located;
+} fenix_af_group_t;
+
+int __af_group_delete(fenix_group_t* group);
+int __af_member_create(fenix_group_t* group, fenix_member_entry_t* mentry);
+int __af_member_delete(fenix_group_t* group, int member_id);
+int __af_get_redundant_policy(fenix_group_t*, int* policy_name, 
+        void* policy_value, int* flag);
+int __af_member_store(fenix_group_t* group, int member_id, 
+        Fenix_Data_subset subset_specifier);
+int __af_member_storev(fenix_group_t* group, int member_id, 
+        Fenix_Data_subset subset_specifier);
+int __af_member_istore(fenix_group_t* group, int member_id, 
+        Fenix_Data_subset subset_specifier, Fenix_Request *request);
+int __af_member_istorev(fenix_group_t* group, int member_id, 
+        Fenix_Data_subset subset_specifier, Fenix_Request *request);
+int __af_request_wait(fenix_group_t* group, fenix_data_request_t* request);
+int __af_request_test(fenix_group_t* group, fenix_data_request_t* request, int* flag);
+int __af_commit(fenix_group_t* group);
+int __af_snapshot_delete(fenix_group_t* group, int time_stamp);
+int __af_barrier(fenix_group_t* group);
+int __af_member_restore(fenix_group_t* group, int member_id,
+        void* target_buffer, int max_count, int time_stamp,
+        Fenix_Data_subset* data_found);
+int __af_member_restore_from_rank(fenix_group_t* group, int member_id,
+        void* target_buffer, int max_count, int time_stamp, 
+        int source_rank);
+int __af_member_get_attribute(fenix_group_t* group, fenix_member_entry_t* member, 
+        int attributename, void* attributevalue, int* flag, int sourcerank);
+int __af_member_set_attribute(fenix_group_t* group, fenix_member_entry_t* member, 
+        int attributename, void* attributevalue, int* flag);
+int __af_get_number_of_snapshots(fenix_group_t* group, int* number_of_snapshots);
+int __af_get_snapshot_at_position(fenix_group_t* group, int position, int* time_stamp);
+int __af_reinit(fenix_group_t* group, int* flag);
+
+//Splits comm into nodes, and finds which file each rank's data goes to.
+void __af_build_comms(fenix_af_group_t* group, MPI_Comm comm){
+   int my_rank, node_rank, node_size;
+   MPI_Comm_rank(comm, &my_rank);
+   MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, my_rank, MPI_INFO_NULL, &(group->node_comm));
+   MPI_Comm_rank(group->node_comm, &node_rank);
+   MPI_Comm_size(group->node_comm, &node_size);
+
+   //Ranks are the split keys, so group rank 0 leads the first file.
+   MPI_Comm_split(comm, node_rank == 0 ? 0 : MPI_UNDEFINED, my_rank, &(group->leader_comm));
+   int files[2];
+   if(node_rank == 0){
+      MPI_Comm_rank(group->leader_comm, files);
+      MPI_Comm_size(group->leader_comm, files + 1);
+   }
+   MPI_Bcast(files, 2, MPI_INT, 0, group->node_comm);
+   group->file = files[0];
+   group->num_files = files[1];
+
+   group->node_ranks = NULL;
+   if(node_rank == 0){
+      group->node_ranks = (int*) s_malloc(node_size * sizeof(int));
+   }
+   MPI_Gather(&my_rank, 1, MPI_INT, group->node_ranks, 1, MPI_INT, 0, group->node_comm);
+
+   int comm_size;
+   MPI_Comm_size(comm, &comm_size);
+   group->file_of_rank = NULL;
+   if(my_rank == 0){
+      group->file_of_rank = (int*) s_malloc(comm_size * sizeof(int));
+   }
+   MPI_Gather(&(group->file), 1, MPI_INT, group->file_of_rank, 1, MPI_INT, 0, comm);
+}
+
+void __af_free_comms(fenix_af_group_t* group){
+   free(group->node_ranks);
+   free(group->file_of_rank);
+   if(group->leader_comm != MPI_COMM_NULL){
+      MPI_Comm_free(&(group->leader_comm));
+   }
+   MPI_Comm_free(&(group->node_comm));
+}
+
+void __fenix_policy_aggregated_file_get_group(fenix_group_t** group, MPI_Comm comm, 
+      int timestart, int depth, void* policy_value, int* flag){
+   *group = (fenix_group_t *)malloc(sizeof(fenix_af_group_t));
+   fenix_af_group_t *new_group = (fenix_af_group_t *)(*group);
+   new_group->base.vtbl.group_delete = *__af_group_delete;
+   new_group->base.vtbl.member_create = *__af_member_create;
+   new_group->base.vtbl.member_delete = *__af_member_delete;
+   new_group->base.vtbl.get_redundant_policy = *__af_get_redundant_policy;
+   new_group->base.vtbl.member_store = *__af_member_store;
+   new_group->base.vtbl.member_storev = *__af_member_storev;
+   new_group->base.vtbl.member_istore = *__af_member_istore;
+   new_group->base.vtbl.member_istorev = *__af_member_istorev;
+   new_group->base.vtbl.member_store_all = NULL;
+   new_group->base.vtbl.store_plan_create = NULL;
+   new_group->base.vtbl.store_plan_start = NULL;
+   new_group->base.vtbl.store_plan_free = NULL;
+   new_group->base.vtbl.request_wait = *__af_request_wait;
+   new_group->base.vtbl.request_test = *__af_request_test;
+   new_group->base.vtbl.commit = *__af_commit;
+   new_group->base.vtbl.snapshot_delete = *__af_snapshot_delete;
+   new_group->base.vtbl.barrier = *__af_barrier;
+   new_group->base.vtbl.member_restore = *__af_member_restore;
+   new_group->base.vtbl.member_restore_from_rank = *__af_member_restore_from_rank;
+   new_group->base.vtbl.member_get_attribute = *__af_member_get_attribute;
+   new_group->base.vtbl.member_set_attribute = *__af_member_set_attribute;
+   new_group->base.vtbl.get_number_of_snapshots = *__af_get_number_of_snapshots;
+   new_group->base.vtbl.get_snapshot_at_position = *__af_get_snapshot_at_position;
+   new_group->base.vtbl.reinit = *__af_reinit;
+   new_group->base.vtbl.progress = NULL;
+
+   //policy_value is the shared directory, which is made if it doesn't exist.
+   new_group->directory = strdup((char*)policy_value);
+   *flag = FENIX_SUCCESS;
+   int my_rank;
+   MPI_Comm_rank(comm, &my_rank);
+   if(my_rank == 0 && mkdir(new_group->directory, 0700) != 0 && errno != EEXIST){
+      debug_print("ERROR Fenix_Data_group_create: unable to make directory <%s>: %s\n",
+            new_group->directory, strerror(errno));
+      *flag = FENIX_ERROR_GROUP_CREATE;
+   }
+
+   __af_build_comms(new_group, comm);
+
+   new_group->entries_size = __FENIX_AF_DEFAULT_MENTRY_NUM;
+   new_group->entries_count = 0;
+   new_group->entries = 
+      (fenix_af_mentry_t*) malloc(sizeof(fenix_af_mentry_t) * __FENIX_AF_DEFAULT_MENTRY_NUM);
+   new_group->loaded = 0;
+   new_group->timestamp = (int*) s_malloc((depth + 1 > 1 ? depth + 1 : 1) * sizeof(int));
+   new_group->num_snapshots = 0;
+   new_group->next_timestamp = timestart;
+
+   int keep = depth + 1 > 1 ? depth + 1 : 1;
+   new_group->indexed = 0;
+   new_group->index_files = (int**) s_calloc(keep, sizeof(int*));
+   new_group->index_ranks = (int*) s_calloc(keep, sizeof(int));
+   new_group->located_source = -1;
+   new_group->located = (fenix_af_locator_t**) s_calloc(keep, sizeof(fenix_af_locator_t*));
+   new_group->num_located = (int*) s_malloc(keep * sizeof(int));
+   for(int snapshot = 0; snapshot < keep; snapshot++){
+      new_group->num_located[snapshot] = -1;
+   }
+}
+
+//Snapshots kept in the directory.
+int __af_keep(fenix_af_group_t* group){
+   return group->base.depth + 1 > 1 ? group->base.depth + 1 : 1;
+}
+
+char* __af_path(fenix_af_group_t* group, int timestamp, int file){
+   size_t path_size = strlen(group->directory) + 64;
+   char* path = (char*) s_malloc(path_size);
+   if(file < 0){
+      snprintf(path, path_size, "%s/g%d_t%d.idx", group->directory, group->base.groupid, timestamp);
+   } else {
+      snprintf(path, path_size, "%s/g%d_t%d_n%d", group->directory, group->base.groupid,
+            timestamp, file);
+   }
+   return path;
+}
+
+int __af_pwrite(int fd, void* buffer, size_t size, off_t offset){
+   char* position = (char*)buffer;
+   while(size > 0){
+      ssize_t written = pwrite(fd, position, size, offset);
+      if(written < 0){
+         if(errno == EINTR) continue;
+         return -1;
+      }
+      position += written;
+      offset += written;
+      size -= written;
+   }
+   return 0;
+}
+
+int __af_pread(int fd, void* buffer, size_t size, off_t offset){
+   char* position = (char*)buffer;
+   while(size > 0){
+      ssize_t got = pread(fd, position, size, offset);
+      if(got < 0 && errno == EINTR) continue;
+      if(got <= 0) return -1;
+      position += got;
+      offset += got;
+      size -= got;
+   }
+   return 0;
+}
+
+//Forgets where source_rank's members were.
+void __af_drop_locators(fenix_af_group_t* group){
+   for(int snapshot = 0; snapshot < __af_keep(group); snapshot++){
+      free(group->located[snapshot]);
+      group->located[snapshot] = NULL;
+      group->num_located[snapshot] = -1;
+   }
+}
+
+//Forgets everything restores read. Reading the indexes again is collective,
+//so this is only done where the whole group is.
+void __af_drop_cache(fenix_af_group_t* group){
+   __af_drop_locators(group);
+   for(int snapshot = 0; snapshot < __af_keep(group); snapshot++){
+      free(group->index_files[snapshot]);
+      group->index_files[snapshot] = NULL;
+      group->index_ranks[snapshot] = 0;
+   }
+   group->indexed = 0;
+}
+
+//Only rank 0 touches the directory's listing. The index goes first, so that a
+//snapshot half removed is no longer a snapshot.
+void __af_remove_snapshot(fenix_af_group_t* group, int timestamp){
+   char* path = __af_path(group, timestamp, -1);
+   unlink(path);
+   free(path);
+
+   for(int file = 0; ; file++){
+      path = __af_path(group, timestamp, file);
+      int result = unlink(path);
+      free(path);
+      if(result != 0) break;
+   }
+}
+
+//Adds a snapshot to the list, dropping the oldest past the depth.
+void __af_add_snapshot(fenix_af_group_t* group, int timestamp, int my_rank){
+   int position = group->num_snapshots;
+   while(position > 0 && group->timestamp[position-1] > timestamp){
+      position--;
+   }
+
+   if(group->num_snapshots == __af_keep(group)){
+      if(position == 0){
+         if(my_rank == 0) __af_remove_snapshot(group, timestamp);
+         return;
+      }
+      if(my_rank == 0) __af_remove_snapshot(group, group->timestamp[0]);
+      memmove(group->timestamp, group->timestamp + 1, (position - 1)*sizeof(int));
+      position--;
+   } else {
+      memmove(group->timestamp + position + 1, group->timestamp + position,
+            (group->num_snapshots - position)*sizeof(int));
+      group->num_snapshots++;
+   }
+   group->timestamp[position] = timestamp;
+}
+
+//Finds the snapshots an earlier job left, collective over the group.
+void __af_load(fenix_af_group_t* group){
+   if(group->loaded) return;
+   group->loaded = 1;
+
+   int my_rank;
+   MPI_Comm_rank(group->base.comm, &my_rank);
+   DIR* dir = my_rank == 0 ? opendir(group->directory) : NULL;
+   if(dir != NULL){
+      struct dirent* file;
+      while((file = readdir(dir)) != NULL){
+         int groupid, timestamp, length = 0;
+         if(sscanf(file->d_name, "g%d_t%d.idx%n", &groupid, &timestamp, &length) == 2 &&
+               length > 0 && file->d_name[length] == '\0' && groupid == group->base.groupid){
+            __af_add_snapshot(group, timestamp, my_rank);
+         }
+      }
+      closedir(dir);
+   }
+
+   MPI_Bcast(&(group->num_snapshots), 1, MPI_INT, 0, group->base.comm);
+   MPI_Bcast(group->timestamp, group->num_snapshots, MPI_INT, 0, group->base.comm);
+   if(group->num_snapshots > 0){
+      int newest = group->timestamp[group->num_snapshots - 1];
+      group->base.timestamp = newest;
+      if(newest >= group->next_timestamp) group->next_timestamp = newest + 1;
+   }
+}
+
+//Sets mentry to point to the right index for a given memberid, or to where it
+//would be inserted. Returns FENIX_SUCCESS only if it was found.
+int __af_find_mentry(fenix_af_group_t* group, int memberid, fenix_af_mentry_t** mentry){
+   if(group->entries_count == 0){
+      *mentry = group->entries;
+      return __FENIX_AF_NO_MEMBERS;
+   }
+
+   //List is sorted by member id, do binary search.
+   int lower_bound = 0, upper_bound = group->entries_count;
+   while(lower_bound < upper_bound){
+      int to_check = (lower_bound + upper_bound)/2;
+      if(group->entries[to_check].memberid < memberid){
+         lower_bound = to_check + 1;
+      } else {
+         upper_bound = to_check;
+      }
+   }
+
+   *mentry = group->entries + lower_bound;
+   if(lower_bound < group->entries_count && (*mentry)->memberid == memberid){
+      return FENIX_SUCCESS;
+   }
+   return -1;
+}
+
+int __af_member_create(fenix_group_t* g, fenix_member_entry_t* mentry){
+   fenix_af_group_t* group = (fenix_af_group_t*)g;
+
+   fenix_af_mentry_t* new_mentry;
+   if(__af_find_mentry(group, mentry->memberid, &new_mentry) == FENIX_SUCCESS){
+      debug_print("Error Fenix_Data_member_create: member_id <%d> already exists in this policy\n",
+            mentry->memberid);
+      return -1;
+   }
+
+   //Double check that we have room for the member.
+   int index = new_mentry - group->entries;
+   if(group->entries_count >= group->entries_size){
+      group->entries = (fenix_af_mentry_t*) s_realloc(group->entries,
+            group->entries_size * 2 * sizeof(fenix_af_mentry_t));
+      group->entries_size *= 2;
+   }
+   new_mentry = group->entries + index;
+   memmove(new_mentry + 1, new_mentry, (group->entries_count - index) * sizeof(fenix_af_mentry_t));
+
+   new_mentry->memberid = mentry->memberid;
+   new_mentry->staging = NULL;
+   new_mentry->staging_size = 0;
+   __fenix_data_subset_init(1, &(new_mentry->staging_regions));
+   new_mentry->staging_regions.specifier = __FENIX_SUBSET_EMPTY;
+
+   group->entries_count++;
+   return FENIX_SUCCESS;
+}
+
+void __af_member_free(fenix_af_mentry_t* mentry){
+   __fenix_data_subset_free(&(mentry->staging_regions));
+   free(mentry->staging);
+}
+
+int __af_member_delete(fenix_group_t* g, int member_id){
+   fenix_af_group_t* group = (fenix_af_group_t*)g;
+
+   fenix_af_mentry_t* mentry;
+   if(__af_find_mentry(group, member_id, &mentry) != FENIX_SUCCESS){
+      debug_print("ERROR Fenix_Data_member_delete: member_id <%d> does not exist!\n",
+                member_id);
+      return FENIX_ERROR_INVALID_MEMBERID;
+   }
+
+   __af_member_free(mentry);
+
+   int member_index = mentry - group->entries;
+   memmove(mentry, mentry + 1, (group->entries_count - 1 - member_index) * sizeof(fenix_af_mentry_t));
+   group->entries_count--;
+
+   return FENIX_SUCCESS;
+}
+
+int __af_member_store_common(fenix_group_t* g, int member_id, 
+        Fenix_Data_subset* subset, int vectored){
+   fenix_af_group_t* group = (fenix_af_group_t*)g;
+
+   fenix_af_mentry_t* mentry;
+   if(__af_find_mentry(group, member_id, &mentry) != FENIX_SUCCESS){
+      debug_print("ERROR Fenix_Data_member_store: member_id <%d> does not exist on rank <%d>!\n",
+                member_id, g->current_rank);
+      return FENIX_ERROR_INVALID_MEMBERID;
+   }
+
+   int member_data_index = __fenix_search_memberid(group->base.member, member_id);
+   fenix_member_entry_t* member_data = &(group->base.member->member_entry[member_data_index]);
+
+   size_t data_size = (size_t)member_data->datatype_size * member_data->current_count;
+   if(mentry->staging_size < data_size){
+      mentry->staging = s_realloc(mentry->staging, data_size);
+      mentry->staging_size = data_size;
+   }
+
+   if(vectored){
+      __fenix_data_member_gather_buffers(member_data, subset, mentry->staging);
+   } else {
+      __fenix_data_subset_copy_data(subset, mentry->staging, member_data->user_data,
+            member_data->datatype_size, member_data->current_count);
+   }
+   __fenix_data_subset_merge_inplace(&(mentry->staging_regions), subset);
+
+   return FENIX_SUCCESS;
+}
+
+int __af_member_store(fenix_group_t* g, int member_id, 
+        Fenix_Data_subset subset_specifier){
+   return __af_member_store_common(g, member_id, &subset_specifier, 0);
+}
+
+int __af_member_storev(fenix_group_t* g, int member_id, 
+        Fenix_Data_subset subset_specifier){
+   return __af_member_store_common(g, member_id, &subset_specifier, 1);
+}
+
+//Stores only copy to memory, the files are written at commit.
+int __af_member_istore(fenix_group_t* g, int member_id, 
+        Fenix_Data_subset subset_specifier, Fenix_Request *request){
+   request->mpi_send_req = MPI_REQUEST_NULL;
+   request->mpi_recv_req = MPI_REQUEST_NULL;
+   request->data_request = NULL;
+   return __af_member_store_common(g, member_id, &subset_specifier, 0);
+}
+
+int __af_member_istorev(fenix_group_t* g, int member_id, 
+        Fenix_Data_subset subset_specifier, Fenix_Request *request){
+   request->mpi_send_req = MPI_REQUEST_NULL;
+   request->mpi_recv_req = MPI_REQUEST_NULL;
+   request->data_request = NULL;
+   return __af_member_store_common(g, member_id, &subset_specifier, 1);
+}
+
+int __af_request_wait(fenix_group_t* group, fenix_data_request_t* request){
+   return FENIX_SUCCESS;
+}
+
+int __af_request_test(fenix_group_t* group, fenix_data_request_t* request, int* flag){
+   *flag = 1;
+   return FENIX_SUCCESS;
+}
+
+//Packs the staged data of every member, and empties the staging areas.
+char* __af_pack_blob(fenix_af_group_t* group, size_t* blob_size){
+   void** serialized = (void**) s_malloc(group->entries_count * sizeof(void*) + 1);
+   size_t* elements = (size_t*) s_malloc(group->entries_count * sizeof(size_t) + 1);
+   int* datatype_sizes = (int*) s_malloc(group->entries_count * sizeof(int) + 1);
+
+   *blob_size = sizeof(int);
+   for(int eid = 0; eid < group->entries_count; eid++){
+      fenix_af_mentry_t* mentry = group->entries + eid;
+      int member_data_index = __fenix_search_memberid(group->base.member, mentry->memberid);
+      fenix_member_entry_t* member_data = &(group->base.member->member_entry[member_data_index]);
+
+      datatype_sizes[eid] = member_data->datatype_size;
+      serialized[eid] = __fenix_data_subset_serialize(&(mentry->staging_regions), mentry->staging,
+            member_data->datatype_size, member_data->current_count, elements + eid);
+      *blob_size += (4 + 3*mentry->staging_regions.num_blocks + 3)*sizeof(int) + 
+            sizeof(long long) + elements[eid]*member_data->datatype_size;
+   }
+
+   char* blob = (char*) s_malloc(*blob_size);
+   char* position = blob;
+   memcpy(position, &(group->entries_count), sizeof(int));
+   position += sizeof(int);
+   for(int eid = 0; eid < group->entries_count; eid++){
+      fenix_af_mentry_t* mentry = group->entries + eid;
+      Fenix_Data_subset* ss = &(mentry->staging_regions);
+      int member_data_index = __fenix_search_memberid(group->base.member, mentry->memberid);
+
+      int* ints = (int*)position;
+      ints[0] = mentry->memberid;
+      ints[1] = datatype_sizes[eid];
+      ints[2] = group->base.member->member_entry[member_data_index].current_count;
+      ints[3] = 3*ss->num_blocks + 3;
+      ints[4] = ss->num_blocks;
+      for(int i = 0; i < ss->num_blocks; i++){
+         ints[5+3*i] = ss->start_offsets[i];
+         ints[6+3*i] = ss->end_offsets[i];
+         ints[7+3*i] = ss->num_repeats[i];
+      }
+      ints[5+3*ss->num_blocks] = ss->stride;
+      ints[6+3*ss->num_blocks] = ss->specifier;
+      position += (4 + ints[3])*sizeof(int);
+
+      long long data_size = (long long)elements[eid]*datatype_sizes[eid];
+      memcpy(position, &data_size, sizeof(long long));
+      position += sizeof(long long);
+      if(data_size > 0){
+         memcpy(position, serialized[eid], data_size);
+         position += data_size;
+      }
+      free(serialized[eid]);
+
+      ss->specifier = __FENIX_SUBSET_EMPTY;
+   }
+
+   free(serialized);
+   free(elements);
+   free(datatype_sizes);
+   return blob;
+}
+
+//Non-leaders hand their blob to the node leader.
+void __af_send_blob(fenix_af_group_t* group, char* blob, size_t blob_size){
+   for(size_t offset = 0; offset < blob_size; offset += __FENIX_AF_PIECE_SIZE){
+      size_t piece = blob_size - offset < __FENIX_AF_PIECE_SIZE ? blob_size - offset : __FENIX_AF_PIECE_SIZE;
+      MPI_Send(blob + offset, (int)piece, MPI_BYTE, 0, __FENIX_AF_BLOB_TAG, group->node_comm);
+   }
+}
+
+//Leaders write their node's blobs as one file, their own and then each node
+//rank's as its pieces come in, so the node's blobs never all sit in memory.
+//Everything is received even if the file can't be written.
+int __af_write_node_file(fenix_af_group_t* group, int timestamp, char* blob,
+        long long* sizes, int num_entries){
+   size_t header_size = (3 + 3*(size_t)num_entries)*sizeof(long long);
+   long long* header = (long long*) s_malloc(header_size);
+   header[0] = __FENIX_AF_MAGIC;
+   header[1] = timestamp;
+   header[2] = num_entries;
+   long long offset = header_size;
+   size_t largest = 0;
+   for(int entry = 0; entry < num_entries; entry++){
+      header[3+3*entry] = group->node_ranks[entry];
+      header[4+3*entry] = offset;
+      header[5+3*entry] = sizes[entry];
+      offset += sizes[entry];
+      if(entry > 0 && (size_t)sizes[entry] > largest) largest = sizes[entry];
+   }
+
+   char* path = __af_path(group, timestamp, group->file);
+   int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+   int retval = fd >= 0 && __af_pwrite(fd, header, header_size, 0) == 0 &&
+         __af_pwrite(fd, blob, sizes[0], header[4]) == 0 ? 0 : -1;
+
+   char* piece = (char*) s_malloc((largest < __FENIX_AF_PIECE_SIZE ? largest : __FENIX_AF_PIECE_SIZE) + 1);
+   for(int entry = 1; entry < num_entries; entry++){
+      for(long long done = 0; done < sizes[entry]; done += __FENIX_AF_PIECE_SIZE){
+         size_t length = sizes[entry] - done < __FENIX_AF_PIECE_SIZE ? sizes[entry] - done : __FENIX_AF_PIECE_SIZE;
+         MPI_Recv(piece, (int)length, MPI_BYTE, entry, __FENIX_AF_BLOB_TAG, group->node_comm,
+               MPI_STATUS_IGNORE);
+         if(retval == 0 && __af_pwrite(fd, piece, length, header[4+3*entry] + done) != 0){
+            retval = -1;
+         }
+      }
+   }
+   free(piece);
+
+   if(fd >= 0){
+      if(retval == 0 && fdatasync(fd) != 0) retval = -1;
+      close(fd);
+   }
+   if(retval != 0){
+      debug_print("ERROR Fenix_Data_commit: unable to write <%s>: %s\n", path, strerror(errno));
+   }
+
+   free(path);
+   free(header);
+   return retval;
+}
+
+//Rank 0 publishes the snapshot, under a temporary name until it is complete.
+int __af_write_index(fenix_af_group_t* group, int timestamp){
+   int num_ranks;
+   MPI_Comm_size(group->base.comm, &num_ranks);
+   size_t index_size = (4 + (size_t)num_ranks)*sizeof(int);
+   int* index = (int*) s_malloc(index_size);
+   index[0] = __FENIX_AF_MAGIC;
+   index[1] = timestamp;
+   index[2] = num_ranks;
+   index[3] = group->num_files;
+   memcpy(index + 4, group->file_of_rank, num_ranks*sizeof(int));
+
+   char* path = __af_path(group, timestamp, -1);
+   size_t path_size = strlen(path) + 8;
+   char* tmp_path = (char*) s_malloc(path_size);
+   snprintf(tmp_path, path_size, "%s.tmp", path);
+
+   int retval = -1;
+   int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+   if(fd >= 0){
+      if(__af_pwrite(fd, index, index_size, 0) == 0 && fdatasync(fd) == 0){
+         retval = 0;
+      }
+      close(fd);
+      if(retval == 0){
+         retval = rename(tmp_path, path);
+      }
+   }
+   if(retval != 0){
+      debug_print("ERROR Fenix_Data_commit: unable to write <%s>: %s\n", path, strerror(errno));
+      unlink(tmp_path);
+   }
+
+   free(tmp_path);
+   free(path);
+   free(index);
+   return retval;
+}
+
+int __af_commit(fenix_group_t* g){
+   fenix_af_group_t* group = (fenix_af_group_t*)g;
+
+   __af_load(group);
+   __af_drop_cache(group);
+   int timestamp = group->next_timestamp++;
+
+   size_t blob_size;
+   char* blob = __af_pack_blob(group, &blob_size);
+   int failed = 0;
+
+   int node_rank, node_size;
+   MPI_Comm_rank(group->node_comm, &node_rank);
+   MPI_Comm_size(group->node_comm, &node_size);
+   long long my_size = blob_size;
+   long long* sizes = NULL;
+   if(node_rank == 0){
+      sizes = (long long*) s_malloc(node_size * sizeof(long long));
+   }
+   MPI_Gather(&my_size, 1, MPI_LONG_LONG, sizes, 1, MPI_LONG_LONG, 0, group->node_comm);
+
+   if(node_rank == 0){
+      failed = __af_write_node_file(group, timestamp, blob, sizes, node_size) != 0;
+   } else {
+      __af_send_blob(group, blob, blob_size);
+   }
+   free(blob);
+   free(sizes);
+
+   //Every node's file has to be there before the index points at them.
+   MPI_Allreduce(MPI_IN_PLACE, &failed, 1, MPI_INT, MPI_MAX, g->comm);
+   int my_rank;
+   MPI_Comm_rank(g->comm, &my_rank);
+   if(!failed && my_rank == 0){
+      failed = __af_write_index(group, timestamp);
+   }
+   MPI_Bcast(&failed, 1, MPI_INT, 0, g->comm);
+
+   if(failed){
+      if(my_rank == 0) __af_remove_snapshot(group, timestamp);
+      return FENIX_ERROR_COMMIT_BARRIER;
+   }
+
+   __af_add_snapshot(group, timestamp, my_rank);
+   group->base.timestamp = timestamp;
+   return FENIX_SUCCESS;
+}
+
+int __af_snapshot_delete(fenix_group_t* g, int time_stamp){
+   fenix_af_group_t* group = (fenix_af_group_t*)g;
+   __af_drop_cache(group);
+
+   for(int snapshot = 0; snapshot < group->num_snapshots; snapshot++){
+      if(group->timestamp[snapshot] == time_stamp){
+         if(g->current_rank == 0) __af_remove_snapshot(group, time_stamp);
+         memmove(group->timestamp + snapshot, group->timestamp + snapshot + 1,
+               (group->num_snapshots - snapshot - 1)*sizeof(int));
+         group->num_snapshots--;
+         return FENIX_SUCCESS;
+      }
+   }
+
+   return FENIX_ERROR_INVALID_TIMESTAMP;
+}
+
+int __af_barrier(fenix_group_t* group){return 0;}
+
+int __af_get_number_of_snapshots(fenix_group_t* group, int* number_of_snapshots){
+   return ((fenix_af_group_t*)group)->num_snapshots;
+}
+
+int __af_get_snapshot_at_position(fenix_group_t* g, int position, int* time_stamp){
+   fenix_af_group_t* group = (fenix_af_group_t*)g;
+
+   if(position < 0 || !(position < group->num_snapshots)){
+      return FENIX_ERROR_INVALID_POSITION;
+   }
+
+   *time_stamp = group->timestamp[group->num_snapshots - 1 - position];
+   return FENIX_SUCCESS;
+}
+
+//Reads which file each old rank's blob went to in every snapshot, once per
+//restore pass. Rank 0 reads the indexes for everyone.
+void __af_read_indexes(fenix_af_group_t* group){
+   if(group->indexed) return;
+   group->indexed = 1;
+
+   int my_rank;
+   MPI_Comm_rank(group->base.comm, &my_rank);
+   for(int snapshot = 0; snapshot < group->num_snapshots; snapshot++){
+      int header[4] = {0, 0, 0, 0};
+      int* file_of_rank = NULL;
+      if(my_rank == 0){
+         char* path = __af_path(group, group->timestamp[snapshot], -1);
+         int fd = open(path, O_RDONLY);
+         free(path);
+         if(fd >= 0){
+            if(__af_pread(fd, header, sizeof(header), 0) != 0 || header[0] != __FENIX_AF_MAGIC ||
+                  header[2] < 0){
+               header[2] = 0;
+            } else {
+               file_of_rank = (int*) s_malloc(header[2] * sizeof(int) + 1);
+               if(__af_pread(fd, file_of_rank, header[2] * sizeof(int), sizeof(header)) != 0){
+                  header[2] = 0;
+               }
+            }
+            close(fd);
+         }
+      }
+
+      MPI_Bcast(header + 2, 1, MPI_INT, 0, group->base.comm);
+      if(my_rank != 0){
+         file_of_rank = (int*) s_malloc(header[2] * sizeof(int) + 1);
+      }
+      MPI_Bcast(file_of_rank, header[2], MPI_INT, 0, group->base.comm);
+
+      group->index_files[snapshot] = file_of_rank;
+      group->index_ranks[snapshot] = header[2];
+   }
+}
+
+//Finds where each of source_rank's members is in one snapshot, reading only
+//the blob's member headers.
+void __af_locate(fenix_af_group_t* group, int snapshot, int source_rank){
+   if(group->located_source != source_rank){
+      __af_drop_locators(group);
+      group->located_source = source_rank;
+   }
+   if(group->num_located[snapshot] >= 0) return;
+   group->num_located[snapshot] = 0;
+
+   if(source_rank < 0 || !(source_rank < group->index_ranks[snapshot])) return;
+   int timestamp = group->timestamp[snapshot];
+   char* path = __af_path(group, timestamp, group->index_files[snapshot][source_rank]);
+   int fd = open(path, O_RDONLY);
+   free(path);
+   if(fd < 0) return;
+
+   long long header[3];
+   long long blob_offset = -1, blob_size = 0;
+   if(__af_pread(fd, header, sizeof(header), 0) == 0 && header[0] == __FENIX_AF_MAGIC &&
+         header[1] == timestamp && header[2] > 0){
+      long long* entries = (long long*) s_malloc(3 * header[2] * sizeof(long long));
+      if(__af_pread(fd, entries, 3 * header[2] * sizeof(long long), sizeof(header)) == 0){
+         for(long long entry = 0; entry < header[2]; entry++){
+            if(entries[3*entry] == source_rank){
+               blob_offset = entries[3*entry + 1];
+               blob_size = entries[3*entry + 2];
+               break;
+            }
+         }
+      }
+      free(entries);
+   }
+
+   int num_members;
+   if(blob_offset < 0 || blob_size < (long long)sizeof(int) ||
+         __af_pread(fd, &num_members, sizeof(int), blob_offset) != 0 || num_members < 0){
+      close(fd);
+      return;
+   }
+
+   fenix_af_locator_t* located = 
+      (fenix_af_locator_t*) s_malloc((num_members + 1) * sizeof(fenix_af_locator_t));
+   long long position = sizeof(int);
+   int member;
+   for(member = 0; member < num_members; member++){
+      int ints[4];
+      long long data_size;
+      if(position + (long long)sizeof(ints) > blob_size ||
+            __af_pread(fd, ints, sizeof(ints), blob_offset + position) != 0 || ints[3] < 0){
+         break;
+      }
+      long long data_position = position + (4 + (long long)ints[3])*sizeof(int);
+      if(data_position + (long long)sizeof(long long) > blob_size ||
+            __af_pread(fd, &data_size, sizeof(long long), blob_offset + data_position) != 0){
+         break;
+      }
+      long long end = data_position + sizeof(long long) + data_size;
+      if(data_size < 0 || end > blob_size) break;
+
+      located[member].memberid = ints[0];
+      located[member].offset = blob_offset + position;
+      located[member].size = end - position;
+      position = end;
+   }
+   close(fd);
+
+   group->located[snapshot] = located;
+   group->num_located[snapshot] = member;
+}
+
+//Reads a member's data in one snapshot out of source_rank's blob.
+int __af_read_record(fenix_af_group_t* group, int snapshot, int source_rank,
+        int member_id, fenix_af_record_t* record){
+   record->found = 0;
+   __af_locate(group, snapshot, source_rank);
+
+   fenix_af_locator_t* locator = NULL;
+   for(int member = 0; member < group->num_located[snapshot]; member++){
+      if(group->located[snapshot][member].memberid == member_id){
+         locator = group->located[snapshot] + member;
+         break;
+      }
+   }
+   if(locator == NULL) return -1;
+
+   char* path = __af_path(group, group->timestamp[snapshot],
+         group->index_files[snapshot][source_rank]);
+   int fd = open(path, O_RDONLY);
+   free(path);
+   if(fd < 0) return -1;
+
+   char* buffer = (char*) s_malloc(locator->size + 1);
+   int result = __af_pread(fd, buffer, locator->size, locator->offset);
+   close(fd);
+   if(result != 0){
+      free(buffer);
+      return -1;
+   }
+
+   int* ints = (int*)buffer;
+   char* position = buffer + (4 + ints[3])*sizeof(int);
+   long long data_size;
+   memcpy(&data_size, position, sizeof(long long));
+   position += sizeof(long long);
+
+   record->found = 1;
+   record->datatype_size = ints[1];
+   record->count = ints[2];
+   __fenix_data_subset_init(ints[4], &(record->regions));
+   for(int i = 0; i < ints[4]; i++){
+      record->regions.start_offsets[i] = ints[5+3*i];
+      record->regions.end_offsets[i] = ints[6+3*i];
+      record->regions.num_repeats[i] = ints[7+3*i];
+   }
+   record->regions.stride = ints[5+3*ints[4]];
+   record->regions.specifier = ints[6+3*ints[4]];
+   record->data = s_malloc(data_size + 1);
+   memcpy(record->data, position, data_size);
+
+   free(buffer);
+   return 0;
+}
+
+int __af_restore(fenix_af_group_t* group, int member_id, void* target_buffer,
+        int max_count, int source_rank, Fenix_Data_subset* data_found){
+   __af_load(group);
+
+   int return_found_data;
+   if(data_found == NULL){
+      data_found = (Fenix_Data_subset*) malloc(sizeof(Fenix_Data_subset));
+      return_found_data = 0;
+   } else {
+      return_found_data = 1;   
+   }
+   __fenix_data_subset_init(1, data_found);
+   data_found->specifier = __FENIX_SUBSET_EMPTY;
+
+   __af_read_indexes(group);
+   fenix_af_record_t* records = 
+      (fenix_af_record_t*) s_malloc((group->num_snapshots + 1) * sizeof(fenix_af_record_t));
+
+   //Newest data wins, go back only as far as it takes to cover the member.
+   int count = -1;
+   int oldest_snapshot = group->num_snapshots;
+   while(oldest_snapshot > 0 && (count < 0 || !__fenix_data_subset_is_full(data_found, count))){
+      oldest_snapshot--;
+      fenix_af_record_t* record = records + oldest_snapshot;
+      if(__af_read_record(group, oldest_snapshot, source_rank, member_id, record) != 0){
+         continue;
+      }
+      if(count < 0){
+         count = record->count;
+      }
+      if(record->count != count || record->count > max_count){
+         debug_print("ERROR Fenix_Data_member_restore: member_id <%d> of snapshot <%d> has <%d> elements, does not fit\n",
+               member_id, group->timestamp[oldest_snapshot], record->count);
+         __fenix_data_subset_free(&(record->regions));
+         free(record->data);
+         record->found = 0;
+         continue;
+      }
+      __fenix_data_subset_merge_inplace(data_found, &(record->regions));
+   }
+
+   for(int snapshot = oldest_snapshot; snapshot < group->num_snapshots; snapshot++){
+      fenix_af_record_t* record = records + snapshot;
+      if(!record->found) continue;
+      __fenix_data_subset_deserialize(&(record->regions), record->data, target_buffer,
+            record->count, record->datatype_size);
+      __fenix_data_subset_free(&(record->regions));
+      free(record->data);
+   }
+   free(records);
+
+   int retval;
+   if(count < 0){
+      debug_print("ERROR Fenix_Data_member_restore: no snapshot holds member_id <%d> of rank <%d>\n",
+            member_id, source_rank);
+      retval = FENIX_ERROR_NODATA_FOUND;
+   } else if(__fenix_data_subset_is_full(data_found, count)){
+      retval = FENIX_SUCCESS;
+   } else {
+      retval = FENIX_WARNING_PARTIAL_RESTORE;
+   }
+
+   if(!return_found_data){
+      __fenix_data_subset_free(data_found);
+      free(data_found);
+   }
+   return retval;
+}
+
+int __af_member_restore(fenix_group_t* g, int member_id,
+        void* target_buffer, int max_count, int time_stamp, Fenix_Data_subset* data_found){ 
+   return __af_restore((fenix_af_group_t*)g, member_id, target_buffer, max_count,
+         g->current_rank, data_found);
+}
+
+int __af_member_restore_from_rank(fenix_group_t* g, int member_id,
+        void* target_buffer, int max_count, int time_stamp, 
+        int source_rank){
+   return __af_restore((fenix_af_group_t*)g, member_id, target_buffer, max_count,
+         source_rank, NULL);
+}
+
+int __af_member_get_attribute(fenix_group_t* group, fenix_member_entry_t* member, 
+        int attributename, void* attributevalue, int* flag, int sourcerank){
+   //No attributes of its own (as of now)
+   return FENIX_ERROR_INVALID_ATTRIBUTE_NAME;
+}
+
+int __af_member_set_attribute(fenix_group_t* group, fenix_member_entry_t* member, 
+        int attributename, void* attributevalue, int* flag){ 
+   //No mutable attributes (as of now) require any changes to this policy's info
+   return FENIX_SUCCESS;
+}
+
+int __af_reinit(fenix_group_t* g, int* flag){
+   fenix_af_group_t* group = (fenix_af_group_t*)g;
+
+   //Rebuild the node comms around the repaired comm. The old ones may have
+   //lost members, so they are dropped rather than freed.
+   free(group->node_ranks);
+   free(group->file_of_rank);
+   __af_build_comms(group, g->comm);
+   __af_drop_cache(group);
+
+   *flag = FENIX_SUCCESS;
+   return FENIX_SUCCESS;
+}
+
+//policy_value needs room for the directory's path.
+int __af_get_redundant_policy(fenix_group_t* g, int* policy_name, 
+        void* policy_value, int* flag){
+   fenix_af_group_t* group = (fenix_af_group_t*)g;
+
+   *policy_name = FENIX_DATA_POLICY_AGGREGATED_FILE;
+   strcpy((char*)policy_value, group->directory);
+
+   *flag = FENIX_SUCCESS;
+   return FENIX_SUCCESS;
+}
+
+int __af_group_delete(fenix_group_t* g){
+   fenix_af_group_t* group = (fenix_af_group_t*)g;
+
+   for(int entry = 0; entry < group->entries_count; entry++){
+      __af_member_free(group->entries + entry);
+   }
+   free(group->entries);
+
+   //We have the responsibility of destroying the member array in the base group struct.
+   __fenix_data_member_destroy(group->base.member);
+
+   __af_free_comms(group);
+   __af_drop_cache(group);
+   free(group->index_files);
+   free(group->index_ranks);
+   free(group->located);
+   free(group->num_located);
+   free(group->timestamp);
+   free(group->directory);
+   free(group);
+   return FENIX_SUCCESS;
+}
@@ -0,0 +1,1039 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//
+//            _|_|_|_|  _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//            _|        _|        _|_|    _|    _|      _|  _|
+//            _|_|_|    _|_|_|    _|  _|  _|    _|        _|
+//            _|        _|        _|    _|_|    _|      _|  _|
+//            _|        _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//
+//
+//
+//
+// Copyright (C) 2016 Rutgers University and Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author Marc Gamell, Eric Valenzuela, Keita Teranishi, Manish Parashar,
+//        Michael Heroux, and Matthew Whitlock
+//
+// Questions? Contact Keita Teranishi (knteran@sandia.gov) and
+//                    Marc Gamell (mgamell@cac.rutgers.edu)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#include <mpi.h>
+#include <string.h>
+#include "fenix.h"
+#include "fenix_opt.h"
+#include "fenix_data_subset.h"
+#include "fenix_data_recovery.h"
+#include "fenix_data_policy.h"
+#include "fenix_data_group.h"
+#include "fenix_data_member.h"
+#include "fenix_gf256.h"
+#include "fenix_xor.h"
+#include "fenix_ext.h"
+
+#define __FENIX_EC_DEFAULT_MENTRY_NUM 10
+#define __FENIX_EC_NO_MEMBERS 16000
+#define __EC_RECOVER_DATA_REGION_TAG 97855
+
+//k+m erasure coding over a set of k+m ranks, a generalization of RAID 5/6.
+//Each member is split into k equal chunks (padding out the last). Stripe s has
+//its m parity chunks on set ranks s, s+1, ..., s+m-1 and every other set rank
+//contributes one chunk to it. Parity row j is a Cauchy Reed-Solomon combination
+//of the contributors' chunks, so any k of a stripe's k+m chunks rebuild the
+//rest. A slot is [k data chunks][m parity chunks], parity chunk j being row j
+//of stripe (my set rank - j).
+
+//data, data_regions and timestamp are a ring of depth+2 slots, snapshot i
+//(oldest first, current_head is the staging area) is in slot (oldest+i)%(depth+2).
+typedef struct __fenix_ec_mentry{
+   int memberid;
+   void** data;
+   Fenix_Data_subset* data_regions;
+   int* timestamp;
+   int oldest;
+   int current_head;
+} fenix_ec_mentry_t;
+
+typedef struct __fenix_ec_request{
+   fenix_data_request_t base;
+   int memberid;
+   Fenix_Data_subset subset;
+   void* scratch;
+   int num_requests;
+   MPI_Request* requests;
+   int error;
+   struct __fenix_ec_request* next;
+} fenix_ec_request_t;
+
+typedef struct __fenix_ec_group{
+   fenix_group_t base;
+   int data_ranks;
+   int parity_ranks;
+   int rank_separation;
+   int set_size;
+   int* partners;
+   MPI_Comm set_comm;
+   //Row j's weight for set rank c is coefficients[j*set_size + c].
+   uint8_t* coefficients;
+   int entries_size;
+   int entries_count;
+   fenix_ec_mentry_t* entries;
+   int num_snapshots;
+   fenix_ec_request_t* requests;
+} fenix_ec_group_t;
+
+int __ec_group_delete(fenix_group_t* group);
+int __ec_member_create(fenix_group_t* group, fenix_member_entry_t* mentry);
+int __ec_member_delete(fenix_group_t* group, int member_id);
+int __ec_get_redundant_policy(fenix_group_t*, int* policy_name, 
+        void* policy_value, int* flag);
+int __ec_member_store(fenix_group_t* group, int member_id, 
+        Fenix_Data_subset subset_specifier);
+int __ec_member_storev(fenix_group_t* group, int member_id, 
+        Fenix_Data_subset subset_specifier);
+int __ec_member_istore(fenix_group_t* group, int member_id, 
+        Fenix_Data_subset subset_specifier, Fenix_Request *request);
+int __ec_member_istorev(fenix_group_t* group, int member_id, 
+        Fenix_Data_subset subset_specifier, Fenix_Request *request);
+int __ec_request_wait(fenix_group_t* group, fenix_data_request_t* request);
+int __ec_request_test(fenix_group_t* group, fenix_data_request_t* request, int* flag);
+int __ec_commit(fenix_group_t* group);
+int __ec_snapshot_delete(fenix_group_t* group, int time_stamp);
+int __ec_barrier(fenix_group_t* group);
+int __ec_member_restore(fenix_group_t* group, int member_id,
+        void* target_buffer, int max_count, int time_stamp,
+        Fenix_Data_subset* data_found);
+int __ec_member_restore_from_rank(fenix_group_t* group, int member_id,
+        void* target_buffer, int max_count, int time_stamp, 
+        int source_rank);
+int __ec_member_get_attribute(fenix_group_t* group, fenix_member_entry_t* member, 
+        int attributename, void* attributevalue, int* flag, int sourcerank);
+int __ec_member_set_attribute(fenix_group_t* group, fenix_member_entry_t* member, 
+        int attributename, void* attributevalue, int* flag);
+int __ec_get_number_of_snapshots(fenix_group_t* group, int* number_of_snapshots);
+int __ec_get_snapshot_at_position(fenix_group_t* group, int position, int* time_stamp);
+int __ec_reinit(fenix_group_t* group, int* flag);
+int __ec_progress(fenix_group_t* group);
+
+void __ec_complete_pending(fenix_ec_group_t* group);
+void __ec_complete_member_pending(fenix_ec_group_t* group, int memberid);
+void __ec_bound_pending(fenix_ec_group_t* group, int max);
+int __ec_slot(fenix_ec_group_t* group, fenix_ec_mentry_t* mentry, int snapshot);
+
+void __ec_build_set_comm(fenix_ec_group_t* group, MPI_Comm comm){
+   MPI_Group comm_group, set_group;
+   MPI_Comm_group(comm, &comm_group);
+   MPI_Group_incl(comm_group, group->set_size, group->partners, &set_group);
+   MPI_Comm_create_group(comm, set_group, 0, &(group->set_comm));
+   MPI_Group_free(&set_group);
+   MPI_Group_free(&comm_group);
+}
+
+void __fenix_policy_erasure_code_get_group(fenix_group_t** group, MPI_Comm comm, 
+      int timestart, int depth, void* policy_value, int* flag){
+   //policy_value is {k, m, rank_separation}. The Cauchy points x_j and y_c
+   //must all be distinct in GF(2^8), so k+2m may not exceed 256.
+   int* policy_vals = (int*)policy_value;
+   int k = policy_vals[0], m = policy_vals[1];
+   if(k < 1 || m < 1 || k + 2*m > 256 || policy_vals[2] < 1){
+      debug_print("ERROR Fenix_Data_group_create: erasure code k <%d>, m <%d>, rank separation <%d> need k >= 1, m >= 1, k+2m <= 256 and a positive separation\n",
+            k, m, policy_vals[2]);
+      *group = NULL;
+      *flag = FENIX_ERROR_GROUP_CREATE;
+      return;
+   }
+
+   *group = (fenix_group_t *)malloc(sizeof(fenix_ec_group_t));
+   fenix_ec_group_t *new_group = (fenix_ec_group_t *)(*group);
+   new_group->base.vtbl.group_delete = *__ec_group_delete;
+   new_group->base.vtbl.member_create = *__ec_member_create;
+   new_group->base.vtbl.member_delete = *__ec_member_delete;
+   new_group->base.vtbl.get_redundant_policy = *__ec_get_redundant_policy;
+   new_group->base.vtbl.member_store = *__ec_member_store;
+   new_group->base.vtbl.member_storev = *__ec_member_storev;
+   new_group->base.vtbl.member_istore = *__ec_member_istore;
+   new_group->base.vtbl.member_istorev = *__ec_member_istorev;
+   new_group->base.vtbl.member_store_all = NULL;
+   new_group->base.vtbl.store_plan_create = NULL;
+   new_group->base.vtbl.store_plan_start = NULL;
+   new_group->base.vtbl.store_plan_free = NULL;
+   new_group->base.vtbl.request_wait = *__ec_request_wait;
+   new_group->base.vtbl.request_test = *__ec_request_test;
+   new_group->base.vtbl.commit = *__ec_commit;
+   new_group->base.vtbl.snapshot_delete = *__ec_snapshot_delete;
+   new_group->base.vtbl.barrier = *__ec_barrier;
+   new_group->base.vtbl.member_restore = *__ec_member_restore;
+   new_group->base.vtbl.member_restore_from_rank = *__ec_member_restore_from_rank;
+   new_group->base.vtbl.member_get_attribute = *__ec_member_get_attribute;
+   new_group->base.vtbl.member_set_attribute = *__ec_member_set_attribute;
+   new_group->base.vtbl.get_number_of_snapshots = *__ec_get_number_of_snapshots;
+   new_group->base.vtbl.get_snapshot_at_position = *__ec_get_snapshot_at_position;
+   new_group->base.vtbl.reinit = *__ec_reinit;
+   new_group->base.vtbl.progress = *__ec_progress;
+
+   //User is responsible for giving values that "make sense" given a comm size.
+   new_group->data_ranks = policy_vals[0];
+   new_group->parity_ranks = policy_vals[1];
+   new_group->rank_separation = policy_vals[2];
+   new_group->set_size = new_group->data_ranks + new_group->parity_ranks;
+
+   int my_rank, comm_size;
+   MPI_Comm_size(comm, &comm_size);
+   MPI_Comm_rank(comm, &my_rank);
+
+   //Sets are laid out just like RAID 5 sets.
+   new_group->partners = (int*) malloc(sizeof(int) * new_group->set_size);
+   int my_set_pos = (my_rank/new_group->rank_separation)%new_group->set_size;
+   for(int index = 0; index < new_group->set_size; index++){
+     new_group->partners[index] = (comm_size + my_rank - (new_group->rank_separation * (my_set_pos-index)))%comm_size;
+   }
+   __ec_build_set_comm(new_group, comm);
+
+   //Cauchy matrix 1/(x_j + y_c) with x_j = j and y_c = m + c. Every square
+   //submatrix of a Cauchy matrix is invertible, which is what makes any k
+   //surviving chunks enough.
+   __fenix_gf256_init();
+   new_group->coefficients = (uint8_t*) malloc(new_group->parity_ranks * new_group->set_size);
+   for(int row = 0; row < new_group->parity_ranks; row++){
+      for(int rank = 0; rank < new_group->set_size; rank++){
+         new_group->coefficients[row*new_group->set_size + rank] = 
+               __fenix_gf256_div(1, row ^ (new_group->parity_ranks + rank));
+      }
+   }
+
+   new_group->entries_size = __FENIX_EC_DEFAULT_MENTRY_NUM;
+   new_group->entries_count = 0;
+   new_group->entries = 
+      (fenix_ec_mentry_t*) malloc(sizeof(fenix_ec_mentry_t) * __FENIX_EC_DEFAULT_MENTRY_NUM);
+   new_group->num_snapshots = 0;
+   new_group->requests = NULL;
+
+   *flag = FENIX_SUCCESS;
+}
+
+int __ec_slot(fenix_ec_group_t* group, fenix_ec_mentry_t* mentry, int snapshot){
+   return (mentry->oldest + snapshot) % (group->base.depth + 2);
+}
+
+//Rotates the ring back so slot i holds snapshot i, the layout recovery works on.
+void __ec_unwrap_ring(fenix_ec_group_t* group, fenix_ec_mentry_t* mentry){
+   int num_slots = group->base.depth + 2;
+   if(mentry->oldest == 0) return;
+
+   void** data = (void**) s_malloc(num_slots * sizeof(void*));
+   Fenix_Data_subset* data_regions = (Fenix_Data_subset*) s_malloc(num_slots * sizeof(Fenix_Data_subset));
+   int* timestamp = (int*) s_malloc(num_slots * sizeof(int));
+   for(int snapshot = 0; snapshot < num_slots; snapshot++){
+      int slot = __ec_slot(group, mentry, snapshot);
+      data[snapshot] = mentry->data[slot];
+      data_regions[snapshot] = mentry->data_regions[slot];
+      timestamp[snapshot] = mentry->timestamp[slot];
+   }
+   memcpy(mentry->data, data, num_slots * sizeof(void*));
+   memcpy(mentry->data_regions, data_regions, num_slots * sizeof(Fenix_Data_subset));
+   memcpy(mentry->timestamp, timestamp, num_slots * sizeof(int));
+   free(data);
+   free(data_regions);
+   free(timestamp);
+
+   mentry->oldest = 0;
+}
+
+//Sets mentry to point to the right index for a given memberid, or to where it
+//would be inserted. Returns FENIX_SUCCESS only if it was found.
+int __ec_find_mentry(fenix_ec_group_t* group, int memberid, fenix_ec_mentry_t** mentry){
+   if(group->entries_count == 0){
+      *mentry = group->entries;
+      return __FENIX_EC_NO_MEMBERS;
+   }
+
+   //List is sorted by member id, do binary search.
+   int lower_bound = 0, upper_bound = group->entries_count;
+   while(lower_bound < upper_bound){
+      int to_check = (lower_bound + upper_bound)/2;
+      if(group->entries[to_check].memberid < memberid){
+         lower_bound = to_check + 1;
+      } else {
+         upper_bound = to_check;
+      }
+   }
+
+   *mentry = group->entries + lower_bound;
+   if(lower_bound < group->entries_count && (*mentry)->memberid == memberid){
+      return FENIX_SUCCESS;
+   }
+   return -1;
+}
+
+int __ec_chunk_size(fenix_ec_group_t* group, int local_data_size){
+   return (local_data_size + group->data_ranks - 1)/group->data_ranks;
+}
+
+//Which of rank's chunks goes to stripe, or -1 if rank holds parity for it.
+int __ec_chunk_index(fenix_ec_group_t* group, int rank, int stripe){
+   int set_size = group->set_size;
+   if((rank - stripe + set_size)%set_size < group->parity_ranks) return -1;
+
+   int index = 0;
+   for(int i = 0; i < stripe; i++){
+      if((rank - i + set_size)%set_size >= group->parity_ranks) index++;
+   }
+   return index;
+}
+
+int __ec_member_create(fenix_group_t* g, fenix_member_entry_t* mentry){
+   fenix_ec_group_t* group = (fenix_ec_group_t*)g;
+
+   fenix_ec_mentry_t* new_mentry;
+   if(__ec_find_mentry(group, mentry->memberid, &new_mentry) == FENIX_SUCCESS){
+      debug_print("Error Fenix_Data_member_create: member_id <%d> already exists in this policy\n",
+            mentry->memberid);
+      return -1;
+   }
+
+   //Double check that we have room for the member.
+   int index = new_mentry - group->entries;
+   if(group->entries_count >= group->entries_size){
+      group->entries = (fenix_ec_mentry_t*) s_realloc(group->entries,
+            group->entries_size * 2 * sizeof(fenix_ec_mentry_t));
+      group->entries_size *= 2;
+   }
+   new_mentry = group->entries + index;
+   memmove(new_mentry + 1, new_mentry, (group->entries_count - index) * sizeof(fenix_ec_mentry_t));
+
+   new_mentry->memberid = mentry->memberid;
+   new_mentry->oldest = 0;
+   new_mentry->current_head = 0;
+   new_mentry->data = (void**) malloc((group->base.depth + 2) * sizeof(void*));
+   new_mentry->data_regions = 
+      (Fenix_Data_subset*) malloc((group->base.depth + 2) * sizeof(Fenix_Data_subset));
+   new_mentry->timestamp = (int*) malloc((group->base.depth + 2) * sizeof(int));
+
+   size_t slot_size = (size_t)group->set_size * 
+         __ec_chunk_size(group, mentry->datatype_size * mentry->current_count);
+   for(int i = 0; i < group->base.depth + 2; i++){
+      new_mentry->data[i] = s_malloc(slot_size);
+      __fenix_data_subset_init(1, new_mentry->data_regions + i);
+      new_mentry->data_regions[i].specifier = __FENIX_SUBSET_EMPTY;
+      //-1 is not a valid timestamp, use as an indicator that the data isn't valid.
+      new_mentry->timestamp[i] = -1;
+   }
+   //The first commit's timestamp is the group's timestart.
+   new_mentry->timestamp[0] = group->base.timestart;
+
+   group->entries_count++;
+   return FENIX_SUCCESS;
+}
+
+void __ec_member_free(fenix_ec_mentry_t* mentry, int depth){
+   for(int i = 0; i < depth + 2; i++){
+      __fenix_data_subset_free(mentry->data_regions + i);
+      free(mentry->data[i]);
+   }
+   free(mentry->data);
+   free(mentry->data_regions);
+   free(mentry->timestamp);
+}
+
+int __ec_member_delete(fenix_group_t* g, int member_id){
+   fenix_ec_group_t* group = (fenix_ec_group_t*)g;
+
+   fenix_ec_mentry_t* mentry;
+   if(__ec_find_mentry(group, member_id, &mentry) != FENIX_SUCCESS){
+      debug_print("ERROR Fenix_Data_member_delete: member_id <%d> does not exist!\n",
+                member_id);
+      return FENIX_ERROR_INVALID_MEMBERID;
+   }
+
+   __ec_complete_pending(group);
+   __ec_member_free(mentry, group->base.depth);
+
+   int member_index = mentry - group->entries;
+   memmove(mentry, mentry + 1, (group->entries_count - 1 - member_index) * sizeof(fenix_ec_mentry_t));
+   group->entries_count--;
+
+   return FENIX_SUCCESS;
+}
+
+//Copies the data into the staging snapshot and starts the parity reductions,
+//every stripe's rows at once.
+fenix_ec_request_t* __ec_start_store(fenix_ec_group_t* group, fenix_ec_mentry_t* mentry,
+        fenix_member_entry_t* member_data, Fenix_Data_subset* subset, int vectored){
+   //Back-pressure: past the bound, a new store waits for the oldest ones.
+   if(fenix.data_progress_queue > 0){
+      __ec_bound_pending(group, fenix.data_progress_queue - 1);
+   }
+
+   //Earlier istores of this member may still be reducing into the staging
+   //snapshot's parity, which is about to be cleared.
+   __ec_complete_member_pending(group, mentry->memberid);
+
+   fenix_ec_request_t* request = (fenix_ec_request_t*) s_malloc(sizeof(fenix_ec_request_t));
+   request->base.group = &(group->base);
+   request->base.completed = 0;
+   request->memberid = mentry->memberid;
+   request->error = 0;
+   __fenix_data_subset_deep_copy(subset, &(request->subset));
+
+   int my_set_rank;
+   MPI_Comm_rank(group->set_comm, &my_set_rank);
+
+   int k = group->data_ranks, m = group->parity_ranks;
+   int local_data_size = member_data->datatype_size * member_data->current_count;
+   int chunk_size = __ec_chunk_size(group, local_data_size);
+   char* data_buf = (char*)mentry->data[__ec_slot(group, mentry, mentry->current_head)];
+   char* parity_buf = data_buf + (size_t)k*chunk_size;
+
+   if(vectored){
+      __fenix_data_member_gather_buffers(member_data, subset, data_buf);
+   } else {
+      __fenix_data_subset_copy_data(subset, data_buf, member_data->user_data,
+            member_data->datatype_size, member_data->current_count);
+   }
+   //Padding takes part in the parity, so keep it deterministic.
+   memset(data_buf + local_data_size, 0, (size_t)k*chunk_size - local_data_size);
+
+   //Each row's weighted copy of my chunks, then a chunk of zeros to send for
+   //the stripes I hold parity for.
+   request->scratch = s_malloc(((size_t)m*k + 1)*chunk_size);
+   char* zeros = (char*)request->scratch + (size_t)m*k*chunk_size;
+   for(int row = 0; row < m; row++){
+      __fenix_gf256_mul_region(group->coefficients[row*group->set_size + my_set_rank], data_buf,
+            (char*)request->scratch + (size_t)row*k*chunk_size, (size_t)k*chunk_size);
+   }
+   memset(zeros, 0, chunk_size);
+
+   //Parity is reduced in place on its holder, which adds nothing to it.
+   memset(parity_buf, 0, (size_t)m*chunk_size);
+
+   request->num_requests = group->set_size * m;
+   request->requests = (MPI_Request*) s_malloc(request->num_requests * sizeof(MPI_Request));
+   for(int stripe = 0; stripe < group->set_size; stripe++){
+      int chunk = __ec_chunk_index(group, my_set_rank, stripe);
+      for(int row = 0; row < m; row++){
+         int root = (stripe + row)%group->set_size;
+         void* send;
+         if(my_set_rank == root){
+            send = MPI_IN_PLACE;
+         } else if(chunk < 0){
+            send = zeros;
+         } else {
+            send = (char*)request->scratch + ((size_t)row*k + chunk)*chunk_size;
+         }
+         MPI_Ireduce(send, parity_buf + (size_t)row*chunk_size, chunk_size, MPI_BYTE, fenix.xor_op,
+               root, group->set_comm, request->requests + stripe*m + row);
+      }
+   }
+
+   request->next = group->requests;
+   group->requests = request;
+   return request;
+}
+
+//Drives a store's reductions, returns whether the request has completed.
+int __ec_request_progress(fenix_ec_group_t* group, fenix_ec_request_t* request, int blocking){
+   int flag = 1;
+   int result;
+
+   if(request->base.completed) return 1;
+
+   if(blocking){
+      result = MPI_Waitall(request->num_requests, request->requests, MPI_STATUSES_IGNORE);
+   } else {
+      result = MPI_Testall(request->num_requests, request->requests, &flag, MPI_STATUSES_IGNORE);
+   }
+
+   if(result != MPI_SUCCESS){
+      //Most likely a failure mid-store, there is nothing useful left to do with the request.
+      debug_print("ERROR Fenix_Data_member_store: communication for member_id <%d> failed on rank <%d>\n",
+            request->memberid, group->base.current_rank);
+      request->error = 1;
+      flag = 1;
+   } else if(flag){
+      fenix_ec_mentry_t* mentry;
+      __ec_find_mentry(group, request->memberid, &mentry);
+      __fenix_data_subset_merge_inplace(mentry->data_regions + __ec_slot(group, mentry, mentry->current_head),
+            &(request->subset));
+   }
+
+   if(flag){
+      free(request->scratch);
+      free(request->requests);
+      request->scratch = NULL;
+      request->requests = NULL;
+      request->base.completed = 1;
+   }
+
+   return flag;
+}
+
+//Anything which touches the staging snapshot needs all stores into it to be done.
+void __ec_complete_pending(fenix_ec_group_t* group){
+   for(fenix_ec_request_t* request = group->requests; request != NULL; request = request->next){
+      __ec_request_progress(group, request, 1);
+   }
+}
+
+//Just the stores of one member, all that its staging snapshot depends on.
+void __ec_complete_member_pending(fenix_ec_group_t* group, int memberid){
+   for(fenix_ec_request_t* request = group->requests; request != NULL; request = request->next){
+      if(request->memberid == memberid){
+         __ec_request_progress(group, request, 1);
+      }
+   }
+}
+
+//Leaves at most max of the newest stores in flight, waiting on the older ones.
+void __ec_bound_pending(fenix_ec_group_t* group, int max){
+   int in_flight = 0;
+   for(fenix_ec_request_t* request = group->requests; request != NULL; request = request->next){
+      if(request->base.completed) continue;
+      if(in_flight < max){
+         in_flight++;
+      } else {
+         __ec_request_progress(group, request, 1);
+      }
+   }
+}
+
+int __ec_progress(fenix_group_t* g){
+   fenix_ec_group_t* group = (fenix_ec_group_t*)g;
+   int in_flight = 0;
+   for(fenix_ec_request_t* request = group->requests; request != NULL; request = request->next){
+      if(!__ec_request_progress(group, request, 0)) in_flight++;
+   }
+   return in_flight;
+}
+
+void __ec_request_free(fenix_ec_group_t* group, fenix_ec_request_t* request){
+   fenix_ec_request_t** link = &(group->requests);
+   while(*link != NULL && *link != request){
+      link = &((*link)->next);
+   }
+   if(*link != NULL){
+      *link = request->next;
+   }
+
+   __fenix_data_subset_free(&(request->subset));
+   free(request);
+}
+
+int __ec_request_wait(fenix_group_t* g, fenix_data_request_t* r){
+   fenix_ec_group_t* group = (fenix_ec_group_t*)g;
+   fenix_ec_request_t* request = (fenix_ec_request_t*)r;
+
+   __ec_request_progress(group, request, 1);
+   int retval = request->error ? FENIX_ERROR_DATA_WAIT : FENIX_SUCCESS;
+
+   __ec_request_free(group, request);
+   return retval;
+}
+
+int __ec_request_test(fenix_group_t* g, fenix_data_request_t* r, int* flag){
+   fenix_ec_group_t* group = (fenix_ec_group_t*)g;
+   fenix_ec_request_t* request = (fenix_ec_request_t*)r;
+
+   *flag = __ec_request_progress(group, request, 0);
+   return request->error ? FENIX_ERROR_DATA_WAIT : FENIX_SUCCESS;
+}
+
+int __ec_member_istore_common(fenix_group_t* g, int member_id, 
+        Fenix_Data_subset subset_specifier, Fenix_Request *request, int vectored){
+   fenix_ec_group_t* group = (fenix_ec_group_t*)g;
+
+   fenix_ec_mentry_t* mentry;
+   if(__ec_find_mentry(group, member_id, &mentry) != FENIX_SUCCESS){
+      debug_print("ERROR Fenix_Data_member_store: member_id <%d> does not exist on rank <%d>!\n",
+                member_id, g->current_rank);
+      return FENIX_ERROR_INVALID_MEMBERID;
+   }
+
+   int member_data_index = __fenix_search_memberid(group->base.member, member_id);
+   fenix_member_entry_t* member_data = &(group->base.member->member_entry[member_data_index]);
+
+   fenix_ec_request_t* ec_request = __ec_start_store(group, mentry, member_data,
+         &subset_specifier, vectored);
+
+   request->mpi_send_req = MPI_REQUEST_NULL;
+   request->mpi_recv_req = MPI_REQUEST_NULL;
+   request->data_request = &(ec_request->base);
+   return FENIX_SUCCESS;
+}
+
+int __ec_member_istore(fenix_group_t* g, int member_id, 
+        Fenix_Data_subset subset_specifier, Fenix_Request *request){
+   return __ec_member_istore_common(g, member_id, subset_specifier, request, 0);
+}
+
+int __ec_member_istorev(fenix_group_t* g, int member_id, 
+        Fenix_Data_subset subset_specifier, Fenix_Request *request){
+   return __ec_member_istore_common(g, member_id, subset_specifier, request, 1);
+}
+
+int __ec_member_store(fenix_group_t* g, int member_id, 
+        Fenix_Data_subset subset_specifier){
+   Fenix_Request request;
+   int retval = __ec_member_istore(g, member_id, subset_specifier, &request);
+   if(retval == FENIX_SUCCESS){
+      retval = __ec_request_wait(g, request.data_request);
+   }
+   return retval;
+}
+
+int __ec_member_storev(fenix_group_t* g, int member_id, 
+        Fenix_Data_subset subset_specifier){
+   Fenix_Request request;
+   int retval = __ec_member_istorev(g, member_id, subset_specifier, &request);
+   if(retval == FENIX_SUCCESS){
+      retval = __ec_request_wait(g, request.data_request);
+   }
+   return retval;
+}
+
+int __ec_commit(fenix_group_t* g){
+   fenix_ec_group_t* group = (fenix_ec_group_t*)g;
+
+   __ec_complete_pending(group);
+
+   for(int eid = 0; eid < group->entries_count; eid++){ 
+      fenix_ec_mentry_t* mentry = &group->entries[eid];
+
+      if(mentry->current_head == group->base.depth + 1){
+         //The entry is full, the oldest snapshot's slot becomes the staging area.
+         mentry->oldest = __ec_slot(group, mentry, 1);
+      } else {
+         mentry->current_head++;
+         if(eid == 0){
+            group->num_snapshots++;
+         }
+      }
+
+      int head = __ec_slot(group, mentry, mentry->current_head);
+      mentry->data_regions[head].specifier = __FENIX_SUBSET_EMPTY;
+      mentry->timestamp[head] = mentry->timestamp[__ec_slot(group, mentry, mentry->current_head - 1)] + 1;
+   }
+
+   fenix_ec_mentry_t* first = group->entries;
+   group->base.timestamp = first->timestamp[__ec_slot(group, first, first->current_head - 1)];
+
+   return FENIX_SUCCESS;
+}
+
+int __ec_snapshot_delete(fenix_group_t* g, int time_stamp){
+   int retval = FENIX_SUCCESS;
+   fenix_ec_group_t* group = (fenix_ec_group_t*)g;
+
+   __ec_complete_pending(group);
+
+   for(int entry_id = 0; entry_id < group->entries_count && retval == FENIX_SUCCESS; entry_id++){
+      fenix_ec_mentry_t* mentry = &group->entries[entry_id];
+
+      //Snapshots are sorted by timestamp, and current_head is the staging area.
+      for(int snapshot = mentry->current_head - 1; snapshot >= 0 && retval == FENIX_SUCCESS; snapshot--){
+         int slot = __ec_slot(group, mentry, snapshot);
+         if(mentry->timestamp[slot] < time_stamp){
+            retval = FENIX_ERROR_INVALID_TIMESTAMP;
+         } else if(mentry->timestamp[slot] == time_stamp){
+            void* old_data = mentry->data[slot];
+            Fenix_Data_subset old_regions = mentry->data_regions[slot];
+
+            if(snapshot == 0){
+               mentry->oldest = __ec_slot(group, mentry, 1);
+            } else {
+               //Newer snapshots move down a position, taking their subsets with them.
+               for(int to_shift = snapshot; to_shift < mentry->current_head; to_shift++){
+                  int to = __ec_slot(group, mentry, to_shift);
+                  int from = __ec_slot(group, mentry, to_shift + 1);
+                  mentry->timestamp[to] = mentry->timestamp[from];
+                  mentry->data_regions[to] = mentry->data_regions[from];
+                  mentry->data[to] = mentry->data[from];
+               }
+               slot = __ec_slot(group, mentry, mentry->current_head);
+               mentry->data[slot] = old_data;
+               mentry->data_regions[slot] = old_regions;
+            }
+            mentry->data_regions[slot].specifier = __FENIX_SUBSET_EMPTY;
+
+            mentry->current_head--;
+            break;
+         }
+      }
+   }
+
+   if(retval == FENIX_SUCCESS){
+      group->num_snapshots--;
+   }
+
+   return retval;
+}
+
+int __ec_barrier(fenix_group_t* group){return 0;}
+
+int __ec_get_number_of_snapshots(fenix_group_t* group, int* number_of_snapshots){
+   return ((fenix_ec_group_t*)group)->num_snapshots;
+}
+
+int __ec_get_snapshot_at_position(fenix_group_t* g, int position, int* time_stamp){
+   fenix_ec_group_t* group = (fenix_ec_group_t*)g;
+
+   if(!(position < group->num_snapshots)){
+      return FENIX_ERROR_INVALID_POSITION;
+   }
+
+   //Each member has the same snapshots, so just query the first.
+   fenix_ec_mentry_t* first = group->entries;
+   *time_stamp = first->timestamp[__ec_slot(group, first, first->current_head - 1 - position)];
+   return FENIX_SUCCESS;
+}
+
+//Rebuilds one snapshot on the lost set ranks. For each stripe the survivors sum
+//up every parity row (P_j if they hold it, their weighted chunk if they
+//contribute) onto each lost rank. With the lost pieces zeroed, surviving rows
+//become a small linear system in the lost chunks, and lost rows can be
+//recomputed once those are known.
+void __ec_rebuild(fenix_ec_group_t* group, void* snapshot_data, int local_data_size,
+        int* lost, int num_lost){
+   int my_set_rank;
+   MPI_Comm_rank(group->set_comm, &my_set_rank);
+
+   int k = group->data_ranks, m = group->parity_ranks, set_size = group->set_size;
+   int chunk_size = __ec_chunk_size(group, local_data_size);
+   char* data_buf = (char*)snapshot_data;
+   char* parity_buf = data_buf + (size_t)k*chunk_size;
+
+   int i_am_lost = 0;
+   for(int i = 0; i < num_lost; i++){
+      if(lost[i] == my_set_rank) i_am_lost = 1;
+   }
+
+   char* sums = (char*) s_malloc((size_t)m*chunk_size);
+   char* result = (char*) s_malloc((size_t)m*chunk_size);
+   char* lost_chunks = (char*) s_malloc((size_t)num_lost*chunk_size);
+   uint8_t* matrix = (uint8_t*) s_malloc(num_lost*num_lost);
+   uint8_t* inverse = (uint8_t*) s_malloc(num_lost*num_lost);
+   int* lost_contributors = (int*) s_malloc(num_lost*sizeof(int));
+   int* rows = (int*) s_malloc(m*sizeof(int));
+
+   for(int stripe = 0; stripe < set_size; stripe++){
+      int chunk = __ec_chunk_index(group, my_set_rank, stripe);
+      int my_row = (my_set_rank - stripe + set_size)%set_size;
+
+      memset(sums, 0, (size_t)m*chunk_size);
+      if(i_am_lost){
+         //Nothing to add.
+      } else if(chunk < 0){
+         memcpy(sums + (size_t)my_row*chunk_size, parity_buf + (size_t)my_row*chunk_size, chunk_size);
+      } else {
+         for(int row = 0; row < m; row++){
+            __fenix_gf256_mul_region(group->coefficients[row*set_size + my_set_rank],
+                  data_buf + (size_t)chunk*chunk_size, sums + (size_t)row*chunk_size, chunk_size);
+         }
+      }
+
+      for(int i = 0; i < num_lost; i++){
+         MPI_Reduce(sums, result, m*chunk_size, MPI_BYTE, fenix.xor_op, lost[i], group->set_comm);
+      }
+
+      if(!i_am_lost) continue;
+
+      //Sort the stripe's lost pieces into data chunks and parity rows.
+      int num_lost_contributors = 0, num_rows = 0;
+      int row_lost[256] = {0};
+      for(int i = 0; i < num_lost; i++){
+         int lost_row = (lost[i] - stripe + set_size)%set_size;
+         if(lost_row < m){
+            row_lost[lost_row] = 1;
+         } else {
+            lost_contributors[num_lost_contributors++] = lost[i];
+         }
+      }
+      for(int row = 0; row < m && num_rows < num_lost_contributors; row++){
+         if(!row_lost[row]) rows[num_rows++] = row;
+      }
+
+      //A surviving row's sum is the weighted sum of just the lost chunks.
+      if(num_lost_contributors > 0){
+         for(int a = 0; a < num_lost_contributors; a++){
+            for(int b = 0; b < num_lost_contributors; b++){
+               matrix[a*num_lost_contributors + b] = 
+                     group->coefficients[rows[a]*set_size + lost_contributors[b]];
+            }
+         }
+         __fenix_gf256_invert_matrix(matrix, inverse, num_lost_contributors);
+
+         memset(lost_chunks, 0, (size_t)num_lost_contributors*chunk_size);
+         for(int b = 0; b < num_lost_contributors; b++){
+            for(int a = 0; a < num_lost_contributors; a++){
+               __fenix_gf256_mul_region_xor(inverse[b*num_lost_contributors + a],
+                     result + (size_t)rows[a]*chunk_size, lost_chunks + (size_t)b*chunk_size, chunk_size);
+            }
+         }
+      }
+
+      if(chunk >= 0){
+         for(int b = 0; b < num_lost_contributors; b++){
+            if(lost_contributors[b] == my_set_rank){
+               memcpy(data_buf + (size_t)chunk*chunk_size, lost_chunks + (size_t)b*chunk_size, chunk_size);
+            }
+         }
+      } else {
+         //A lost row's sum is missing the lost chunks' share.
+         char* parity = parity_buf + (size_t)my_row*chunk_size;
+         memcpy(parity, result + (size_t)my_row*chunk_size, chunk_size);
+         for(int b = 0; b < num_lost_contributors; b++){
+            __fenix_gf256_mul_region_xor(group->coefficients[my_row*set_size + lost_contributors[b]],
+                  lost_chunks + (size_t)b*chunk_size, parity, chunk_size);
+         }
+      }
+   }
+
+   free(sums);
+   free(result);
+   free(lost_chunks);
+   free(matrix);
+   free(inverse);
+   free(lost_contributors);
+   free(rows);
+}
+
+int __ec_member_restore(fenix_group_t* g, int member_id,
+        void* target_buffer, int max_count, int time_stamp, Fenix_Data_subset* data_found){ 
+   int retval = -1;
+   fenix_ec_group_t* group = (fenix_ec_group_t*)g;
+
+   __ec_complete_pending(group);
+   
+   fenix_ec_mentry_t* mentry;
+   int found_member = !(__ec_find_mentry(group, member_id, &mentry));
+   if(found_member){
+      __ec_unwrap_ring(group, mentry);
+   }
+
+   int member_data_index = __fenix_search_memberid(group->base.member, member_id);
+   fenix_member_entry_t member_data = group->base.member->member_entry[member_data_index];
+
+   int* set_results = (int*) s_malloc(sizeof(int) * group->set_size);
+   MPI_Allgather((void*)&found_member, 1, MPI_INT, (void*)set_results, 1, MPI_INT, 
+         group->set_comm);
+
+   //Up to m lost ranks can be rebuilt, metadata comes from the first survivor.
+   int* lost = (int*) s_malloc(sizeof(int) * group->set_size);
+   int num_lost = 0, sender = -1;
+   for(int i = 0; i < group->set_size; i++){
+      if(!set_results[i]){
+         lost[num_lost++] = i;
+      } else if(sender == -1){
+         sender = i;
+      }
+   }
+   free(set_results);
+
+   int recovery_locally_possible;
+   if(num_lost > 0 && num_lost <= group->parity_ranks){
+      int my_set_rank;
+      MPI_Comm_rank(group->set_comm, &my_set_rank);
+
+      if(my_set_rank == sender){
+         for(int i = 0; i < num_lost; i++){
+            __fenix_data_member_send_metadata(group->base.groupid, member_id, group->partners[lost[i]]);
+
+            MPI_Send((void*) &(group->num_snapshots), 1, MPI_INT, lost[i], 
+                  RECOVER_MEMBER_ENTRY_TAG^group->base.groupid, group->set_comm);
+            MPI_Send((void*)mentry->timestamp, group->num_snapshots+1, MPI_INT, lost[i],
+                  RECOVER_MEMBER_ENTRY_TAG^group->base.groupid, group->set_comm);
+
+            for(int snapshot = 0; snapshot < group->num_snapshots; snapshot++){
+               __fenix_data_subset_send(mentry->data_regions + snapshot, lost[i], 
+                     __EC_RECOVER_DATA_REGION_TAG ^ group->base.groupid, group->set_comm);
+            }
+         }
+
+      } else if(!found_member){
+         //Remake the member just like the user would, then fill in its entries.
+         fenix_member_entry_packet_t packet;
+         __fenix_data_member_recv_metadata(group->base.groupid, group->partners[sender], &packet);
+         __fenix_member_create(group->base.groupid, packet.memberid, NULL, packet.current_count,
+               packet.current_datatype);
+
+         __ec_find_mentry(group, member_id, &mentry);
+         member_data_index = __fenix_search_memberid(group->base.member, member_id);
+         member_data = group->base.member->member_entry[member_data_index];
+
+         MPI_Recv((void*)&(group->num_snapshots), 1, MPI_INT, sender,
+               RECOVER_MEMBER_ENTRY_TAG^group->base.groupid, group->set_comm, NULL);
+
+         mentry->current_head = group->num_snapshots;
+
+         MPI_Recv((void*)(mentry->timestamp), group->num_snapshots + 1, MPI_INT, sender,
+               RECOVER_MEMBER_ENTRY_TAG^group->base.groupid, group->set_comm, NULL);
+
+         for(int snapshot = 0; snapshot < group->num_snapshots; snapshot++){
+            __fenix_data_subset_free(mentry->data_regions+snapshot);
+            __fenix_data_subset_recv(mentry->data_regions+snapshot, sender,
+                  __EC_RECOVER_DATA_REGION_TAG ^ group->base.groupid, group->set_comm);
+         }
+      }
+
+      for(int snapshot = 0; snapshot < group->num_snapshots; snapshot++){
+         __ec_rebuild(group, mentry->data[snapshot], 
+               member_data.datatype_size*member_data.current_count, lost, num_lost);
+      }
+
+      recovery_locally_possible = 1;
+   } else if(!found_member){
+      debug_print("ERROR Fenix_Data_member_restore: member_id <%d> does not exist at <%d> and is not recoverable from erasure coded set\n",
+            member_id, group->base.current_rank);
+      retval = FENIX_ERROR_INVALID_MEMBERID;
+      recovery_locally_possible = 0;
+   } else {
+      recovery_locally_possible = 1;
+   }
+   free(lost);
+
+   //Now that we've ensured everyone has data, restore from it.
+   int return_found_data;
+   if(data_found == NULL){
+      data_found = (Fenix_Data_subset*) malloc(sizeof(Fenix_Data_subset));
+      return_found_data = 0;
+   } else {
+      return_found_data = 1;   
+   }
+   __fenix_data_subset_init(1, data_found);
+   data_found->specifier = __FENIX_SUBSET_EMPTY;
+   
+   if(recovery_locally_possible){
+      int oldest_snapshot;
+      for(oldest_snapshot = (mentry->current_head - 1); oldest_snapshot >= 0; oldest_snapshot--){
+         __fenix_data_subset_merge_inplace(data_found, mentry->data_regions + oldest_snapshot);
+         if(__fenix_data_subset_is_full(data_found, member_data.current_count)){
+            //The snapshots have formed a full set of data, no need to add older snapshots.
+            break;
+         }
+      }
+      if(oldest_snapshot == -1){
+         oldest_snapshot = 0;
+      }
+ 
+      for(int i = oldest_snapshot; i < mentry->current_head; i++){
+         __fenix_data_subset_copy_data(&mentry->data_regions[i], target_buffer,
+               mentry->data[i], member_data.datatype_size, member_data.current_count);
+      }
+
+      if(__fenix_data_subset_is_full(data_found, member_data.current_count)){
+        retval = FENIX_SUCCESS;
+      } else {
+        retval = FENIX_WARNING_PARTIAL_RESTORE;
+      }
+
+      //Dont forget to clear the commit buffer
+      mentry->data_regions[mentry->current_head].specifier = __FENIX_SUBSET_EMPTY;
+   }
+
+   if(!return_found_data){
+      __fenix_data_subset_free(data_found);
+      free(data_found);
+   }
+
+   return retval;
+}
+
+int __ec_member_restore_from_rank(fenix_group_t* group, int member_id,
+        void* target_buffer, int max_count, int time_stamp, 
+        int source_rank){return 0;}
+
+int __ec_member_get_attribute(fenix_group_t* group, fenix_member_entry_t* member, 
+        int attributename, void* attributevalue, int* flag, int sourcerank){
+   //No attributes of its own (as of now)
+   return FENIX_ERROR_INVALID_ATTRIBUTE_NAME;
+}
+
+int __ec_member_set_attribute(fenix_group_t* group, fenix_member_entry_t* member, 
+        int attributename, void* attributevalue, int* flag){ 
+   //No mutable attributes (as of now) require any changes to this policy's info
+   return FENIX_SUCCESS;
+}
+
+int __ec_reinit(fenix_group_t* g, int* flag){
+   fenix_ec_group_t* group = (fenix_ec_group_t*)g;
+
+   //Stores interrupted by the failure will error out, they just need to be cleaned up.
+   __ec_complete_pending(group);
+
+   //Rebuild the set comm to re-include the failed node(s).
+   __ec_build_set_comm(group, g->comm);
+
+   *flag = FENIX_SUCCESS;
+   return FENIX_SUCCESS;
+}
+
+int __ec_get_redundant_policy(fenix_group_t* g, int* policy_name, 
+        void* policy_value, int* flag){
+   fenix_ec_group_t* group = (fenix_ec_group_t*)g;
+
+   *policy_name = FENIX_DATA_POLICY_ERASURE_CODE;
+   int* policy_vals = (int*) policy_value;
+   policy_vals[0] = group->data_ranks;
+   policy_vals[1] = group->parity_ranks;
+   policy_vals[2] = group->rank_separation;
+
+   *flag = FENIX_SUCCESS;
+   return FENIX_SUCCESS;
+}
+
+int __ec_group_delete(fenix_group_t* g){
+   fenix_ec_group_t* group = (fenix_ec_group_t*)g;
+
+   __ec_complete_pending(group);
+   while(group->requests != NULL){
+      __ec_request_free(group, group->requests);
+   }
+
+   for(int entry = 0; entry < group->entries_count; entry++){
+      __ec_member_free(group->entries + entry, g->depth);
+   }
+   free(group->entries);
+
+   //We have the responsibility of destroying the member array in the base group struct.
+   __fenix_data_member_destroy(group->base.member);
+
+   free(group->coefficients);
+   free(group->partners);
+   free(group);
+   return FENIX_SUCCESS;
+}
@@ -55,13 +55,24 @@
 */
 
 #include <mpi.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
 #include "fenix.h"
 #include "fenix_opt.h"
 #include "fenix_data_subset.h"
 #include "fenix_data_recovery.h"
 #include "fenix_data_policy.h"
+#include "fenix_data_policy_in_memory_raid.h"
 #include "fenix_data_group.h"
 #include "fenix_data_member.h"
+#include "fenix_gf256.h"
+#include "fenix_xor.h"
+#include "fenix_hash.h"
+#include "fenix_compress.h"
+#include "fenix_arena.h"
+#include "fenix_numa.h"
+#include "fenix_ext.h"
 
 #define __FENIX_IMR_DEFAULT_MENTRY_NUM 10
 #define __FENIX_IMR_NO_MEMBERS 16000
@@ -69,6 +80,27 @@
 
 #define STORE_PAYLOAD_TAG 2004
 
+//Granularity at which all-zero parity deltas are left out of the message.
+#define __IMR_DELTA_BLOCK_SIZE 256
+
+//Message size of the pipelined RAID 1 exchange, unless the member says otherwise.
+#define __IMR_DEFAULT_CHUNK_SIZE (8*1024*1024)
+
+//Granularity at which incremental snapshots are compared and kept.
+#define __IMR_SNAPSHOT_CHUNK_SIZE (64*1024)
+
+//Granularity at which content hashing skips unchanged data.
+#define __IMR_HASH_CHUNK_SIZE (16*1024)
+#define __IMR_HASH_BITMAP_TAG 2005
+
+#define __IMR_COMPRESSED_SIZE_TAG 2006
+
+#define __IMR_RMA_ADDRESS_TAG 2007
+
+#define __IMR_RMA_FLUSHED_TAG 2008
+
+#define __IMR_RMA_READY_TAG 2009
+
 int __imr_group_delete(fenix_group_t* group);
 int __imr_member_create(fenix_group_t* group, fenix_member_entry_t* mentry);
 int __imr_member_delete(fenix_group_t* group, int member_id);
@@ -82,6 +114,11 @@ int __imr_member_istore(fenix_group_t* group, int member_id,
         Fenix_Data_subset subset_specifier, Fenix_Request *request);
 int __imr_member_istorev(fenix_group_t* group, int member_id, 
            Fenix_Data_subset subset_specifier, Fenix_Request *request);
+int __imr_member_store_all(fenix_group_t* group, Fenix_Data_subset* specifiers);
+void* __imr_store_plan_create(fenix_group_t* group, int* memberids, int num_memberids,
+        Fenix_Data_subset* subset);
+int __imr_store_plan_start(fenix_group_t* group, void* plan);
+void __imr_store_plan_free(fenix_group_t* group, void* plan);
 int __imr_commit(fenix_group_t* group);
 int __imr_snapshot_delete(fenix_group_t* group, int time_stamp);
 int __imr_barrier(fenix_group_t* group);
@@ -100,13 +137,60 @@ int __imr_get_number_of_snapshots(fenix_group_t* group,
 int __imr_get_snapshot_at_position(fenix_group_t* group, int position,
         int* time_stamp);
 int __imr_reinit(fenix_group_t* group, int* flag);
-
+int __imr_progress(fenix_group_t* group);
+int __imr_request_wait(fenix_group_t* group, fenix_data_request_t* request);
+int __imr_request_test(fenix_group_t* group, fenix_data_request_t* request,
+        int* flag);
+
+//data, data_regions, timestamp, parity_full and partner_size form a ring of
+//depth+2 slots.
+//Snapshot i, counting from the oldest, lives in slot (oldest+i)%(depth+2), and
+//snapshot current_head is the staging area.
 typedef struct __fenix_imr_mentry{
    void** data;
    Fenix_Data_subset* data_regions;
    int* timestamp;
+   int oldest;
    int current_head;
    int memberid;
+   //RAID 5 only: whether each snapshot's parity covers all of its data,
+   //which delta updates rely on.
+   int* parity_full;
+   int update_mode;
+   //RAID 1 only: bytes per message when exchanging with the partner.
+   int chunk_size;
+   //Incremental storage only whole-copies the newest snapshot and the staging
+   //area. Older snapshots have a NULL data slot and instead keep, per
+   //__IMR_SNAPSHOT_CHUNK_SIZE chunk, a copy of the chunk if it differs from the
+   //next newer snapshot or NULL if it is the same.
+   int snapshot_storage;
+   void*** chunks;
+   size_t region_size;
+   //Whether each slot's region is mapped from a spill file instead of taken
+   //from the arena, see __imr_enforce_budget.
+   int* spilled;
+   //RAID 1 only: full stores hash the data per __IMR_HASH_CHUNK_SIZE chunk
+   //and skip chunks whose hash matches the newest snapshot's. hashes are
+   //the newest snapshot's, staged_hashes those of a hashed store into the
+   //staging area.
+   int content_hash;
+   int num_hashes;
+   uint64_t* hashes;
+   uint64_t* staged_hashes;
+   int hashes_valid;
+   int staged_hashed;
+   size_t skipped_bytes;
+   //RAID 1 only: full stores send the partner a compressed copy. partner_size
+   //is the compressed size of each snapshot's partner half, 0 if it is plain.
+   int compression;
+   int* partner_size;
+   //RAID 1 over the RMA transport: rma_targets is where partners[1] exposed
+   //its copy of each slot, 0 where it couldn't, and rma_exposed whether I
+   //exposed mine to partners[0]. They are traded on the first store after
+   //the ring's regions may have moved, rma_ready says whether that's done.
+   int rma_ready;
+   int* rma_exposed;
+   MPI_Aint* rma_targets;
 } fenix_imr_mentry_t;
 
 typedef struct __fenix_imr_group{
@@ -120,10 +204,168 @@ typedef struct __fenix_imr_group{
    int entries_count;
    fenix_imr_mentry_t* entries;
    int num_snapshots;
+   struct __fenix_imr_request* requests;
+   //Snapshots, their ring bookkeeping and the buffers stores go through are
+   //carved from here, and reused as members and stores come and go.
+   fenix_arena_t* arena;
+   //Names spill files apart, see __imr_spill_region.
+   int spill_count;
+   //Bumped whenever entries move, members come and go or an attribute
+   //__imr_can_coalesce looks at changes, store plans resolved at an older
+   //version look their members up again.
+   int layout_version;
+   //RAID 1 over the RMA transport, the window the arena's mappings are
+   //attached to and the mappings it got. MPI_WIN_NULL otherwise.
+   MPI_Win window;
+   int num_attached;
+   void** attached_bases;
+   size_t* attached_sizes;
+   //Notices traded at commits, see __imr_rma_commit. rma_permit hears that
+   //partners[1] has moved on to its new staging slot, rma_notice tells
+   //partners[0] I have.
+   MPI_Request rma_permit;
+   MPI_Request rma_notice;
 } fenix_imr_group_t;
 
+//Parity positions touched by a partial RAID 5 store, per set root, along with
+//the packed bytes being reduced onto that root.
+typedef struct __fenix_imr_parity_update{
+   int* num_intervals;
+   int** intervals;
+   int* sizes;
+   void** buffers;
+   int* chunk_offsets;
+} fenix_imr_parity_update_t;
+
+//An in-flight delta update, messages to and from each set rank.
+typedef struct __fenix_imr_delta{
+   fenix_imr_parity_update_t* update;
+   void** send_bufs;
+   void** recv_bufs;
+} fenix_imr_delta_t;
+
+//Where each coalesced member's contribution to each RAID 5 parity stripe
+//sits in its data, and the buffer the stripes are packed into for reduction.
+typedef struct __fenix_imr_raid5_layout{
+   int* offsets;
+   int* lengths;
+   size_t* stripe_offsets;
+   char* packed;
+} fenix_imr_raid5_layout_t;
+
+//A store plan, everything about storing a fixed set of members with a fixed
+//subset that stays the same from one store to the next.
+typedef struct __fenix_imr_plan{
+   int num_memberids;
+   int* memberids;
+   Fenix_Data_subset subset;
+   //Members resolved at layout_version, see __imr_plan_resolve.
+   int layout_version;
+   int num_coalesced;
+   fenix_imr_mentry_t** mentries;
+   fenix_member_entry_t** members;
+   Fenix_Data_subset** subsets;
+   int* counts;
+   //Members the plan can't coalesce, stored on their own.
+   int num_unplanned;
+   int* unplanned;
+   //RAID 1: persistent send and receive per ring slot of the first member,
+   //along with the staging regions they were built for.
+   int num_slots;
+   void** slot_data;
+   MPI_Datatype* types;
+   MPI_Request* requests;
+   //RAID 5: stripes are packed into the same buffer every time.
+   fenix_imr_raid5_layout_t layout;
+   MPI_Request* reductions;
+} fenix_imr_plan_t;
+
+//An in-flight RAID 1 exchange of a contiguous subset. It goes out in
+//chunk_size messages with two in flight each way, keeping any one message
+//bounded and letting both directions stream concurrently.
+typedef struct __fenix_imr_pipeline{
+   char* src;
+   char* dest;
+   size_t total_size;
+   size_t chunk_size;
+   int num_chunks;
+   //Chunks posted, and chunks whose send/recv has been finished.
+   int next_send, next_recv;
+   int sent, received;
+   //Two send slots followed by two receive slots.
+   MPI_Request requests[4];
+   int send_partner, recv_partner, tag;
+   MPI_Comm comm;
+} fenix_imr_pipeline_t;
+
+//An in-flight (or finished but not yet waited on) istore.
+//The user's data has already been copied into the staging snapshot when this
+//is created, only the exchange of redundancy data is outstanding.
+typedef struct __fenix_imr_request{
+   fenix_data_request_t base;
+   int memberid;
+   Fenix_Data_subset subset;
+   void* send_buf;
+   void* recv_buf;
+   fenix_imr_parity_update_t* parity_update;
+   fenix_imr_delta_t* delta;
+   fenix_imr_pipeline_t* pipeline;
+   int num_requests;
+   MPI_Request* requests;
+   int error;
+   struct __fenix_imr_request* next;
+} fenix_imr_request_t;
+
+void __imr_complete_pending(fenix_imr_group_t* group);
+void __imr_complete_member_pending(fenix_imr_group_t* group, int memberid);
+void __imr_bound_pending(fenix_imr_group_t* group, int max);
+int __imr_slot(fenix_imr_group_t* group, fenix_imr_mentry_t* mentry, int snapshot);
+void __imr_free_region(fenix_imr_group_t* group, fenix_imr_mentry_t* mentry, int slot);
+int __imr_member_istore_common(fenix_group_t* g, int member_id, 
+        Fenix_Data_subset subset_specifier, Fenix_Request *request, int vectored);
+void __imr_raid5_stripe(fenix_imr_group_t* group, int data_size, int* parity_size,
+        int* remainder);
+fenix_imr_parity_update_t* __imr_raid5_plan_update(fenix_imr_group_t* group,
+        fenix_member_entry_t* member_data, Fenix_Data_subset* subset, void* data_buf,
+        int my_set_rank);
+void __imr_raid5_apply_update(fenix_imr_parity_update_t* update, void* parity_buf, int my_set_rank);
+void __imr_raid5_free_update(fenix_imr_group_t* group, fenix_imr_parity_update_t* update);
+int __imr_raid5_prepare_delta(fenix_imr_group_t* group, fenix_imr_mentry_t* mentry,
+        fenix_member_entry_t* member_data);
+fenix_imr_delta_t* __imr_raid5_start_delta(fenix_imr_group_t* group, fenix_imr_mentry_t* mentry,
+        fenix_member_entry_t* member_data, Fenix_Data_subset* subset, int vectored,
+        MPI_Request* requests);
+void __imr_raid5_finish_delta(fenix_imr_group_t* group, fenix_imr_delta_t* delta, void* parity_buf);
+void __imr_raid5_free_delta(fenix_imr_group_t* group, fenix_imr_delta_t* delta);
+fenix_imr_pipeline_t* __imr_raid1_start_pipeline(fenix_imr_group_t* group,
+        fenix_imr_mentry_t* mentry, fenix_member_entry_t* member_data, Fenix_Data_subset* subset);
+int __imr_raid1_pipeline_progress(fenix_imr_pipeline_t* pipe, int blocking);
+void __imr_raid1_free_pipeline(fenix_imr_pipeline_t* pipe);
+int __imr_raid6_chunk_size(int local_data_size, int set_size);
+void* __imr_raid6_start_store(fenix_imr_group_t* group, fenix_imr_mentry_t* mentry,
+        fenix_member_entry_t* member_data, MPI_Request* requests);
+void __imr_raid6_rebuild(fenix_imr_group_t* group, void* snapshot_data, int local_data_size,
+        int* lost, int num_lost);
+void __imr_place_partners(fenix_imr_group_t* group, MPI_Comm comm, int known);
+void __imr_rma_open(fenix_imr_group_t* group, MPI_Comm comm);
+void __imr_rma_close(fenix_imr_group_t* group);
+void __imr_rma_flush(fenix_imr_group_t* group);
+void __imr_rma_commit(fenix_imr_group_t* group);
+void __imr_rma_await_permit(fenix_imr_group_t* group);
+int __imr_rma_eligible(fenix_imr_group_t* group, fenix_imr_mentry_t* mentry);
+
 void __fenix_policy_in_memory_raid_get_group(fenix_group_t** group, MPI_Comm comm, 
       int timestart, int depth, void* policy_value, int* flag){
+   int* policy_vals = (int*)policy_value;
+   //RAID 6 needs a set size of at least 3, and at most 255 to keep Q's weights distinct.
+   if(policy_vals[0] == 6 && (policy_vals[2] < 3 || policy_vals[2] > 255)){
+      debug_print("ERROR Fenix_Data_group_create: RAID 6 set size <%d> must be between 3 and 255\n",
+            policy_vals[2]);
+      *group = NULL;
+      *flag = FENIX_ERROR_GROUP_CREATE;
+      return;
+   }
+
    *group = (fenix_group_t *)malloc(sizeof(fenix_imr_group_t));
    fenix_imr_group_t *new_group = (fenix_imr_group_t *)(*group);
    new_group->base.vtbl.group_delete = *__imr_group_delete;
@@ -134,6 +376,12 @@ void __fenix_policy_in_memory_raid_get_group(fenix_group_t** group, MPI_Comm com
    new_group->base.vtbl.member_storev = *__imr_member_storev;
    new_group->base.vtbl.member_istore = *__imr_member_istore;
    new_group->base.vtbl.member_istorev = *__imr_member_istorev;
+   new_group->base.vtbl.member_store_all = *__imr_member_store_all;
+   new_group->base.vtbl.store_plan_create = *__imr_store_plan_create;
+   new_group->base.vtbl.store_plan_start = *__imr_store_plan_start;
+   new_group->base.vtbl.store_plan_free = *__imr_store_plan_free;
+   new_group->base.vtbl.request_wait = *__imr_request_wait;
+   new_group->base.vtbl.request_test = *__imr_request_test;
    new_group->base.vtbl.commit = *__imr_commit;
    new_group->base.vtbl.snapshot_delete = *__imr_snapshot_delete;
    new_group->base.vtbl.barrier = *__imr_barrier;
@@ -144,8 +392,8 @@ void __fenix_policy_in_memory_raid_get_group(fenix_group_t** group, MPI_Comm com
    new_group->base.vtbl.get_number_of_snapshots = *__imr_get_number_of_snapshots;
    new_group->base.vtbl.get_snapshot_at_position = *__imr_get_snapshot_at_position;
    new_group->base.vtbl.reinit = *__imr_reinit;
+   new_group->base.vtbl.progress = *__imr_progress;
 
-   int* policy_vals = (int*)policy_value;
    new_group->raid_mode = policy_vals[0];
    new_group->rank_separation = policy_vals[1];
 
@@ -156,50 +404,701 @@ void __fenix_policy_in_memory_raid_get_group(fenix_group_t** group, MPI_Comm com
    if(new_group->raid_mode == 1){
       new_group->partners = (int*) malloc(sizeof(int) * 2);
       
-      //Set up the person who's data I am storing
-      //We need to add comm size to the value since otherwise we might be modding a negative number,
-      //  which is implementation-dependent behavior.
-      new_group->partners[0] = (comm_size + my_rank - new_group->rank_separation)%comm_size;
+      if(new_group->rank_separation == FENIX_DATA_RANK_SEPARATION_AUTO){
+         __imr_place_partners(new_group, comm, 0);
+      } else {
+         //Set up the person who's data I am storing
+         //We need to add comm size to the value since otherwise we might be modding a negative number,
+         //  which is implementation-dependent behavior.
+         new_group->partners[0] = (comm_size + my_rank - new_group->rank_separation)%comm_size;
 
-      //Set up the person who is storing my data
-      new_group->partners[1] = (my_rank + new_group->rank_separation)%comm_size;
+         //Set up the person who is storing my data
+         new_group->partners[1] = (my_rank + new_group->rank_separation)%comm_size;
+      }
    
-   } else if(new_group->raid_mode == 5){
+   } else if(new_group->raid_mode == 5 || new_group->raid_mode == 6){
       new_group->set_size = policy_vals[2];
       new_group->partners = (int*) malloc(sizeof(int) * new_group->set_size);
 
-      //User is responsible for giving values that "make sense" for set size and rank separation given a comm size.
-      int my_set_pos = (my_rank/new_group->rank_separation)%new_group->set_size;
-      for(int index = 0; index < new_group->set_size; index++){
-        new_group->partners[index] = (comm_size + my_rank - (new_group->rank_separation * (my_set_pos-index)))%comm_size;
+      if(new_group->rank_separation == FENIX_DATA_RANK_SEPARATION_AUTO){
+         __imr_place_partners(new_group, comm, 0);
+      } else {
+         //User is responsible for giving values that "make sense" for set size and rank separation given a comm size.
+         int my_set_pos = (my_rank/new_group->rank_separation)%new_group->set_size;
+         for(int index = 0; index < new_group->set_size; index++){
+           new_group->partners[index] = (comm_size + my_rank - (new_group->rank_separation * (my_set_pos-index)))%comm_size;
+         }
       }
 
-      //Build a comm to use for all of the set's reductions we'll need to do for RAID 5.
+      //Build a comm to use for all of the set's reductions we'll need to do for RAID 5/6.
       MPI_Group comm_group, set_group;
       MPI_Comm_group(comm, &comm_group);
       MPI_Group_incl(comm_group, new_group->set_size, new_group->partners, &set_group);
       MPI_Comm_create_group(comm, set_group, 0, &(new_group->set_comm));
 
+      if(new_group->raid_mode == 6){
+         __fenix_gf256_init();
+      }
+
    }
 
    new_group->entries_size = __FENIX_IMR_DEFAULT_MENTRY_NUM;
    new_group->entries_count = 0;
+   new_group->layout_version = 0;
    new_group->entries = 
       (fenix_imr_mentry_t*) malloc(sizeof(fenix_imr_mentry_t) * __FENIX_IMR_DEFAULT_MENTRY_NUM);
    new_group->num_snapshots = 0;
-
+   new_group->requests = NULL;
+   new_group->arena = __fenix_arena_create(fenix.data_pages, fenix.data_placement);
+   new_group->spill_count = 0;
+   __imr_rma_open(new_group, comm);
 
    *flag = FENIX_SUCCESS;
 }
 
+//A rank's place in __imr_node_order.
+typedef struct __fenix_imr_place{
+   int node_rank;
+   int node_index;
+   int rank;
+} fenix_imr_place_t;
+
+int __imr_place_comparator(const void* p, const void* q){
+   const fenix_imr_place_t* a = (const fenix_imr_place_t*)p;
+   const fenix_imr_place_t* b = (const fenix_imr_place_t*)q;
+   if(a->node_rank != b->node_rank) return a->node_rank < b->node_rank ? -1 : 1;
+   if(a->node_index != b->node_index) return a->node_index < b->node_index ? -1 : 1;
+   return a->rank < b->rank ? -1 : (a->rank > b->rank);
+}
+
+//Orders the ranks of comm by their rank within their node, then by node, with
+//nodes sorted by hostname. Runs of this order go across neighbouring nodes,
+//which are taken to be close in the network. nodes gets the node of each
+//position in the order. Returns the number of nodes.
+int __imr_node_order(MPI_Comm comm, int* order, int* nodes){
+   int my_rank, comm_size, node_rank;
+   MPI_Comm_rank(comm, &my_rank);
+   MPI_Comm_size(comm, &comm_size);
+
+   MPI_Comm node_comm, leader_comm;
+   MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, my_rank, MPI_INFO_NULL, &node_comm);
+   MPI_Comm_rank(node_comm, &node_rank);
+   MPI_Comm_split(comm, node_rank == 0 ? 0 : MPI_UNDEFINED, my_rank, &leader_comm);
+
+   //Node leaders sort their hostnames to number the nodes, names that tie
+   //(several shared memory domains to a host) go by leader rank.
+   int node_index = 0;
+   if(node_rank == 0){
+      int num_leaders, leader_rank, length;
+      MPI_Comm_size(leader_comm, &num_leaders);
+      MPI_Comm_rank(leader_comm, &leader_rank);
+
+      char name[MPI_MAX_PROCESSOR_NAME];
+      memset(name, 0, MPI_MAX_PROCESSOR_NAME);
+      MPI_Get_processor_name(name, &length);
+      char* names = (char*) s_malloc((size_t)num_leaders * MPI_MAX_PROCESSOR_NAME);
+      MPI_Allgather(name, MPI_MAX_PROCESSOR_NAME, MPI_CHAR, names, MPI_MAX_PROCESSOR_NAME,
+            MPI_CHAR, leader_comm);
+      for(int leader = 0; leader < num_leaders; leader++){
+         int cmp = strcmp(names + (size_t)leader*MPI_MAX_PROCESSOR_NAME, name);
+         if(cmp < 0 || (cmp == 0 && leader < leader_rank)) node_index++;
+      }
+      free(names);
+      MPI_Comm_free(&leader_comm);
+   }
+   MPI_Bcast(&node_index, 1, MPI_INT, 0, node_comm);
+   MPI_Comm_free(&node_comm);
+
+   int place[2] = {node_rank, node_index};
+   int* places = (int*) s_malloc(2 * comm_size * sizeof(int));
+   MPI_Allgather(place, 2, MPI_INT, places, 2, MPI_INT, comm);
+
+   fenix_imr_place_t* sorted = (fenix_imr_place_t*) s_malloc(comm_size * sizeof(fenix_imr_place_t));
+   int num_nodes = 0;
+   for(int rank = 0; rank < comm_size; rank++){
+      sorted[rank].node_rank = places[2*rank];
+      sorted[rank].node_index = places[2*rank+1];
+      sorted[rank].rank = rank;
+      if(places[2*rank+1] >= num_nodes) num_nodes = places[2*rank+1] + 1;
+   }
+   qsort(sorted, comm_size, sizeof(fenix_imr_place_t), __imr_place_comparator);
+   for(int position = 0; position < comm_size; position++){
+      order[position] = sorted[position].rank;
+      nodes[position] = sorted[position].node_index;
+   }
+   free(sorted);
+   free(places);
+   return num_nodes;
+}
+
+//How many RAID 1 pairs, or RAID 5/6 sets, of the order share a node.
+int __imr_shared_sets(fenix_imr_group_t* group, int* nodes, int comm_size){
+   int shared = 0;
+   if(group->raid_mode == 1){
+      for(int position = 0; position < comm_size; position++){
+         if(nodes[position] == nodes[(position + 1)%comm_size]) shared++;
+      }
+      return shared;
+   }
+
+   for(int first = 0; first < comm_size; first += group->set_size){
+      int sharing = 0;
+      for(int index = 1; index < group->set_size && !sharing; index++){
+         for(int other = 0; other < index && !sharing; other++){
+            sharing = nodes[(first + index)%comm_size] == nodes[(first + other)%comm_size];
+         }
+      }
+      shared += sharing;
+   }
+   return shared;
+}
+
+//Partners for FENIX_DATA_RANK_SEPARATION_AUTO, from scratch. In the order of
+//__imr_node_order, RAID 1 partners are the ranks right before and after me,
+//and RAID 5/6 sets are consecutive runs of set_size ranks. Either way they're
+//on neighbouring nodes, as long as there are enough nodes to go around.
+void __imr_auto_partners(fenix_imr_group_t* group, MPI_Comm comm){
+   int my_rank, comm_size;
+   MPI_Comm_rank(comm, &my_rank);
+   MPI_Comm_size(comm, &comm_size);
+
+   int* order = (int*) s_malloc(comm_size * sizeof(int));
+   int* nodes = (int*) s_malloc(comm_size * sizeof(int));
+   int num_nodes = __imr_node_order(comm, order, nodes);
+
+   int set_size = group->raid_mode == 1 ? 2 : group->set_size;
+   if(num_nodes < set_size && my_rank == 0){
+      debug_print("WARNING Fenix_Data_group_create: %d node(s) can't keep sets of %d ranks in separate failure domains\n",
+            num_nodes, set_size);
+   } else if(my_rank == 0){
+      //Enough nodes, but ones with more ranks than the rest run out of
+      //others to spread over.
+      int shared = __imr_shared_sets(group, nodes, comm_size);
+      if(shared > 0){
+         debug_print("WARNING Fenix_Data_group_create: nodes with uneven rank counts leave %d set(s) with ranks sharing a node\n",
+               shared);
+      }
+   }
+
+   int position = 0;
+   while(order[position] != my_rank) position++;
+
+   if(group->raid_mode == 1){
+      group->partners[0] = order[(comm_size + position - 1)%comm_size];
+      group->partners[1] = order[(position + 1)%comm_size];
+   } else {
+      //Comm size has to be a multiple of set size, as with a fixed separation.
+      int first = position - position%set_size;
+      for(int index = 0; index < set_size; index++){
+         group->partners[index] = order[(first + index)%comm_size];
+      }
+   }
+   free(nodes);
+   free(order);
+}
+
+//Partners for FENIX_DATA_RANK_SEPARATION_AUTO. Ranks that already have them
+//(known) keep them. A rank that replaced a failed one takes over its
+//partners, pieced together from everyone else's. Only if nobody has any are
+//they picked by topology, see __imr_auto_partners. Collective over comm.
+void __imr_place_partners(fenix_imr_group_t* group, MPI_Comm comm, int known){
+   int my_rank, comm_size;
+   MPI_Comm_rank(comm, &my_rank);
+   MPI_Comm_size(comm, &comm_size);
+
+   int num_partners = group->raid_mode == 1 ? 2 : group->set_size;
+   if(!known){
+      for(int index = 0; index < num_partners; index++) group->partners[index] = -1;
+   }
+
+   int* all = (int*) s_malloc(comm_size * num_partners * sizeof(int));
+   MPI_Allgather(group->partners, num_partners, MPI_INT, all, num_partners, MPI_INT, comm);
+
+   int any_known = 0;
+   for(int rank = 0; rank < comm_size; rank++){
+      if(all[rank*num_partners] != -1) any_known = 1;
+   }
+
+   if(!any_known){
+      __imr_auto_partners(group, comm);
+   } else if(!known){
+      //Every rank pieces together the same partners for everyone, from the
+      //ranks that know theirs.
+      int* filled = (int*) s_malloc(comm_size * num_partners * sizeof(int));
+      memcpy(filled, all, comm_size * num_partners * sizeof(int));
+      for(int rank = 0; rank < comm_size; rank++){
+         int* theirs = all + rank*num_partners;
+         if(theirs[0] == -1) continue;
+         if(group->raid_mode == 1){
+            //Whoever I back up stores my data on me, and the other way around.
+            filled[theirs[1]*2] = rank;
+            filled[theirs[0]*2 + 1] = rank;
+         } else {
+            for(int index = 0; index < num_partners; index++){
+               memcpy(filled + theirs[index]*num_partners, theirs, num_partners * sizeof(int));
+            }
+         }
+      }
+
+      //Whatever is still missing lost its redundancy data along with every
+      //rank that knew it, the leftover ranks pair up (or form sets) in order.
+      if(group->raid_mode == 1){
+         int* targeted = (int*) s_calloc(comm_size, sizeof(int));
+         for(int rank = 0; rank < comm_size; rank++){
+            if(filled[rank*2 + 1] != -1) targeted[filled[rank*2 + 1]] = 1;
+         }
+         int target = 0;
+         for(int rank = 0; rank < comm_size; rank++){
+            if(filled[rank*2 + 1] != -1) continue;
+            while(targeted[target]) target++;
+            targeted[target] = 1;
+            filled[rank*2 + 1] = target;
+            filled[target*2] = rank;
+         }
+         free(targeted);
+      } else {
+         int* set = group->partners;
+         int set_count = 0;
+         for(int rank = 0; rank < comm_size; rank++){
+            if(filled[rank*num_partners] != -1) continue;
+            set[set_count++] = rank;
+            if(set_count == num_partners){
+               for(int index = 0; index < num_partners; index++){
+                  memcpy(filled + set[index]*num_partners, set, num_partners * sizeof(int));
+               }
+               set_count = 0;
+            }
+         }
+      }
+
+      memcpy(group->partners, filled + my_rank*num_partners, num_partners * sizeof(int));
+      free(filled);
+   }
+   free(all);
+}
+
+//Slot of the ring holding the given snapshot, counting from the oldest.
+int __imr_slot(fenix_imr_group_t* group, fenix_imr_mentry_t* mentry, int snapshot){
+   return (mentry->oldest + snapshot) % (group->base.depth + 2);
+}
+
+//Rotates the ring so that slots line up with snapshot positions again.
+//Recovery ships whole arrays of snapshots around, so it works on this layout.
+void __imr_unwrap_ring(fenix_imr_group_t* group, fenix_imr_mentry_t* mentry){
+   int num_slots = group->base.depth + 2;
+   if(mentry->oldest == 0) return;
+
+   void** data = (void**) s_malloc(num_slots * sizeof(void*));
+   void*** chunks = (void***) s_malloc(num_slots * sizeof(void**));
+   Fenix_Data_subset* data_regions = (Fenix_Data_subset*) s_malloc(num_slots * sizeof(Fenix_Data_subset));
+   int* timestamp = (int*) s_malloc(num_slots * sizeof(int));
+   int* parity_full = (int*) s_malloc(num_slots * sizeof(int));
+   int* partner_size = (int*) s_malloc(num_slots * sizeof(int));
+   int* spilled = (int*) s_malloc(num_slots * sizeof(int));
+   for(int snapshot = 0; snapshot < num_slots; snapshot++){
+      int slot = __imr_slot(group, mentry, snapshot);
+      data[snapshot] = mentry->data[slot];
+      chunks[snapshot] = mentry->chunks[slot];
+      data_regions[snapshot] = mentry->data_regions[slot];
+      timestamp[snapshot] = mentry->timestamp[slot];
+      parity_full[snapshot] = mentry->parity_full[slot];
+      partner_size[snapshot] = mentry->partner_size[slot];
+      spilled[snapshot] = mentry->spilled[slot];
+   }
+   memcpy(mentry->data, data, num_slots * sizeof(void*));
+   memcpy(mentry->chunks, chunks, num_slots * sizeof(void**));
+   memcpy(mentry->data_regions, data_regions, num_slots * sizeof(Fenix_Data_subset));
+   memcpy(mentry->timestamp, timestamp, num_slots * sizeof(int));
+   memcpy(mentry->parity_full, parity_full, num_slots * sizeof(int));
+   memcpy(mentry->partner_size, partner_size, num_slots * sizeof(int));
+   memcpy(mentry->spilled, spilled, num_slots * sizeof(int));
+   free(data);
+   free(chunks);
+   free(data_regions);
+   free(timestamp);
+   free(parity_full);
+   free(partner_size);
+   free(spilled);
+
+   mentry->oldest = 0;
+}
+
+int __imr_num_chunks(fenix_imr_mentry_t* mentry){
+   return (mentry->region_size + __IMR_SNAPSHOT_CHUNK_SIZE - 1)/__IMR_SNAPSHOT_CHUNK_SIZE;
+}
+
+size_t __imr_chunk_length(fenix_imr_mentry_t* mentry, int chunk){
+   size_t offset = (size_t)chunk * __IMR_SNAPSHOT_CHUNK_SIZE;
+   size_t remaining = mentry->region_size - offset;
+   return remaining < __IMR_SNAPSHOT_CHUNK_SIZE ? remaining : __IMR_SNAPSHOT_CHUNK_SIZE;
+}
+
+void __imr_free_chunks(fenix_imr_group_t* group, fenix_imr_mentry_t* mentry, void*** chunks){
+   if(*chunks == NULL) return;
+   for(int chunk = 0; chunk < __imr_num_chunks(mentry); chunk++){
+      __fenix_arena_free(group->arena, (*chunks)[chunk]);
+   }
+   __fenix_arena_free(group->arena, *chunks);
+   *chunks = NULL;
+}
+
+//Keeps only the chunks of a whole snapshot which differ from the next newer
+//one, which must still be whole.
+void** __imr_diff_chunks(fenix_imr_group_t* group, fenix_imr_mentry_t* mentry, char* data, char* newer){
+   int num_chunks = __imr_num_chunks(mentry);
+   void** chunks = (void**) __fenix_arena_calloc(group->arena, num_chunks, sizeof(void*));
+   for(int chunk = 0; chunk < num_chunks; chunk++){
+      size_t offset = (size_t)chunk * __IMR_SNAPSHOT_CHUNK_SIZE;
+      size_t length = __imr_chunk_length(mentry, chunk);
+      if(memcmp(data + offset, newer + offset, length) != 0){
+         chunks[chunk] = __fenix_arena_alloc(group->arena, length);
+         memcpy(chunks[chunk], data + offset, length);
+      }
+   }
+   return chunks;
+}
+
+//Rebuilds an incremental snapshot into target, taking each chunk from the
+//first newer snapshot that has it.
+void __imr_materialize_snapshot(fenix_imr_group_t* group, fenix_imr_mentry_t* mentry,
+        int snapshot, char* target){
+   for(int chunk = 0; chunk < __imr_num_chunks(mentry); chunk++){
+      size_t offset = (size_t)chunk * __IMR_SNAPSHOT_CHUNK_SIZE;
+      char* source = NULL;
+      for(int newer = snapshot; source == NULL; newer++){
+         int slot = __imr_slot(group, mentry, newer);
+         if(mentry->data[slot] != NULL){
+            source = (char*)mentry->data[slot] + offset;
+         } else if(mentry->chunks[slot][chunk] != NULL){
+            source = mentry->chunks[slot][chunk];
+         }
+      }
+      memcpy(target + offset, source, __imr_chunk_length(mentry, chunk));
+   }
+}
+
+//Brings every snapshot back to a whole copy, which is what recovery and full
+//storage work on.
+void __imr_expand_snapshots(fenix_imr_group_t* group, fenix_imr_mentry_t* mentry){
+   //Newest first, so each rebuild can stop at the whole copy just made.
+   for(int snapshot = group->base.depth + 1; snapshot >= 0; snapshot--){
+      int slot = __imr_slot(group, mentry, snapshot);
+      if(mentry->data[slot] != NULL) continue;
+
+      void* data = __fenix_arena_alloc(group->arena, mentry->region_size);
+      if(mentry->chunks[slot] != NULL){
+         __imr_materialize_snapshot(group, mentry, snapshot, data);
+         __imr_free_chunks(group, mentry, mentry->chunks + slot);
+      }
+      mentry->data[slot] = data;
+   }
+}
+
+//Drops whole copies of everything but the newest snapshot and the staging
+//area, reusing one of the freed copies for the staging area if it needs it.
+void __imr_compact_snapshots(fenix_imr_group_t* group, fenix_imr_mentry_t* mentry){
+   void* spare = NULL;
+
+   //Oldest first, so the next newer snapshot is still whole when comparing.
+   for(int snapshot = 0; snapshot < mentry->current_head - 1; snapshot++){
+      int slot = __imr_slot(group, mentry, snapshot);
+      int newer = __imr_slot(group, mentry, snapshot + 1);
+      if(mentry->data[slot] == NULL || mentry->data[newer] == NULL) continue;
+
+      mentry->chunks[slot] = __imr_diff_chunks(group, mentry, mentry->data[slot], mentry->data[newer]);
+      if(mentry->spilled[slot]){
+         __imr_free_region(group, mentry, slot);
+      } else {
+         __fenix_arena_free(group->arena, spare);
+         spare = mentry->data[slot];
+         mentry->data[slot] = NULL;
+      }
+   }
+
+   for(int snapshot = mentry->current_head; snapshot < group->base.depth + 2; snapshot++){
+      int slot = __imr_slot(group, mentry, snapshot);
+      __imr_free_chunks(group, mentry, mentry->chunks + slot);
+      if(snapshot != mentry->current_head){
+         __imr_free_region(group, mentry, slot);
+      } else if(mentry->data[slot] == NULL){
+         mentry->data[slot] = spare != NULL ? spare : __fenix_arena_alloc(group->arena, mentry->region_size);
+         spare = NULL;
+      }
+   }
+
+   __fenix_arena_free(group->arena, spare);
+}
+
+//Before a snapshot is removed, hands the next older snapshot whatever it was
+//borrowing from it.
+void __imr_detach_snapshot(fenix_imr_group_t* group, fenix_imr_mentry_t* mentry, int snapshot){
+   int slot = __imr_slot(group, mentry, snapshot);
+   int older = __imr_slot(group, mentry, snapshot - 1);
+
+   if(snapshot > 0 && mentry->chunks[older] != NULL){
+      if(mentry->data[slot] != NULL){
+         //The older snapshot becomes the whole copy.
+         for(int chunk = 0; chunk < __imr_num_chunks(mentry); chunk++){
+            if(mentry->chunks[older][chunk] == NULL) continue;
+            memcpy((char*)mentry->data[slot] + (size_t)chunk * __IMR_SNAPSHOT_CHUNK_SIZE,
+                  mentry->chunks[older][chunk], __imr_chunk_length(mentry, chunk));
+         }
+         __imr_free_chunks(group, mentry, mentry->chunks + older);
+         mentry->data[older] = mentry->data[slot];
+         mentry->spilled[older] = mentry->spilled[slot];
+         mentry->data[slot] = NULL;
+         mentry->spilled[slot] = 0;
+      } else {
+         for(int chunk = 0; chunk < __imr_num_chunks(mentry); chunk++){
+            if(mentry->chunks[older][chunk] != NULL) continue;
+            mentry->chunks[older][chunk] = mentry->chunks[slot][chunk];
+            mentry->chunks[slot][chunk] = NULL;
+         }
+      }
+   }
+
+   __imr_free_chunks(group, mentry, mentry->chunks + slot);
+}
+
+//Gives back a slot's snapshot region, wherever it lives, and empties the slot.
+void __imr_free_region(fenix_imr_group_t* group, fenix_imr_mentry_t* mentry, int slot){
+   if(mentry->spilled[slot]){
+      munmap(mentry->data[slot], mentry->region_size);
+      mentry->spilled[slot] = 0;
+   } else {
+      __fenix_arena_free(group->arena, mentry->data[slot]);
+   }
+   mentry->data[slot] = NULL;
+}
+
+//Writes a region out to the spill directory and maps it back from there, so
+//that its pages are only brought into memory when something reads them.
+//The file is unlinked right away and goes with the mapping. Returns the new
+//region, or the old one if it couldn't be spilled.
+void* __imr_spill_region(fenix_imr_group_t* group, void* region, size_t size){
+   char path[4096];
+   snprintf(path, sizeof(path), "%s/fenix_imr_%d_%d_%d", fenix.data_spill_dir, (int)getpid(),
+         group->base.groupid, group->spill_count++);
+
+   int fd = open(path, O_RDWR | O_CREAT | O_EXCL, 0600);
+   if(fd < 0){
+      debug_print("ERROR Fenix_Data_commit: could not create spill file <%s>\n", path);
+      return region;
+   }
+   unlink(path);
+
+   void* mapping = MAP_FAILED;
+   size_t written = 0;
+   while(written < size){
+      ssize_t result = pwrite(fd, (char*)region + written, size - written, written);
+      if(result <= 0) break;
+      written += result;
+   }
+   if(written == size){
+      mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+   }
+   close(fd);
+
+   if(mapping == MAP_FAILED){
+      debug_print("ERROR Fenix_Data_commit: could not spill %lu bytes to <%s>\n",
+            (unsigned long) size, fenix.data_spill_dir);
+      return region;
+   }
+
+   __fenix_arena_free(group->arena, region);
+   return mapping;
+}
+
+//Stores write the staging area constantly, keep it in memory.
+void __imr_unspill_staging(fenix_imr_group_t* group, fenix_imr_mentry_t* mentry){
+   int head = __imr_slot(group, mentry, mentry->current_head);
+   if(mentry->spilled[head]){
+      //Whatever was there is dead, nothing to bring back.
+      __imr_free_region(group, mentry, head);
+      mentry->data[head] = __fenix_arena_alloc(group->arena, mentry->region_size);
+   }
+}
+
+//Spills the oldest snapshots, across all members, until the group's resident
+//snapshot regions fit in the memory budget. The staging area and the newest
+//snapshot, which stores read from, always stay. Incremental snapshots are
+//already down to the chunks they changed, and aren't counted.
+void __imr_enforce_budget(fenix_imr_group_t* group){
+   if(fenix.data_spill_dir == NULL || fenix.data_memory_budget == 0) return;
+
+   size_t resident = 0;
+   for(int eid = 0; eid < group->entries_count; eid++){
+      fenix_imr_mentry_t* mentry = group->entries + eid;
+      for(int slot = 0; slot < group->base.depth + 2; slot++){
+         if(mentry->data[slot] != NULL && !mentry->spilled[slot]){
+            resident += mentry->region_size;
+         }
+      }
+   }
+
+   for(int snapshot = 0; resident > fenix.data_memory_budget && snapshot < group->base.depth; snapshot++){
+      for(int eid = 0; eid < group->entries_count && resident > fenix.data_memory_budget; eid++){
+         fenix_imr_mentry_t* mentry = group->entries + eid;
+         if(snapshot >= mentry->current_head - 1) continue;
+
+         int slot = __imr_slot(group, mentry, snapshot);
+         if(mentry->data[slot] == NULL || mentry->spilled[slot]) continue;
+
+         void* spilled = __imr_spill_region(group, mentry->data[slot], mentry->region_size);
+         if(spilled == mentry->data[slot]) return;
+         mentry->data[slot] = spilled;
+         mentry->spilled[slot] = 1;
+         resident -= mentry->region_size;
+      }
+   }
+}
+
+//Exposes one of the arena's mappings in the group's window.
+void __imr_rma_attach(void* base, size_t size, void* arg){
+   fenix_imr_group_t* group = (fenix_imr_group_t*)arg;
+   if(MPI_Win_attach(group->window, base, (MPI_Aint)size) != MPI_SUCCESS){
+      //Slots in here are sent to the partner instead.
+      debug_print("ERROR Fenix_Data_member_store: could not expose %lu bytes for RMA\n",
+            (unsigned long) size);
+      return;
+   }
+   group->attached_bases = (void**) s_realloc(group->attached_bases,
+         (group->num_attached + 1) * sizeof(void*));
+   group->attached_sizes = (size_t*) s_realloc(group->attached_sizes,
+         (group->num_attached + 1) * sizeof(size_t));
+   group->attached_bases[group->num_attached] = base;
+   group->attached_sizes[group->num_attached] = size;
+   group->num_attached++;
+}
+
+//Opens the window RAID 1 stores put into, if the RMA transport is asked for.
+//Collective over comm. Spilled snapshots are files mapped outside the arena,
+//so a group with a spill budget keeps to messages.
+void __imr_rma_open(fenix_imr_group_t* group, MPI_Comm comm){
+   group->window = MPI_WIN_NULL;
+   group->num_attached = 0;
+   group->attached_bases = NULL;
+   group->attached_sizes = NULL;
+   group->rma_permit = MPI_REQUEST_NULL;
+   group->rma_notice = MPI_REQUEST_NULL;
+   if(group->raid_mode != 1 || fenix.data_transport != __FENIX_IMR_TRANSPORT_RMA) return;
+   if(fenix.data_spill_dir != NULL && fenix.data_memory_budget != 0) return;
+
+   MPI_Win_create_dynamic(MPI_INFO_NULL, comm, &(group->window));
+   //A put to a failed partner shouldn't abort, the group's next collective
+   //reports the failure.
+   MPI_Win_set_errhandler(group->window, MPI_ERRORS_RETURN);
+   MPI_Win_lock_all(MPI_MODE_NOCHECK, group->window);
+   __fenix_arena_watch(group->arena, __imr_rma_attach, group);
+}
+
+//Collective over the group's comm.
+void __imr_rma_close(fenix_imr_group_t* group){
+   if(group->window == MPI_WIN_NULL) return;
+
+   __fenix_arena_watch(group->arena, NULL, NULL);
+   //Partners traded these at the last commit, they're already on their way.
+   MPI_Wait(&(group->rma_permit), MPI_STATUS_IGNORE);
+   MPI_Wait(&(group->rma_notice), MPI_STATUS_IGNORE);
+   MPI_Win_unlock_all(group->window);
+   for(int i = 0; i < group->num_attached; i++){
+      MPI_Win_detach(group->window, group->attached_bases[i]);
+   }
+   MPI_Win_free(&(group->window));
+   free(group->attached_bases);
+   free(group->attached_sizes);
+   group->num_attached = 0;
+   group->attached_bases = NULL;
+   group->attached_sizes = NULL;
+}
+
+int __imr_rma_attached(fenix_imr_group_t* group, void* region, size_t size){
+   for(int i = 0; i < group->num_attached; i++){
+      char* base = (char*)group->attached_bases[i];
+      if((char*)region >= base && (char*)region + size <= base + group->attached_sizes[i]){
+         return 1;
+      }
+   }
+   return 0;
+}
+
+//Whether a plain RAID 1 store of the member goes over RMA. Hashed and
+//compressed stores send something other than the partner half as it sits,
+//and incremental storage moves regions around at every commit.
+int __imr_rma_eligible(fenix_imr_group_t* group, fenix_imr_mentry_t* mentry){
+   return group->window != MPI_WIN_NULL && !mentry->content_hash
+      && mentry->compression == FENIX_DATA_COMPRESSION_NONE
+      && mentry->snapshot_storage == FENIX_DATA_SNAPSHOT_STORAGE_FULL;
+}
+
+//Tells partners[0] where to put its copy of each slot, and learns where mine
+//go on partners[1]. Whatever moved the regions happened on both partners, so
+//they get here in the same store.
+void __imr_rma_exchange(fenix_imr_group_t* group, fenix_imr_mentry_t* mentry,
+        size_t local_data_size){
+   int num_slots = group->base.depth + 2;
+   MPI_Aint* exposed = (MPI_Aint*) s_malloc(num_slots * sizeof(MPI_Aint));
+   for(int slot = 0; slot < num_slots; slot++){
+      void* partner_half = (char*)mentry->data[slot] + local_data_size;
+      mentry->rma_exposed[slot] = __imr_rma_attached(group, partner_half, local_data_size);
+      exposed[slot] = 0;
+      if(mentry->rma_exposed[slot]) MPI_Get_address(partner_half, exposed + slot);
+   }
+
+   MPI_Sendrecv(exposed, num_slots, MPI_AINT, group->partners[0],
+         group->base.groupid ^ __IMR_RMA_ADDRESS_TAG, mentry->rma_targets, num_slots, MPI_AINT,
+         group->partners[1], group->base.groupid ^ __IMR_RMA_ADDRESS_TAG, group->base.comm,
+         MPI_STATUS_IGNORE);
+   free(exposed);
+   mentry->rma_ready = 1;
+}
+
+//Puts only reach the partner's memory once flushed.
+void __imr_rma_flush(fenix_imr_group_t* group){
+   if(group->window == MPI_WIN_NULL) return;
+   MPI_Win_flush_all(group->window);
+   MPI_Win_sync(group->window);
+}
+
+//A snapshot has to be complete on both partners by the time it is committed,
+//each restores the other from it. My flush only completes my puts, so
+//partners[0] tells me once its puts into my copy are flushed too, and the
+//commit waits for that. Puts also go to partners[1]'s staging slot by my ring
+//index, which is only its staging slot once it has committed as well; before
+//that it may be its oldest snapshot. So once committed, I tell partners[0] it
+//may put into my new staging slot, and its next put waits to hear it.
+void __imr_rma_commit(fenix_imr_group_t* group){
+   if(group->window == MPI_WIN_NULL) return;
+   MPI_Win_flush_all(group->window);
+
+   MPI_Wait(&(group->rma_notice), MPI_STATUS_IGNORE);
+   MPI_Sendrecv(NULL, 0, MPI_BYTE, group->partners[1], group->base.groupid ^ __IMR_RMA_FLUSHED_TAG,
+         NULL, 0, MPI_BYTE, group->partners[0], group->base.groupid ^ __IMR_RMA_FLUSHED_TAG,
+         group->base.comm, MPI_STATUS_IGNORE);
+   MPI_Win_sync(group->window);
+
+   __imr_rma_await_permit(group);
+   MPI_Irecv(NULL, 0, MPI_BYTE, group->partners[1], group->base.groupid ^ __IMR_RMA_READY_TAG,
+         group->base.comm, &(group->rma_permit));
+   MPI_Isend(NULL, 0, MPI_BYTE, group->partners[0], group->base.groupid ^ __IMR_RMA_READY_TAG,
+         group->base.comm, &(group->rma_notice));
+}
+
+//Waits until partners[1] has committed as far as I have, see __imr_rma_commit.
+void __imr_rma_await_permit(fenix_imr_group_t* group){
+   if(group->rma_permit != MPI_REQUEST_NULL){
+      MPI_Wait(&(group->rma_permit), MPI_STATUS_IGNORE);
+   }
+}
+
 //Sets mentry to point to the right index for a given memberid
 //If there are no members, the mentry pointer will be invalid and __FENIX_IMR_NO_MEMBERS will be returned.
 //If the given memberid is not found, points to the closest and returns anything but FENIX_SUCCESS.
 int __imr_find_mentry(fenix_imr_group_t* group, int memberid, fenix_imr_mentry_t** mentry){
    //List is sorted by member id, do binary search.
    int retval = -1;
-   unsigned lower_bound = 0;
-   unsigned upper_bound = group->entries_count - 1;
+   int lower_bound = 0;
+   int upper_bound = group->entries_count - 1;
 
 
    if(group->entries_count == 0){
@@ -208,7 +1107,7 @@ int __imr_find_mentry(fenix_imr_group_t* group, int memberid, fenix_imr_mentry_t
    }
    
    while(lower_bound != upper_bound){
-      unsigned to_check = (lower_bound + upper_bound)>>1;
+      int to_check = (lower_bound + upper_bound)>>1;
 
       if(group->entries[to_check].memberid == memberid){
          lower_bound = upper_bound = to_check;
@@ -228,274 +1127,1798 @@ int __imr_find_mentry(fenix_imr_group_t* group, int memberid, fenix_imr_mentry_t
    return retval;
 }
 
-void __imr_alloc_data_region(void** region, int raid_mode, int local_data_size, int set_size){
+size_t __imr_data_region_size(int raid_mode, int local_data_size, int set_size){
    if(raid_mode == 1){
-      *region = (void*) malloc(2*local_data_size);
-   } else if(raid_mode == 5){
+      return 2*(size_t)local_data_size;
+   } else if(raid_mode == 6){
+      //set_size-2 chunks of data, one of P and one of Q.
+      return (size_t)set_size * __imr_raid6_chunk_size(local_data_size, set_size);
+   } else {
       //We need space for our own local data, as well as space for the parity data
       //We add two just in case the data size isn't evenly divisble by set_size-1
       //  3 is needed because making the parity one larger on some nodes requires 
       //  extra bits of "data" on the other nodes
-      *region = (void*) malloc(local_data_size + local_data_size/(set_size - 1) + 3);
+      return (size_t)local_data_size + local_data_size/(set_size - 1) + 3;
+   }
+}
+
+void __imr_alloc_data_region(fenix_imr_group_t* group, void** region, int local_data_size){
+   if(group->raid_mode == 1 || group->raid_mode == 5 || group->raid_mode == 6){
+      *region = __fenix_arena_alloc(group->arena,
+            __imr_data_region_size(group->raid_mode, local_data_size, group->set_size));
+   } else {
+      debug_print("Error: raid mode <%d> not supported\n", group->raid_mode);
+   }
+}
+
+int __imr_member_create(fenix_group_t* g, fenix_member_entry_t* mentry){
+   fenix_imr_group_t* group = (fenix_imr_group_t*)g;
+   int retval = -1;
+
+   fenix_imr_mentry_t* closest_imr_mentry;
+   int found_memberid = __imr_find_mentry(group, mentry->memberid, &closest_imr_mentry);
+
+   if(found_memberid == FENIX_SUCCESS){
+      debug_print("Error Fenix_Data_member_create: member_id <%d> already exists in this policy\n",
+            mentry->memberid);
    } else {
-      debug_print("Error: raid mode <%d> not supported\n", raid_mode);
+      //Entries stay sorted by member id, I belong right before or right
+      //after the closest member.
+      int index = 0;
+      if(found_memberid != __FENIX_IMR_NO_MEMBERS){
+         index = closest_imr_mentry - group->entries;
+         if(mentry->memberid > closest_imr_mentry->memberid) index++;
+      }
+
+      //Double check that we have room for the member.
+      if(group->entries_count >= group->entries_size){
+         group->entries = (fenix_imr_mentry_t*) s_realloc(group->entries,
+               group->entries_size * 2 * sizeof(fenix_imr_mentry_t));
+         group->entries_size *= 2;
+      }
+
+      fenix_imr_mentry_t* new_imr_mentry = group->entries + index;
+      memmove(new_imr_mentry + 1, new_imr_mentry,
+            (group->entries_count - index) * sizeof(fenix_imr_mentry_t));
+
+      //Now I've got the location to store this member,
+      //so I just need to actually fill in the data.
+      new_imr_mentry->oldest = 0;
+      new_imr_mentry->current_head = 0;
+      new_imr_mentry->memberid = mentry->memberid;
+      
+      int num_slots = group->base.depth + 2;
+      new_imr_mentry->data = (void**) __fenix_arena_alloc(group->arena, num_slots * sizeof(void*));
+      int local_data_size = mentry->datatype_size * mentry->current_count;
+      new_imr_mentry->data_regions = 
+         (Fenix_Data_subset *) __fenix_arena_alloc(group->arena, num_slots * sizeof(Fenix_Data_subset));
+      new_imr_mentry->timestamp = (int*) __fenix_arena_alloc(group->arena, num_slots * sizeof(int));
+      new_imr_mentry->parity_full = (int*) __fenix_arena_calloc(group->arena, num_slots, sizeof(int));
+      new_imr_mentry->update_mode = FENIX_DATA_PARITY_UPDATE_REDUCE;
+      new_imr_mentry->chunk_size = __IMR_DEFAULT_CHUNK_SIZE;
+      new_imr_mentry->snapshot_storage = FENIX_DATA_SNAPSHOT_STORAGE_FULL;
+      new_imr_mentry->chunks = (void***) __fenix_arena_calloc(group->arena, num_slots, sizeof(void**));
+      new_imr_mentry->region_size = __imr_data_region_size(group->raid_mode, local_data_size,
+            group->set_size);
+      new_imr_mentry->content_hash = 0;
+      new_imr_mentry->num_hashes = 0;
+      new_imr_mentry->hashes = NULL;
+      new_imr_mentry->staged_hashes = NULL;
+      new_imr_mentry->hashes_valid = 0;
+      new_imr_mentry->staged_hashed = 0;
+      new_imr_mentry->skipped_bytes = 0;
+      new_imr_mentry->compression = FENIX_DATA_COMPRESSION_NONE;
+      new_imr_mentry->partner_size = (int*) __fenix_arena_calloc(group->arena, num_slots, sizeof(int));
+      new_imr_mentry->spilled = (int*) __fenix_arena_calloc(group->arena, num_slots, sizeof(int));
+      new_imr_mentry->rma_ready = 0;
+      new_imr_mentry->rma_exposed = (int*) __fenix_arena_calloc(group->arena, num_slots, sizeof(int));
+      new_imr_mentry->rma_targets =
+         (MPI_Aint*) __fenix_arena_calloc(group->arena, num_slots, sizeof(MPI_Aint));
+      
+      for(int i = 0; i < group->base.depth + 2; i++){
+         __imr_alloc_data_region(group, new_imr_mentry->data + i, local_data_size);
+
+         //Initialize to smallest # blocks allowed.
+         __fenix_data_subset_init(1, new_imr_mentry->data_regions + i);
+         new_imr_mentry->data_regions[i].specifier = __FENIX_SUBSET_EMPTY;
+
+        //-1 is not a valid timestamp, use as an indicator that the data isn't valid.
+        new_imr_mentry->timestamp[i] = -1;
+      }
+      //The first commit's timestamp is the group's timestart.
+      new_imr_mentry->timestamp[0] = group->base.timestart;
+
+      group->entries_count++;
+      group->layout_version++;
+
+      retval = FENIX_SUCCESS;
    }
+
+   return retval;
+}
+
+void __imr_member_free(fenix_imr_group_t* group, fenix_imr_mentry_t* mentry){
+  //Start by clearing out the mentry's data pointers.
+  for(int i = 0; i < group->base.depth + 2; i++){
+     __fenix_data_subset_free(mentry->data_regions + i);
+     __imr_free_region(group, mentry, i);
+     __imr_free_chunks(group, mentry, mentry->chunks + i);
+  }
+
+  __fenix_arena_free(group->arena, mentry->data);
+  __fenix_arena_free(group->arena, mentry->chunks);
+  free(mentry->hashes);
+  free(mentry->staged_hashes);
+  __fenix_arena_free(group->arena, mentry->data_regions);
+  __fenix_arena_free(group->arena, mentry->timestamp);
+  __fenix_arena_free(group->arena, mentry->parity_full);
+  __fenix_arena_free(group->arena, mentry->partner_size);
+  __fenix_arena_free(group->arena, mentry->spilled);
+  __fenix_arena_free(group->arena, mentry->rma_exposed);
+  __fenix_arena_free(group->arena, mentry->rma_targets);
+}
+
+int __imr_member_delete(fenix_group_t* g, int member_id){
+   int retval = -1;
+   fenix_imr_group_t* group = (fenix_imr_group_t*)g;
+   //Find the member first
+   fenix_imr_mentry_t *mentry;
+   int found_member = __imr_find_mentry(group, member_id, &mentry);
+   
+   if(found_member != FENIX_SUCCESS){
+      debug_print("ERROR Fenix_Data_member_delete: member_id <%d> does not exist!\n",
+                member_id);
+      retval = FENIX_ERROR_INVALID_MEMBERID;
+   } else {
+      __imr_complete_pending(group);
+      
+      //Free all of the pointers in the mentry
+      __imr_member_free(group, mentry);
+
+      //Now shift all the subsequent mentries back one, unless I'm already the last one.
+      int member_index = mentry - group->entries;
+      if(member_index != (group->entries_count-1) ){
+         memmove(mentry, mentry+1, sizeof(fenix_imr_mentry_t) * (group->entries_count - 1 - member_index));
+      }
+
+      group->entries_count--;
+      group->layout_version++;
+      retval = FENIX_SUCCESS;
+   }
+   return retval;
+}
+
+
+
+int __imr_member_store(fenix_group_t* g, int member_id, 
+        Fenix_Data_subset subset_specifier){
+   fenix_imr_group_t* group = (fenix_imr_group_t*)g;
+
+   //Any istores still in flight have to land before we overwrite the staging area.
+   __imr_complete_pending(group);
+
+   //Same path as istore, so every parity stripe's reduction is in flight at
+   //once rather than going one root at a time.
+   Fenix_Request request;
+   int retval = __imr_member_istore_common(g, member_id, subset_specifier, &request, 0);
+   if(retval == FENIX_SUCCESS){
+      retval = __imr_request_wait(g, request.data_request);
+   }
+   return retval;
+}
+
+
+
+
+
+//RAID 5 splits the parity of a member across the set, every set rank holds
+//parity_size bytes with the first remainder ranks holding one extra byte.
+void __imr_raid5_stripe(fenix_imr_group_t* group, int data_size, int* parity_size,
+        int* remainder){
+   *parity_size = data_size/(group->set_size - 1);
+   *remainder = data_size%(group->set_size - 1);
+   if(*remainder != 0) (*remainder)++;
+}
+
+//Offset of the local data a set rank contributes to its own parity reduction,
+//which has to be XOR'd back out of the result. See __imr_member_store.
+int __imr_raid5_noise_offset(fenix_imr_group_t* group, int my_set_rank,
+        int parity_size, int remainder){
+   if(my_set_rank == group->set_size - 1) return 0;
+   return my_set_rank * parity_size + (my_set_rank < remainder ? my_set_rank : remainder);
+}
+
+int __imr_interval_compare(const void* a, const void* b){
+   const int* first = (const int*)a;
+   const int* second = (const int*)b;
+   return (first[0] > second[0]) - (first[0] < second[0]);
+}
+
+//Works out which parity bytes a subset store changes, and packs this rank's part
+//of each root's reduction.
+//Parity byte p on set rank i is the XOR of byte (chunk offset of i) + p from every
+//other set rank, so for each root we map the stored byte ranges of every other
+//rank onto parity positions. Every rank stores the same subset, so they all come
+//up with the same positions and reduction sizes without communicating.
+fenix_imr_parity_update_t* __imr_raid5_plan_update(fenix_imr_group_t* group,
+        fenix_member_entry_t* member_data, Fenix_Data_subset* subset, void* data_buf,
+        int my_set_rank){
+   int data_size = member_data->datatype_size * member_data->current_count;
+   int parity_size, remainder;
+   __imr_raid5_stripe(group, data_size, &parity_size, &remainder);
+
+   int *starts, *lengths;
+   int num_regions = __fenix_data_subset_get_regions(subset, member_data->current_count,
+         &starts, &lengths);
+   for(int region = 0; region < num_regions; region++){
+      starts[region] *= member_data->datatype_size;
+      lengths[region] *= member_data->datatype_size;
+   }
+
+   //chunk_offsets[j*set_size + i] is where rank j's contribution to root i starts.
+   int* chunk_offsets = (int*) s_malloc(group->set_size * group->set_size * sizeof(int));
+   for(int j = 0; j < group->set_size; j++){
+      int offset = 0;
+      for(int i = 0; i < group->set_size; i++){
+         chunk_offsets[j*group->set_size + i] = offset;
+         if(i != j) offset += parity_size + (i < remainder ? 1 : 0);
+      }
+   }
+
+   fenix_imr_parity_update_t* update = (fenix_imr_parity_update_t*) s_malloc(sizeof(fenix_imr_parity_update_t));
+   update->num_intervals = (int*) s_calloc(group->set_size, sizeof(int));
+   update->intervals = (int**) s_calloc(group->set_size, sizeof(int*));
+   update->sizes = (int*) s_calloc(group->set_size, sizeof(int));
+   update->buffers = (void**) s_calloc(group->set_size, sizeof(void*));
+   update->chunk_offsets = (int*) s_malloc(group->set_size * sizeof(int));
+   for(int i = 0; i < group->set_size; i++){
+      update->chunk_offsets[i] = chunk_offsets[my_set_rank*group->set_size + i];
+   }
+
+   int* mapped = (int*) s_malloc(2 * (num_regions + 1) * group->set_size * sizeof(int));
+   for(int i = 0; i < group->set_size; i++){
+      int chunk_length = parity_size + (i < remainder ? 1 : 0);
+      int num_mapped = 0;
+
+      for(int j = 0; j < group->set_size; j++){
+         if(j == i) continue;
+         int chunk_start = chunk_offsets[j*group->set_size + i];
+         int chunk_end = chunk_start + chunk_length;
+
+         for(int region = 0; region < num_regions && starts[region] < chunk_end; region++){
+            int start = starts[region] > chunk_start ? starts[region] : chunk_start;
+            int end = starts[region] + lengths[region];
+            if(end > chunk_end) end = chunk_end;
+            if(start < end){
+               mapped[2*num_mapped] = start - chunk_start;
+               mapped[2*num_mapped + 1] = end - chunk_start;
+               num_mapped++;
+            }
+         }
+      }
+
+      //Union of the mapped ranges, as (parity position, length) pairs.
+      qsort(mapped, num_mapped, 2*sizeof(int), __imr_interval_compare);
+      int* intervals = (int*) s_malloc(2 * (num_mapped + 1) * sizeof(int));
+      int num_intervals = 0;
+      for(int m = 0; m < num_mapped; m++){
+         if(num_intervals > 0 && mapped[2*m] <= intervals[2*(num_intervals-1)] + intervals[2*(num_intervals-1)+1]){
+            int end = mapped[2*m+1];
+            int current_end = intervals[2*(num_intervals-1)] + intervals[2*(num_intervals-1)+1];
+            if(end > current_end) intervals[2*(num_intervals-1)+1] = end - intervals[2*(num_intervals-1)];
+         } else {
+            intervals[2*num_intervals] = mapped[2*m];
+            intervals[2*num_intervals+1] = mapped[2*m+1] - mapped[2*m];
+            num_intervals++;
+         }
+      }
+
+      int size = 0;
+      for(int interval = 0; interval < num_intervals; interval++){
+         size += intervals[2*interval+1];
+      }
+
+      update->num_intervals[i] = num_intervals;
+      update->intervals[i] = intervals;
+      update->sizes[i] = size;
+      if(size == 0) continue;
+
+      update->buffers[i] = __fenix_arena_alloc(group->arena, size);
+      if(i == my_set_rank){
+         //Reduced in place, so the root contributes nothing.
+         memset(update->buffers[i], 0, size);
+      } else {
+         char* packed = (char*)update->buffers[i];
+         int chunk_start = chunk_offsets[my_set_rank*group->set_size + i];
+         for(int interval = 0; interval < num_intervals; interval++){
+            memcpy(packed, (char*)data_buf + chunk_start + intervals[2*interval], intervals[2*interval+1]);
+            packed += intervals[2*interval+1];
+         }
+      }
+   }
+
+   free(mapped);
+   free(chunk_offsets);
+   free(starts);
+   free(lengths);
+   return update;
+}
+
+//Moves the reduced parity bytes for this rank into place.
+void __imr_raid5_apply_update(fenix_imr_parity_update_t* update, void* parity_buf, int my_set_rank){
+   char* packed = (char*)update->buffers[my_set_rank];
+   for(int interval = 0; interval < update->num_intervals[my_set_rank]; interval++){
+      memcpy((char*)parity_buf + update->intervals[my_set_rank][2*interval], packed,
+            update->intervals[my_set_rank][2*interval+1]);
+      packed += update->intervals[my_set_rank][2*interval+1];
+   }
+}
+
+void __imr_raid5_free_update(fenix_imr_group_t* group, fenix_imr_parity_update_t* update){
+   for(int i = 0; i < group->set_size; i++){
+      free(update->intervals[i]);
+      __fenix_arena_free(group->arena, update->buffers[i]);
+   }
+   free(update->num_intervals);
+   free(update->intervals);
+   free(update->sizes);
+   free(update->buffers);
+   free(update->chunk_offsets);
+   free(update);
+}
+
+//Whether a RAID 5 store to this member can go out as a parity delta. Deltas are
+//only correct if the staging snapshot's parity covers all of its data, so the
+//first store into a fresh snapshot carries data and parity forward from the
+//last one. Every rank in the set reaches the same answer.
+int __imr_raid5_prepare_delta(fenix_imr_group_t* group, fenix_imr_mentry_t* mentry,
+        fenix_member_entry_t* member_data){
+   if(group->raid_mode != 5 || mentry->update_mode != FENIX_DATA_PARITY_UPDATE_DELTA){
+      return 0;
+   }
+
+   int head = __imr_slot(group, mentry, mentry->current_head);
+   int previous = __imr_slot(group, mentry, mentry->current_head - 1);
+   if(mentry->data_regions[head].specifier == __FENIX_SUBSET_EMPTY && !mentry->parity_full[head]){
+      if(mentry->current_head == 0 || !mentry->parity_full[previous]){
+         //Nothing to build on, this store has to do a full reduction.
+         return 0;
+      }
+      memcpy(mentry->data[head], mentry->data[previous], __imr_data_region_size(group->raid_mode,
+            member_data->datatype_size * member_data->current_count, group->set_size));
+      mentry->parity_full[head] = 1;
+   }
+
+   return mentry->parity_full[head];
+}
+
+//XORs this rank's current bytes into its packed contributions, which turns
+//packed old data into the old^new delta.
+void __imr_raid5_xor_packed(fenix_imr_group_t* group, fenix_imr_parity_update_t* update,
+        void* data_buf, int my_set_rank){
+   for(int i = 0; i < group->set_size; i++){
+      if(i == my_set_rank || update->sizes[i] == 0) continue;
+
+      char* packed = (char*)update->buffers[i];
+      for(int interval = 0; interval < update->num_intervals[i]; interval++){
+         int length = update->intervals[i][2*interval+1];
+         __fenix_xor_region((char*)data_buf + update->chunk_offsets[i] + update->intervals[i][2*interval],
+               packed, length);
+         packed += length;
+      }
+   }
+}
+
+int __imr_delta_message_size(int size){
+   return (size + __IMR_DELTA_BLOCK_SIZE - 1)/__IMR_DELTA_BLOCK_SIZE + size;
+}
+
+//Leaves the all-zero blocks out of a packed delta. A message is one byte per
+//block saying whether it was sent, followed by the nonzero blocks.
+int __imr_delta_compact(void* packed, int size, void* message){
+   int num_blocks = (size + __IMR_DELTA_BLOCK_SIZE - 1)/__IMR_DELTA_BLOCK_SIZE;
+   char* mask = (char*)message;
+   char* out = mask + num_blocks;
+
+   for(int block = 0; block < num_blocks; block++){
+      char* in = (char*)packed + block*__IMR_DELTA_BLOCK_SIZE;
+      int length = size - block*__IMR_DELTA_BLOCK_SIZE;
+      if(length > __IMR_DELTA_BLOCK_SIZE) length = __IMR_DELTA_BLOCK_SIZE;
+
+      //All zero iff the first byte is zero and every byte equals the next.
+      mask[block] = !(in[0] == 0 && memcmp(in, in + 1, length - 1) == 0);
+      if(mask[block]){
+         memcpy(out, in, length);
+         out += length;
+      }
+   }
+
+   return out - (char*)message;
+}
+
+void __imr_delta_expand_xor(void* message, int size, void* packed){
+   int num_blocks = (size + __IMR_DELTA_BLOCK_SIZE - 1)/__IMR_DELTA_BLOCK_SIZE;
+   char* mask = (char*)message;
+   char* in = mask + num_blocks;
+
+   for(int block = 0; block < num_blocks; block++){
+      if(!mask[block]) continue;
+      int length = size - block*__IMR_DELTA_BLOCK_SIZE;
+      if(length > __IMR_DELTA_BLOCK_SIZE) length = __IMR_DELTA_BLOCK_SIZE;
+
+      __fenix_xor_region(in, (char*)packed + block*__IMR_DELTA_BLOCK_SIZE, length);
+      in += length;
+   }
+}
+
+//Read-modify-write RAID 5 update, like a small write to a RAID array. Instead of
+//reducing across the set, each rank sends old^new for the bytes it stored straight
+//to the ranks holding the matching parity, who XOR it in. Takes the local copy of
+//the user's data as well. requests must have room for 2*set_size requests.
+fenix_imr_delta_t* __imr_raid5_start_delta(fenix_imr_group_t* group, fenix_imr_mentry_t* mentry,
+        fenix_member_entry_t* member_data, Fenix_Data_subset* subset, int vectored,
+        MPI_Request* requests){
+   int my_set_rank;
+   MPI_Comm_rank(group->set_comm, &my_set_rank);
+   void* data_buf = mentry->data[__imr_slot(group, mentry, mentry->current_head)];
+
+   fenix_imr_delta_t* delta = (fenix_imr_delta_t*) s_malloc(sizeof(fenix_imr_delta_t));
+
+   //Pack the old bytes, bring in the new ones, and XOR to get the delta.
+   delta->update = __imr_raid5_plan_update(group, member_data, subset, data_buf, my_set_rank);
+   if(vectored){
+      __fenix_data_member_gather_buffers(member_data, subset, data_buf);
+   } else {
+      __fenix_data_subset_copy_data(subset, data_buf, member_data->user_data,
+            member_data->datatype_size, member_data->current_count);
+   }
+   __imr_raid5_xor_packed(group, delta->update, data_buf, my_set_rank);
+
+   delta->send_bufs = (void**) s_calloc(group->set_size, sizeof(void*));
+   delta->recv_bufs = (void**) s_calloc(group->set_size, sizeof(void*));
+
+   int tag = group->base.groupid ^ STORE_DELTA_TAG;
+   int my_size = delta->update->sizes[my_set_rank];
+   for(int i = 0; i < group->set_size; i++){
+      requests[2*i] = MPI_REQUEST_NULL;
+      requests[2*i+1] = MPI_REQUEST_NULL;
+      if(i == my_set_rank) continue;
+
+      if(my_size > 0){
+         delta->recv_bufs[i] = __fenix_arena_alloc(group->arena, __imr_delta_message_size(my_size));
+         MPI_Irecv(delta->recv_bufs[i], __imr_delta_message_size(my_size), MPI_BYTE, i, tag,
+               group->set_comm, requests + 2*i);
+      }
+
+      int size = delta->update->sizes[i];
+      if(size > 0){
+         delta->send_bufs[i] = __fenix_arena_alloc(group->arena, __imr_delta_message_size(size));
+         int message_size = __imr_delta_compact(delta->update->buffers[i], size, delta->send_bufs[i]);
+         MPI_Isend(delta->send_bufs[i], message_size, MPI_BYTE, i, tag, group->set_comm,
+               requests + 2*i + 1);
+      }
+   }
+
+   return delta;
+}
+
+//Once all of a delta update's messages are in, fold them into my parity.
+void __imr_raid5_finish_delta(fenix_imr_group_t* group, fenix_imr_delta_t* delta, void* parity_buf){
+   int my_set_rank;
+   MPI_Comm_rank(group->set_comm, &my_set_rank);
+
+   fenix_imr_parity_update_t* update = delta->update;
+   int my_size = update->sizes[my_set_rank];
+   if(my_size == 0) return;
+
+   //The plan zeroed my own packed buffer, so it can collect everyone's deltas.
+   char* accumulated = (char*)update->buffers[my_set_rank];
+   for(int i = 0; i < group->set_size; i++){
+      if(i == my_set_rank) continue;
+      __imr_delta_expand_xor(delta->recv_bufs[i], my_size, accumulated);
+   }
+
+   for(int interval = 0; interval < update->num_intervals[my_set_rank]; interval++){
+      int length = update->intervals[my_set_rank][2*interval+1];
+      __fenix_xor_region(accumulated, (char*)parity_buf + update->intervals[my_set_rank][2*interval],
+            length);
+      accumulated += length;
+   }
+}
+
+void __imr_raid5_free_delta(fenix_imr_group_t* group, fenix_imr_delta_t* delta){
+   for(int i = 0; i < group->set_size; i++){
+      __fenix_arena_free(group->arena, delta->send_bufs[i]);
+      __fenix_arena_free(group->arena, delta->recv_bufs[i]);
+   }
+   free(delta->send_bufs);
+   free(delta->recv_bufs);
+   __imr_raid5_free_update(group, delta->update);
+   free(delta);
+}
+
+//RAID 6 splits each member into set_size-2 equal chunks, padding out the last.
+//Stripe i has its P parity on set rank i and its Q parity on set rank i+1, and
+//every other set rank contributes one chunk to it. Q weights each chunk by the
+//generator raised to its contributor's set rank, so any two lost pieces of a
+//stripe can be solved for. A slot is [chunks][P][Q].
+int __imr_raid6_chunk_size(int local_data_size, int set_size){
+   return (local_data_size + set_size - 3)/(set_size - 2);
+}
+
+//Which of rank's chunks goes to stripe, or -1 if rank holds that stripe's parity.
+int __imr_raid6_chunk_index(int set_size, int rank, int stripe){
+   if(stripe == rank || stripe == (rank + set_size - 1)%set_size) return -1;
+
+   int index = 0;
+   for(int i = 0; i < stripe; i++){
+      if(i != rank && i != (rank + set_size - 1)%set_size) index++;
+   }
+   return index;
+}
+
+//Starts the P and Q reductions for every stripe of the staging snapshot.
+//requests needs room for 2*set_size requests. Returns a scratch buffer to free
+//once they have all finished.
+void* __imr_raid6_start_store(fenix_imr_group_t* group, fenix_imr_mentry_t* mentry,
+        fenix_member_entry_t* member_data, MPI_Request* requests){
+   int my_set_rank;
+   MPI_Comm_rank(group->set_comm, &my_set_rank);
+
+   int set_size = group->set_size;
+   int local_data_size = member_data->datatype_size * member_data->current_count;
+   int chunk_size = __imr_raid6_chunk_size(local_data_size, set_size);
+
+   char* data_buf = (char*)mentry->data[__imr_slot(group, mentry, mentry->current_head)];
+   char* p_buf = data_buf + (set_size-2)*chunk_size;
+   char* q_buf = p_buf + chunk_size;
+
+   //Padding takes part in the parity, so keep it deterministic.
+   memset(data_buf + local_data_size, 0, (set_size-2)*chunk_size - local_data_size);
+
+   //My Q contributions, followed by a chunk of zeros to send for the stripes
+   //whose parity I hold.
+   char* scratch = (char*) __fenix_arena_alloc(group->arena, (size_t)(set_size-1)*chunk_size);
+   char* zeros = scratch + (set_size-2)*chunk_size;
+   __fenix_gf256_mul_region(__fenix_gf256_exp(my_set_rank), data_buf, scratch, (set_size-2)*chunk_size);
+   memset(zeros, 0, chunk_size);
+
+   //Parity is reduced in place on its holder, which adds nothing to it.
+   memset(p_buf, 0, 2*chunk_size);
+
+   for(int stripe = 0; stripe < set_size; stripe++){
+      int chunk = __imr_raid6_chunk_index(set_size, my_set_rank, stripe);
+      int p_root = stripe, q_root = (stripe + 1)%set_size;
+
+      void* p_send = (my_set_rank == p_root) ? MPI_IN_PLACE : 
+            (chunk < 0 ? zeros : data_buf + chunk*chunk_size);
+      MPI_Ireduce(p_send, p_buf, chunk_size, MPI_BYTE, fenix.xor_op, p_root, group->set_comm,
+            requests + 2*stripe);
+
+      void* q_send = (my_set_rank == q_root) ? MPI_IN_PLACE : 
+            (chunk < 0 ? zeros : scratch + chunk*chunk_size);
+      MPI_Ireduce(q_send, q_buf, chunk_size, MPI_BYTE, fenix.xor_op, q_root, group->set_comm,
+            requests + 2*stripe + 1);
+   }
+
+   return scratch;
+}
+
+//Rebuilds one snapshot of a member on up to two lost set ranks. For each stripe,
+//the survivors sum up P^data and Q^weighted data on each lost rank, which is
+//enough for the lost ranks to solve for their missing chunk or parity.
+void __imr_raid6_rebuild(fenix_imr_group_t* group, void* snapshot_data, int local_data_size,
+        int* lost, int num_lost){
+   int my_set_rank;
+   MPI_Comm_rank(group->set_comm, &my_set_rank);
+
+   int set_size = group->set_size;
+   int chunk_size = __imr_raid6_chunk_size(local_data_size, set_size);
+   char* data_buf = (char*)snapshot_data;
+   char* p_buf = data_buf + (set_size-2)*chunk_size;
+   char* q_buf = p_buf + chunk_size;
+
+   int i_am_lost = 0, other_lost = -1;
+   for(int i = 0; i < num_lost; i++){
+      if(lost[i] == my_set_rank) i_am_lost = 1;
+      else other_lost = lost[i];
+   }
+
+   char* sums = (char*) __fenix_arena_alloc(group->arena, 2*(size_t)chunk_size);
+   char* result = (char*) __fenix_arena_alloc(group->arena, 2*(size_t)chunk_size);
+
+   for(int stripe = 0; stripe < set_size; stripe++){
+      int chunk = __imr_raid6_chunk_index(set_size, my_set_rank, stripe);
+      int p_root = stripe, q_root = (stripe + 1)%set_size;
+
+      memset(sums, 0, 2*chunk_size);
+      if(i_am_lost){
+         //Nothing to add.
+      } else if(my_set_rank == p_root){
+         memcpy(sums, p_buf, chunk_size);
+      } else if(my_set_rank == q_root){
+         memcpy(sums + chunk_size, q_buf, chunk_size);
+      } else {
+         memcpy(sums, data_buf + chunk*chunk_size, chunk_size);
+         __fenix_gf256_mul_region(__fenix_gf256_exp(my_set_rank), data_buf + chunk*chunk_size,
+               sums + chunk_size, chunk_size);
+      }
+
+      for(int i = 0; i < num_lost; i++){
+         MPI_Reduce(sums, result, 2*chunk_size, MPI_BYTE, fenix.xor_op, lost[i], group->set_comm);
+      }
+
+      if(!i_am_lost) continue;
+
+      //With survivors summed in, p_sum is the XOR of the lost chunks (plus P if it
+      //survived) and q_sum the same for their weighted values (plus Q).
+      char* p_sum = result;
+      char* q_sum = result + chunk_size;
+      int other_chunk = other_lost < 0 ? -1 : __imr_raid6_chunk_index(set_size, other_lost, stripe);
+
+      if(my_set_rank == p_root){
+         memcpy(p_buf, p_sum, chunk_size);
+         if(other_chunk >= 0){
+            //Q survived, so the other lost chunk is q_sum over its weight.
+            __fenix_gf256_mul_region_xor(__fenix_gf256_div(1, __fenix_gf256_exp(other_lost)), 
+                  q_sum, p_buf, chunk_size);
+         }
+      } else if(my_set_rank == q_root){
+         memcpy(q_buf, q_sum, chunk_size);
+         if(other_chunk >= 0){
+            //P survived, so the other lost chunk is p_sum.
+            __fenix_gf256_mul_region_xor(__fenix_gf256_exp(other_lost), p_sum, q_buf, chunk_size);
+         }
+      } else {
+         char* my_chunk = data_buf + chunk*chunk_size;
+         if(other_lost < 0 || other_lost == q_root){
+            memcpy(my_chunk, p_sum, chunk_size);
+         } else if(other_lost == p_root){
+            __fenix_gf256_mul_region(__fenix_gf256_div(1, __fenix_gf256_exp(my_set_rank)), 
+                  q_sum, my_chunk, chunk_size);
+         } else {
+            //Two lost chunks: p_sum = a^b and q_sum = ga*a ^ gb*b, 
+            //so a = (q_sum ^ gb*p_sum)/(ga ^ gb).
+            uint8_t my_weight = __fenix_gf256_exp(my_set_rank);
+            uint8_t other_weight = __fenix_gf256_exp(other_lost);
+            memcpy(my_chunk, q_sum, chunk_size);
+            __fenix_gf256_mul_region_xor(other_weight, p_sum, my_chunk, chunk_size);
+            __fenix_gf256_mul_region(__fenix_gf256_div(1, my_weight ^ other_weight), 
+                  my_chunk, my_chunk, chunk_size);
+         }
+      }
+   }
+
+   __fenix_arena_free(group->arena, sums);
+   __fenix_arena_free(group->arena, result);
+}
+
+size_t __imr_raid1_pipeline_chunk_length(fenix_imr_pipeline_t* pipe, int chunk){
+   if(chunk < pipe->num_chunks - 1) return pipe->chunk_size;
+   return pipe->total_size - (size_t)chunk * pipe->chunk_size;
+}
+
+//Posts the next chunk's send or receive into slot.
+void __imr_raid1_pipeline_post(fenix_imr_pipeline_t* pipe, int slot){
+   if(slot < 2){
+      int chunk = pipe->next_send++;
+      MPI_Isend(pipe->src + (size_t)chunk*pipe->chunk_size, __imr_raid1_pipeline_chunk_length(pipe, chunk),
+            MPI_BYTE, pipe->send_partner, pipe->tag, pipe->comm, pipe->requests + slot);
+   } else {
+      int chunk = pipe->next_recv++;
+      MPI_Irecv(pipe->dest + (size_t)chunk*pipe->chunk_size, __imr_raid1_pipeline_chunk_length(pipe, chunk),
+            MPI_BYTE, pipe->recv_partner, pipe->tag, pipe->comm, pipe->requests + slot);
+   }
+}
+
+//Returns NULL if the subset isn't a single contiguous region, those are
+//exchanged in place through the subset's datatype instead.
+fenix_imr_pipeline_t* __imr_raid1_start_pipeline(fenix_imr_group_t* group,
+        fenix_imr_mentry_t* mentry, fenix_member_entry_t* member_data, Fenix_Data_subset* subset){
+   int *starts, *lengths;
+   int num_regions = __fenix_data_subset_get_regions(subset, member_data->current_count,
+         &starts, &lengths);
+   if(num_regions > 1){
+      free(starts);
+      free(lengths);
+      return NULL;
+   }
+
+   fenix_imr_pipeline_t* pipe = (fenix_imr_pipeline_t*) s_calloc(1, sizeof(fenix_imr_pipeline_t));
+   size_t offset = num_regions == 1 ? (size_t)starts[0] * member_data->datatype_size : 0;
+   pipe->src = (char*)mentry->data[__imr_slot(group, mentry, mentry->current_head)] + offset;
+   pipe->dest = pipe->src + member_data->datatype_size*member_data->current_count;
+   pipe->total_size = num_regions == 1 ? (size_t)lengths[0] * member_data->datatype_size : 0;
+   pipe->chunk_size = mentry->chunk_size;
+   pipe->num_chunks = (pipe->total_size + pipe->chunk_size - 1) / pipe->chunk_size;
+   pipe->send_partner = group->partners[1];
+   pipe->recv_partner = group->partners[0];
+   pipe->tag = group->base.groupid ^ STORE_PAYLOAD_TAG;
+   pipe->comm = group->base.comm;
+   free(starts);
+   free(lengths);
+
+   for(int slot = 0; slot < 4; slot++){
+      pipe->requests[slot] = MPI_REQUEST_NULL;
+   }
+
+   //Receives first, so the partner's first chunks have somewhere to land.
+   for(int slot = 2; slot < 4 && pipe->next_recv < pipe->num_chunks; slot++){
+      __imr_raid1_pipeline_post(pipe, slot);
+   }
+   for(int slot = 0; slot < 2 && pipe->next_send < pipe->num_chunks; slot++){
+      __imr_raid1_pipeline_post(pipe, slot);
+   }
+
+   return pipe;
+}
+
+//Finishes chunks in order, refilling each slot as it frees up. Returns 1 once
+//everything has been exchanged, 0 if still in flight, or -1 on an MPI error.
+int __imr_raid1_pipeline_progress(fenix_imr_pipeline_t* pipe, int blocking){
+   int progress = 1;
+   while(progress && (pipe->received < pipe->num_chunks || pipe->sent < pipe->num_chunks)){
+      progress = 0;
+
+      //Receive slots are 2 and 3, send slots 0 and 1.
+      for(int sending = 0; sending < 2; sending++){
+         int* finished = sending ? &(pipe->sent) : &(pipe->received);
+         int* next = sending ? &(pipe->next_send) : &(pipe->next_recv);
+         if(*finished == pipe->num_chunks) continue;
+
+         int slot = (sending ? 0 : 2) + *finished%2;
+         int done = 1, result;
+         if(blocking){
+            result = MPI_Wait(pipe->requests + slot, MPI_STATUS_IGNORE);
+         } else {
+            result = MPI_Test(pipe->requests + slot, &done, MPI_STATUS_IGNORE);
+         }
+         if(result != MPI_SUCCESS) return -1;
+
+         if(done){
+            (*finished)++;
+            if(*next < pipe->num_chunks) __imr_raid1_pipeline_post(pipe, slot);
+            progress = 1;
+         }
+      }
+   }
+
+   return pipe->received == pipe->num_chunks && pipe->sent == pipe->num_chunks;
+}
+
+void __imr_raid1_free_pipeline(fenix_imr_pipeline_t* pipe){
+   free(pipe);
+}
+
+//Byte subset of the chunks flagged in changed, returns how many there are.
+int __imr_hash_changed_subset(unsigned char* changed, int num_chunks, size_t data_size,
+        Fenix_Data_subset* subset){
+   int num_changed = 0, num_runs = 0;
+   int* starts = (int*) s_malloc(num_chunks * sizeof(int));
+   int* ends = (int*) s_malloc(num_chunks * sizeof(int));
+   for(int chunk = 0; chunk < num_chunks; chunk++){
+      if(!changed[chunk]) continue;
+      num_changed++;
+      int start = chunk * __IMR_HASH_CHUNK_SIZE;
+      if(num_runs > 0 && ends[num_runs-1] == start - 1){
+         ends[num_runs-1] += __IMR_HASH_CHUNK_SIZE;
+      } else {
+         starts[num_runs] = start;
+         ends[num_runs] = start + __IMR_HASH_CHUNK_SIZE - 1;
+         num_runs++;
+      }
+   }
+   if(num_runs > 0){
+      if(ends[num_runs-1] >= data_size) ends[num_runs-1] = data_size - 1;
+      __fenix_data_subset_createv(num_runs, starts, ends, subset);
+   }
+   free(starts);
+   free(ends);
+   return num_changed;
+}
+
+//Full RAID 1 store which only sends chunks whose hash differs from the newest
+//snapshot's, the partner takes the others from its copy of that snapshot.
+//Partners first swap which chunks changed, then exchange those in place.
+void __imr_raid1_start_hashed(fenix_imr_group_t* group, fenix_imr_mentry_t* mentry,
+        fenix_member_entry_t* member_data, char* data_buf, MPI_Request* requests){
+   size_t data_size = (size_t)member_data->datatype_size * member_data->current_count;
+   int num_chunks = (data_size + __IMR_HASH_CHUNK_SIZE - 1)/__IMR_HASH_CHUNK_SIZE;
+   if(num_chunks != mentry->num_hashes){
+      mentry->hashes = (uint64_t*) s_realloc(mentry->hashes, num_chunks * sizeof(uint64_t));
+      mentry->staged_hashes = (uint64_t*) s_realloc(mentry->staged_hashes, num_chunks * sizeof(uint64_t));
+      mentry->num_hashes = num_chunks;
+      mentry->hashes_valid = 0;
+   }
+
+   unsigned char* changed = (unsigned char*) s_malloc(2*num_chunks);
+   unsigned char* partner_changed = changed + num_chunks;
+   size_t sent_bytes = 0;
+   for(int chunk = 0; chunk < num_chunks; chunk++){
+      size_t offset = (size_t)chunk * __IMR_HASH_CHUNK_SIZE;
+      size_t length = data_size - offset < __IMR_HASH_CHUNK_SIZE ? data_size - offset : __IMR_HASH_CHUNK_SIZE;
+      mentry->staged_hashes[chunk] = __fenix_hash64(data_buf + offset, length);
+      changed[chunk] = !mentry->hashes_valid || mentry->staged_hashes[chunk] != mentry->hashes[chunk];
+      if(changed[chunk]) sent_bytes += length;
+   }
+   mentry->skipped_bytes += data_size - sent_bytes;
+   mentry->staged_hashed = 1;
+
+   MPI_Sendrecv(changed, num_chunks, MPI_UNSIGNED_CHAR, group->partners[1], __IMR_HASH_BITMAP_TAG,
+         partner_changed, num_chunks, MPI_UNSIGNED_CHAR, group->partners[0], __IMR_HASH_BITMAP_TAG,
+         group->base.comm, MPI_STATUS_IGNORE);
+
+   //Unchanged chunks of the partner's data are already in our newest snapshot.
+   char* partner_buf = data_buf + data_size;
+   char* previous = (char*)mentry->data[__imr_slot(group, mentry, mentry->current_head - 1)] + data_size;
+   for(int chunk = 0; chunk < num_chunks; chunk++){
+      if(partner_changed[chunk]) continue;
+      size_t offset = (size_t)chunk * __IMR_HASH_CHUNK_SIZE;
+      size_t length = data_size - offset < __IMR_HASH_CHUNK_SIZE ? data_size - offset : __IMR_HASH_CHUNK_SIZE;
+      memcpy(partner_buf + offset, previous + offset, length);
+   }
+
+   requests[0] = requests[1] = MPI_REQUEST_NULL;
+   Fenix_Data_subset subset;
+   MPI_Datatype type;
+   if(__imr_hash_changed_subset(partner_changed, num_chunks, data_size, &subset) > 0){
+      __fenix_data_subset_get_type(&subset, 1, data_size, &type);
+      MPI_Irecv(partner_buf, 1, type, group->partners[0], group->base.groupid ^ STORE_PAYLOAD_TAG,
+            group->base.comm, requests);
+      __fenix_data_subset_free(&subset);
+   }
+   if(__imr_hash_changed_subset(changed, num_chunks, data_size, &subset) > 0){
+      __fenix_data_subset_get_type(&subset, 1, data_size, &type);
+      MPI_Isend(data_buf, 1, type, group->partners[1], group->base.groupid ^ STORE_PAYLOAD_TAG,
+            group->base.comm, requests + 1);
+      __fenix_data_subset_free(&subset);
+   }
+
+   free(changed);
+}
+
+//Full RAID 1 store which sends the partner a compressed copy of the data. The
+//copy goes at the front of the partner half and the rest is zeroed, so that
+//incremental storage shares it between snapshots. The partner half itself
+//stays full size, full storage saves bandwidth but no memory. Partners swap
+//compressed sizes first, 0 meaning the data didn't shrink and goes over as is.
+void* __imr_raid1_start_compressed(fenix_imr_group_t* group, fenix_imr_mentry_t* mentry,
+        fenix_member_entry_t* member_data, char* data_buf, MPI_Request* requests){
+   int data_size = member_data->datatype_size * member_data->current_count;
+   char* send_buf = NULL;
+   int size = 0;
+   if(data_size > __FENIX_COMPRESS_HEADER_SIZE){
+      send_buf = (char*) __fenix_arena_alloc(group->arena, data_size);
+      size = __fenix_compress(data_buf, data_size, member_data->datatype_size, send_buf, data_size - 1);
+   }
+
+   int partner_size;
+   MPI_Sendrecv(&size, 1, MPI_INT, group->partners[1], __IMR_COMPRESSED_SIZE_TAG,
+         &partner_size, 1, MPI_INT, group->partners[0], __IMR_COMPRESSED_SIZE_TAG,
+         group->base.comm, MPI_STATUS_IGNORE);
+
+   char* partner_buf = data_buf + data_size;
+   mentry->partner_size[__imr_slot(group, mentry, mentry->current_head)] = partner_size;
+   if(partner_size > 0){
+      memset(partner_buf + partner_size, 0, data_size - partner_size);
+   }
+   MPI_Irecv(partner_buf, partner_size > 0 ? partner_size : data_size, MPI_BYTE, group->partners[0],
+         group->base.groupid ^ STORE_PAYLOAD_TAG, group->base.comm, requests);
+
+   if(size == 0){
+      __fenix_arena_free(group->arena, send_buf);
+      send_buf = NULL;
+   }
+   MPI_Isend(size > 0 ? send_buf : data_buf, size > 0 ? size : data_size, MPI_BYTE, group->partners[1],
+         group->base.groupid ^ STORE_PAYLOAD_TAG, group->base.comm, requests + 1);
+   return send_buf;
+}
+
+//Turns a snapshot's compressed partner copy back into plain data, which is
+//what subset stores and recovery work with.
+void __imr_inflate_partner(fenix_imr_group_t* group, fenix_imr_mentry_t* mentry,
+        int slot, int data_size){
+   int size = mentry->partner_size[slot];
+   if(size == 0) return;
+
+   char* partner_buf = (char*)mentry->data[slot] + data_size;
+   void* compressed = __fenix_arena_alloc(group->arena, size);
+   memcpy(compressed, partner_buf, size);
+   __fenix_decompress(compressed, size, partner_buf, data_size);
+   __fenix_arena_free(group->arena, compressed);
+   mentry->partner_size[slot] = 0;
+}
+
+//Takes the local copy of the member's data and starts the redundancy exchange.
+//vectored stores gather from the member's buffer list and exchange in place.
+//Puts the subset of the staging snapshot straight into partners[1]'s copy,
+//so nothing waits on the partner getting to the same store. Any direction a
+//partner couldn't expose memory for goes by message instead.
+void __imr_raid1_start_rma(fenix_imr_group_t* group, fenix_imr_mentry_t* mentry,
+        fenix_member_entry_t* member_data, Fenix_Data_subset* subset, void* data_buf,
+        MPI_Request* requests){
+   size_t local_data_size = (size_t)member_data->datatype_size * member_data->current_count;
+   if(!mentry->rma_ready) __imr_rma_exchange(group, mentry, local_data_size);
+   int head = __imr_slot(group, mentry, mentry->current_head);
+
+   MPI_Datatype region_type;
+   __fenix_data_subset_get_type(subset, member_data->datatype_size, member_data->current_count,
+         &region_type);
+
+   requests[0] = requests[1] = MPI_REQUEST_NULL;
+   if(!mentry->rma_exposed[head]){
+      MPI_Irecv((char*)data_buf + local_data_size, 1, region_type, group->partners[0],
+            group->base.groupid ^ STORE_PAYLOAD_TAG, group->base.comm, requests);
+   }
+   if(mentry->rma_targets[head] != 0){
+      //Local completion waits for the next store into the staging area, remote
+      //completion for the commit.
+      __imr_rma_await_permit(group);
+      MPI_Put(data_buf, 1, region_type, group->partners[1], mentry->rma_targets[head], 1,
+            region_type, group->window);
+   } else {
+      MPI_Isend(data_buf, 1, region_type, group->partners[1],
+            group->base.groupid ^ STORE_PAYLOAD_TAG, group->base.comm, requests + 1);
+   }
+}
+
+fenix_imr_request_t* __imr_start_store(fenix_imr_group_t* group, fenix_imr_mentry_t* mentry,
+        fenix_member_entry_t* member_data, Fenix_Data_subset* subset_specifier, int vectored){
+   //Back-pressure: past the bound, a new store waits for the oldest ones.
+   if(fenix.data_progress_queue > 0){
+      __imr_bound_pending(group, fenix.data_progress_queue - 1);
+   }
+
+   fenix_imr_request_t* imr_request = (fenix_imr_request_t*) s_malloc(sizeof(fenix_imr_request_t));
+   imr_request->base.group = &(group->base);
+   imr_request->base.completed = 0;
+   imr_request->memberid = mentry->memberid;
+   imr_request->send_buf = NULL;
+   imr_request->recv_buf = NULL;
+   imr_request->parity_update = NULL;
+   imr_request->delta = NULL;
+   imr_request->pipeline = NULL;
+   imr_request->error = 0;
+   __fenix_data_subset_deep_copy(subset_specifier, &(imr_request->subset));
+
+   //Earlier istores of this member may still be sending out of the staging
+   //snapshot, or reducing into its parity, and we're about to overwrite both.
+   __imr_complete_member_pending(group, mentry->memberid);
+   int delta_update = __imr_raid5_prepare_delta(group, mentry, member_data);
+
+   //Puts out of the staging area may still be reading it.
+   if(mentry->rma_ready && group->window != MPI_WIN_NULL){
+      MPI_Win_flush_local(group->partners[1], group->window);
+   }
+
+   //Take the local copy right away, so the user is free to modify their
+   //buffer as soon as we return.
+   void* data_buf = mentry->data[__imr_slot(group, mentry, mentry->current_head)];
+   if(delta_update){
+      //Copied while building the delta.
+   } else if(vectored){
+      __fenix_data_member_gather_buffers(member_data, subset_specifier, data_buf);
+   } else {
+      __fenix_data_subset_copy_data(subset_specifier, data_buf,
+         member_data->user_data, member_data->datatype_size, member_data->current_count);
+   }
+
+   if(delta_update){
+      imr_request->num_requests = 2*group->set_size;
+      imr_request->requests = (MPI_Request*) s_malloc(2*group->set_size * sizeof(MPI_Request));
+      imr_request->delta = __imr_raid5_start_delta(group, mentry, member_data, subset_specifier,
+            vectored, imr_request->requests);
+
+   } else if(group->raid_mode == 1 && mentry->content_hash
+         && subset_specifier->specifier == __FENIX_SUBSET_FULL){
+      imr_request->num_requests = 2;
+      imr_request->requests = (MPI_Request*) s_malloc(2 * sizeof(MPI_Request));
+      __imr_raid1_start_hashed(group, mentry, member_data, data_buf, imr_request->requests);
+      //Fills the whole partner half.
+      mentry->partner_size[__imr_slot(group, mentry, mentry->current_head)] = 0;
+
+   } else if(group->raid_mode == 1 && mentry->compression != FENIX_DATA_COMPRESSION_NONE
+         && subset_specifier->specifier == __FENIX_SUBSET_FULL){
+      mentry->staged_hashed = 0;
+
+      imr_request->num_requests = 2;
+      imr_request->requests = (MPI_Request*) s_malloc(2 * sizeof(MPI_Request));
+      imr_request->send_buf = __imr_raid1_start_compressed(group, mentry, member_data, data_buf,
+            imr_request->requests);
+
+   } else if(group->raid_mode == 1){
+      //Hashes no longer describe what ends up in the staging area.
+      mentry->staged_hashed = 0;
+
+      //A subset only overwrites part of the partner half, the rest has to be plain.
+      int head = __imr_slot(group, mentry, mentry->current_head);
+      if(mentry->partner_size[head] > 0){
+         __imr_inflate_partner(group, mentry, head, member_data->datatype_size*member_data->current_count);
+      }
+
+      imr_request->num_requests = 0;
+      imr_request->requests = NULL;
+      if(__imr_rma_eligible(group, mentry)){
+         imr_request->num_requests = 2;
+         imr_request->requests = (MPI_Request*) s_malloc(2 * sizeof(MPI_Request));
+         __imr_raid1_start_rma(group, mentry, member_data, subset_specifier, data_buf,
+               imr_request->requests);
+      } else {
+         imr_request->pipeline = __imr_raid1_start_pipeline(group, mentry, member_data,
+               subset_specifier);
+
+         if(imr_request->pipeline == NULL){
+            //Scattered subset, the datatype picks the regions straight out of the
+            //snapshot and drops the partner's into the redundancy half.
+            MPI_Datatype region_type;
+            __fenix_data_subset_get_type(subset_specifier, member_data->datatype_size,
+                  member_data->current_count, &region_type);
+
+            imr_request->num_requests = 2;
+            imr_request->requests = (MPI_Request*) s_malloc(2 * sizeof(MPI_Request));
+            MPI_Irecv((char*)data_buf + member_data->datatype_size*member_data->current_count, 1,
+                  region_type, group->partners[0], group->base.groupid ^ STORE_PAYLOAD_TAG,
+                  group->base.comm, imr_request->requests);
+            MPI_Isend(data_buf, 1, region_type, group->partners[1],
+                  group->base.groupid ^ STORE_PAYLOAD_TAG, group->base.comm, imr_request->requests + 1);
+         }
+      }
+
+   } else if(group->raid_mode == 6){
+      imr_request->num_requests = 2*group->set_size;
+      imr_request->requests = (MPI_Request*) s_malloc(2*group->set_size * sizeof(MPI_Request));
+      imr_request->send_buf = __imr_raid6_start_store(group, mentry, member_data, imr_request->requests);
+
+   } else if(subset_specifier->specifier != __FENIX_SUBSET_FULL
+         && mentry->update_mode != FENIX_DATA_PARITY_UPDATE_DELTA){
+      int my_set_rank;
+      MPI_Comm_rank(group->set_comm, &my_set_rank);
+
+      imr_request->parity_update = __imr_raid5_plan_update(group, member_data,
+            subset_specifier, data_buf, my_set_rank);
+      fenix_imr_parity_update_t* update = imr_request->parity_update;
+
+      imr_request->num_requests = group->set_size;
+      imr_request->requests = (MPI_Request*) s_malloc(group->set_size * sizeof(MPI_Request));
+      for(int i = 0; i < group->set_size; i++){
+         imr_request->requests[i] = MPI_REQUEST_NULL;
+         if(update->sizes[i] == 0) continue;
+         MPI_Ireduce(i == my_set_rank ? MPI_IN_PLACE : update->buffers[i], update->buffers[i],
+               update->sizes[i], MPI_BYTE, fenix.xor_op, i, group->set_comm, imr_request->requests + i);
+      }
+
+   } else {
+      //TODO: I'm not sure if this is the best way to do this - could be a bottleneck if this is unoptimized since this 
+      //      could be running on a lot of data.
+      
+      //Why does this do it this way?
+      //In order to do recovery on a given block of data, we need to be missing only 1 of:
+      //    all of the data in the corresponding blocks and the parity for those blocks
+      //Standard RAID does this by having one disk store parity for a given block instead of data, but this assumes
+      //    that there is no benefit to data locality - in our case we want each node to have a local copy of its own 
+      //    data, preferably in a single (virtually) continuous memory range for data movement optomization. So we'll
+      //    store the local data, then put 1/N of the parity data at the bottom of the commit.
+      //The weirdness comes from the fact that a given node CANNOT contribute to the data being checked for parity which
+      //    will be stored on itself. IE, a node cannot save both a portion of the data and the parity for that data portion - 
+      //    doing so would mean if that node fails it is as if we lost two nodes for recovery semantics, making every failure
+      //    non-recoverable.
+      //    This means we need to do an XOR reduction across every node but myself, then store the result on myself - this is 
+      //    a little awkward with MPI's reductions which require full comm participation and do not recieve any information about
+      //    the source of a given chunk of data (IE we can't exclude data from node X, as we want to).
+      //This is easily doable using MPI send/recvs, but doing it that way neglects all of the data/comm size optimizations,
+      //    as well as any block XOR optimizations from MPI's reduction operations.
+      //We could do something like an alltoallv to send appropriate data to each node, then let them calculate parity info locally
+      //    However, we have to either allocate space to hold an extra copy of the entire data size, or we overwrite our
+      //    local buffer and have to re-distribute the data afterward.
+      //I think the best way to handle it will be to manipulate the XOR function. We will do a reduction which uses local data
+      //    that we do not actually want involved in calculating the parity. Then, we will XOR the local data with the result
+      //    to get the accurate parity info.
+      //    This involves computing the XOR on an extra 2/(set_size-1)*parity_size of data, but minimizes excess memory allocation
+      //    and network use. Scales well with higher set sizes.
+      //Each stripe has its own root, so issue all of the reductions together and
+      //let them progress concurrently instead of serializing set_size collectives.
+      int parity_size, remainder;
+      __imr_raid5_stripe(group, member_data->datatype_size * member_data->current_count,
+            &parity_size, &remainder);
+      void* parity_buf = (void*)((char*)data_buf + member_data->datatype_size*member_data->current_count + 2);
+
+      int my_set_rank;
+      MPI_Comm_rank(group->set_comm, &my_set_rank);
+
+      imr_request->num_requests = group->set_size;
+      imr_request->requests = (MPI_Request*) s_malloc(group->set_size * sizeof(MPI_Request));
+
+      int offset = 0;
+      for(int i = 0; i < group->set_size; i++){
+         if((my_set_rank == group->set_size-1) && i==my_set_rank){
+           offset = 0;
+         }
+
+         MPI_Ireduce((void*)((char*)data_buf + offset), parity_buf, parity_size + (i < remainder ? 1 : 0),
+             MPI_BYTE, fenix.xor_op, i, group->set_comm, imr_request->requests + i);
+         if(i != my_set_rank){
+            offset += parity_size + (i < remainder ? 1 : 0);
+         }
+      }
+      mentry->parity_full[__imr_slot(group, mentry, mentry->current_head)] = 1;
+   }
+
+   imr_request->next = group->requests;
+   group->requests = imr_request;
+
+   return imr_request;
+}
+
+int __imr_member_istore_common(fenix_group_t* g, int member_id, 
+        Fenix_Data_subset subset_specifier, Fenix_Request *request, int vectored){
+   int retval = -1;
+   fenix_imr_group_t* group = (fenix_imr_group_t*)g;
+
+   fenix_imr_mentry_t* mentry;
+   int found_member = __imr_find_mentry(group, member_id, &mentry);
+
+   int member_data_index = __fenix_search_memberid(group->base.member, member_id);
+   fenix_member_entry_t* member_data = &(group->base.member->member_entry[member_data_index]);
+
+   if(found_member != FENIX_SUCCESS){
+      debug_print("ERROR Fenix_Data_member_istore: member_id <%d> does not exist on rank <%d>!\n",
+                member_id, g->current_rank);
+      retval = FENIX_ERROR_INVALID_MEMBERID;
+   } else if(group->raid_mode != 1 && group->raid_mode != 5 && group->raid_mode != 6){
+      debug_print("ERROR Fenix_Data_member_istore: Raid mode <%d> is not supported yet!\n",
+                group->raid_mode);
+      retval = FENIX_ERROR_UNINITIALIZED;
+   } else {
+      fenix_imr_request_t* imr_request = __imr_start_store(group, mentry, member_data,
+            &subset_specifier, vectored);
+
+      request->mpi_send_req = MPI_REQUEST_NULL;
+      request->mpi_recv_req = MPI_REQUEST_NULL;
+      request->data_request = &(imr_request->base);
+
+      retval = FENIX_SUCCESS;
+   }
+
+   return retval;
+}
+
+int __imr_member_istore(fenix_group_t* g, int member_id, 
+        Fenix_Data_subset subset_specifier, Fenix_Request *request){
+   return __imr_member_istore_common(g, member_id, subset_specifier, request, 0);
+}
+
+int __imr_member_istorev(fenix_group_t* g, int member_id, 
+           Fenix_Data_subset subset_specifier, Fenix_Request *request){
+   return __imr_member_istore_common(g, member_id, subset_specifier, request, 1);
+}
+
+int __imr_member_storev(fenix_group_t* g, int member_id, 
+        Fenix_Data_subset subset_specifier){
+   Fenix_Request request;
+   int retval = __imr_member_istorev(g, member_id, subset_specifier, &request);
+   if(retval == FENIX_SUCCESS){
+      retval = __imr_request_wait(g, request.data_request);
+   }
+   return retval;
+}
+
+//Whether a member's store can ride along in a coalesced store of the whole
+//group. Only plain stores of members small enough that their exchange is
+//latency bound qualify, anything else keeps its own path.
+int __imr_can_coalesce(fenix_imr_group_t* group, fenix_imr_mentry_t* mentry,
+        fenix_member_entry_t* member_data, Fenix_Data_subset* subset){
+   size_t local_data_size = (size_t)member_data->datatype_size * member_data->current_count;
+   if(local_data_size > (size_t)mentry->chunk_size) return 0;
+
+   if(group->raid_mode == 1){
+      //Puts already leave without waiting on the partner.
+      if(__imr_rma_eligible(group, mentry)) return 0;
+      return !mentry->content_hash && mentry->compression == FENIX_DATA_COMPRESSION_NONE
+            && mentry->partner_size[__imr_slot(group, mentry, mentry->current_head)] == 0;
+   } else if(group->raid_mode == 5){
+      return mentry->update_mode == FENIX_DATA_PARITY_UPDATE_REDUCE
+            && subset->specifier == __FENIX_SUBSET_FULL;
+   }
+   return 0;
+}
+
+//Takes the local copy of every coalesced member's data.
+void __imr_coalesced_copy(fenix_imr_group_t* group, fenix_imr_mentry_t** mentries,
+        fenix_member_entry_t** members, Fenix_Data_subset** subsets, int num_members){
+   for(int i = 0; i < num_members; i++){
+      void* data_buf = mentries[i]->data[__imr_slot(group, mentries[i], mentries[i]->current_head)];
+      __fenix_data_subset_copy_data(subsets[i], data_buf, members[i]->user_data,
+            members[i]->datatype_size, members[i]->current_count);
+      //Hashes no longer describe what ends up in the staging area.
+      mentries[i]->staged_hashed = 0;
+   }
+}
+
+void __imr_coalesced_finish(fenix_imr_group_t* group, fenix_imr_mentry_t** mentries,
+        Fenix_Data_subset** subsets, int num_members){
+   for(int i = 0; i < num_members; i++){
+      __fenix_data_subset_merge_inplace(mentries[i]->data_regions
+            + __imr_slot(group, mentries[i], mentries[i]->current_head), subsets[i]);
+   }
+}
+
+//Types picking every coalesced member's regions straight out of its staging
+//snapshot, and dropping the partner's into the redundancy half.
+void __imr_raid1_coalesced_types(fenix_imr_group_t* group, fenix_imr_mentry_t** mentries,
+        fenix_member_entry_t** members, Fenix_Data_subset** subsets, int num_members,
+        MPI_Datatype* send_type, MPI_Datatype* recv_type){
+   int num_regions = 0, capacity = num_members;
+   int* lengths = (int*) s_malloc(capacity * sizeof(int));
+   MPI_Aint* send_displs = (MPI_Aint*) s_malloc(capacity * sizeof(MPI_Aint));
+   MPI_Aint* recv_displs = (MPI_Aint*) s_malloc(capacity * sizeof(MPI_Aint));
+
+   for(int i = 0; i < num_members; i++){
+      fenix_member_entry_t* member_data = members[i];
+      char* data_buf = (char*)mentries[i]->data[__imr_slot(group, mentries[i], mentries[i]->current_head)];
+      size_t local_data_size = (size_t)member_data->datatype_size * member_data->current_count;
+
+      int *starts, *counts;
+      int member_regions = __fenix_data_subset_get_regions(subsets[i], member_data->current_count,
+            &starts, &counts);
+      if(num_regions + member_regions > capacity){
+         capacity = 2*(num_regions + member_regions);
+         lengths = (int*) s_realloc(lengths, capacity * sizeof(int));
+         send_displs = (MPI_Aint*) s_realloc(send_displs, capacity * sizeof(MPI_Aint));
+         recv_displs = (MPI_Aint*) s_realloc(recv_displs, capacity * sizeof(MPI_Aint));
+      }
+      for(int r = 0; r < member_regions; r++){
+         char* region = data_buf + (size_t)starts[r]*member_data->datatype_size;
+         lengths[num_regions] = counts[r]*member_data->datatype_size;
+         MPI_Get_address(region, send_displs + num_regions);
+         MPI_Get_address(region + local_data_size, recv_displs + num_regions);
+         num_regions++;
+      }
+      free(starts);
+      free(counts);
+   }
+
+   MPI_Type_create_hindexed(num_regions, lengths, send_displs, MPI_BYTE, send_type);
+   MPI_Type_create_hindexed(num_regions, lengths, recv_displs, MPI_BYTE, recv_type);
+   MPI_Type_commit(send_type);
+   MPI_Type_commit(recv_type);
+
+   free(lengths);
+   free(send_displs);
+   free(recv_displs);
+}
+
+//One message each way carries every coalesced member's regions.
+int __imr_raid1_store_coalesced(fenix_imr_group_t* group, fenix_imr_mentry_t** mentries,
+        fenix_member_entry_t** members, Fenix_Data_subset** subsets, int num_members){
+   __imr_coalesced_copy(group, mentries, members, subsets, num_members);
+
+   MPI_Datatype send_type, recv_type;
+   __imr_raid1_coalesced_types(group, mentries, members, subsets, num_members,
+         &send_type, &recv_type);
+
+   int result = MPI_Sendrecv(MPI_BOTTOM, 1, send_type, group->partners[1],
+         group->base.groupid ^ STORE_PAYLOAD_TAG, MPI_BOTTOM, 1, recv_type, group->partners[0],
+         group->base.groupid ^ STORE_PAYLOAD_TAG, group->base.comm, MPI_STATUS_IGNORE);
+
+   MPI_Type_free(&send_type);
+   MPI_Type_free(&recv_type);
+   return result;
+}
+
+void __imr_raid5_coalesced_layout(fenix_imr_group_t* group, fenix_member_entry_t** members,
+        int num_members, fenix_imr_raid5_layout_t* layout){
+   int my_set_rank;
+   MPI_Comm_rank(group->set_comm, &my_set_rank);
+
+   layout->offsets = (int*) s_malloc(((size_t)num_members * group->set_size + 1) * sizeof(int));
+   layout->lengths = (int*) s_malloc(((size_t)num_members * group->set_size + 1) * sizeof(int));
+   layout->stripe_offsets = (size_t*) s_calloc(group->set_size + 1, sizeof(size_t));
+   for(int i = 0; i < num_members; i++){
+      int parity_size, remainder;
+      __imr_raid5_stripe(group, members[i]->datatype_size * members[i]->current_count,
+            &parity_size, &remainder);
+      //Same walk as a single member's store, see __imr_start_store.
+      int offset = 0;
+      for(int s = 0; s < group->set_size; s++){
+         if((my_set_rank == group->set_size-1) && s == my_set_rank){
+            offset = 0;
+         }
+         layout->offsets[i*group->set_size + s] = offset;
+         layout->lengths[i*group->set_size + s] = parity_size + (s < remainder ? 1 : 0);
+         layout->stripe_offsets[s+1] += layout->lengths[i*group->set_size + s];
+         if(s != my_set_rank){
+            offset += layout->lengths[i*group->set_size + s];
+         }
+      }
+   }
+   for(int s = 0; s < group->set_size; s++){
+      layout->stripe_offsets[s+1] += layout->stripe_offsets[s];
+   }
+
+   layout->packed = (char*) s_malloc(layout->stripe_offsets[group->set_size] + 1);
+}
+
+void __imr_raid5_coalesced_pack(fenix_imr_group_t* group, fenix_imr_mentry_t** mentries,
+        int num_members, fenix_imr_raid5_layout_t* layout){
+   for(int s = 0; s < group->set_size; s++){
+      char* dest = layout->packed + layout->stripe_offsets[s];
+      for(int i = 0; i < num_members; i++){
+         char* data_buf = (char*)mentries[i]->data[__imr_slot(group, mentries[i], mentries[i]->current_head)];
+         memcpy(dest, data_buf + layout->offsets[i*group->set_size + s],
+               layout->lengths[i*group->set_size + s]);
+         dest += layout->lengths[i*group->set_size + s];
+      }
+   }
+}
+
+//My own stripe was reduced in place, the result landed where my contribution was.
+void __imr_raid5_coalesced_unpack(fenix_imr_group_t* group, fenix_imr_mentry_t** mentries,
+        fenix_member_entry_t** members, int num_members, fenix_imr_raid5_layout_t* layout){
+   int my_set_rank;
+   MPI_Comm_rank(group->set_comm, &my_set_rank);
+
+   char* src = layout->packed + layout->stripe_offsets[my_set_rank];
+   for(int i = 0; i < num_members; i++){
+      int slot = __imr_slot(group, mentries[i], mentries[i]->current_head);
+      char* data_buf = (char*)mentries[i]->data[slot];
+      char* parity_buf = data_buf + members[i]->datatype_size*members[i]->current_count + 2;
+      int length = layout->lengths[i*group->set_size + my_set_rank];
+
+      //Take my own data back out of the parity.
+      memcpy(parity_buf, src, length);
+      __fenix_xor_region(data_buf + layout->offsets[i*group->set_size + my_set_rank], parity_buf, length);
+      src += length;
+      mentries[i]->parity_full[slot] = 1;
+   }
+}
+
+void __imr_raid5_free_layout(fenix_imr_raid5_layout_t* layout){
+   free(layout->offsets);
+   free(layout->lengths);
+   free(layout->stripe_offsets);
+   free(layout->packed);
+}
+
+void __imr_raid5_start_coalesced(fenix_imr_group_t* group, fenix_imr_raid5_layout_t* layout,
+        MPI_Request* requests){
+   int my_set_rank;
+   MPI_Comm_rank(group->set_comm, &my_set_rank);
+   for(int s = 0; s < group->set_size; s++){
+      char* stripe = layout->packed + layout->stripe_offsets[s];
+      MPI_Ireduce(s == my_set_rank ? MPI_IN_PLACE : stripe, stripe,
+            layout->stripe_offsets[s+1] - layout->stripe_offsets[s], MPI_BYTE, fenix.xor_op, s,
+            group->set_comm, requests + s);
+   }
+}
+
+//Packs every coalesced member's contribution to each parity stripe together,
+//so the whole group takes set_size reductions instead of set_size per member.
+int __imr_raid5_store_coalesced(fenix_imr_group_t* group, fenix_imr_mentry_t** mentries,
+        fenix_member_entry_t** members, Fenix_Data_subset** subsets, int num_members){
+   fenix_imr_raid5_layout_t layout;
+   __imr_raid5_coalesced_layout(group, members, num_members, &layout);
+   __imr_coalesced_copy(group, mentries, members, subsets, num_members);
+   __imr_raid5_coalesced_pack(group, mentries, num_members, &layout);
+
+   MPI_Request* requests = (MPI_Request*) s_malloc(group->set_size * sizeof(MPI_Request));
+   __imr_raid5_start_coalesced(group, &layout, requests);
+   int result = MPI_Waitall(group->set_size, requests, MPI_STATUSES_IGNORE);
+
+   if(result == MPI_SUCCESS){
+      __imr_raid5_coalesced_unpack(group, mentries, members, num_members, &layout);
+   }
+
+   free(requests);
+   __imr_raid5_free_layout(&layout);
+   return result;
 }
 
-int __imr_member_create(fenix_group_t* g, fenix_member_entry_t* mentry){
+int __imr_member_store_all(fenix_group_t* g, Fenix_Data_subset* specifiers){
    fenix_imr_group_t* group = (fenix_imr_group_t*)g;
-   int retval = -1;
+   int retval = FENIX_SUCCESS;
 
-   fenix_imr_mentry_t* closest_imr_mentry;
-   int found_memberid = __imr_find_mentry(group, mentry->memberid, &closest_imr_mentry);
+   //Any istores still in flight have to land before we overwrite the staging area.
+   __imr_complete_pending(group);
+
+   fenix_imr_mentry_t** mentries = (fenix_imr_mentry_t**) s_malloc((group->entries_count+1) * sizeof(fenix_imr_mentry_t*));
+   fenix_member_entry_t** members = (fenix_member_entry_t**) s_malloc((group->entries_count+1) * sizeof(fenix_member_entry_t*));
+   Fenix_Data_subset** subsets = (Fenix_Data_subset**) s_malloc((group->entries_count+1) * sizeof(Fenix_Data_subset*));
+   int num_coalesced = 0;
+
+   //Entries are sorted by member id, so every rank walks the members in the
+   //same order.
+   for(int i = 0; i < group->entries_count; i++){
+      fenix_imr_mentry_t* mentry = group->entries + i;
+      int member_data_index = __fenix_search_memberid(g->member, mentry->memberid);
+      fenix_member_entry_t* member_data = &(g->member->member_entry[member_data_index]);
+      Fenix_Data_subset* subset = specifiers + member_data_index;
+
+      if(__imr_can_coalesce(group, mentry, member_data, subset)){
+         mentries[num_coalesced] = mentry;
+         members[num_coalesced] = member_data;
+         subsets[num_coalesced] = subset;
+         num_coalesced++;
+      } else {
+         int result = __imr_member_store(g, mentry->memberid, *subset);
+         if(result != FENIX_SUCCESS) retval = result;
+      }
+   }
 
-   if(found_memberid == FENIX_SUCCESS){
-      debug_print("Error Fenix_Data_member_create: member_id <%d> already exists in this policy\n",
-            mentry->memberid);
-   } else {
-      //Double check that we have room for the member.
-      if(group->entries_count >= group->entries_size){
-         group->entries = (fenix_imr_mentry_t*) s_realloc(group->entries,
-               group->entries_size * 2 * sizeof(fenix_imr_mentry_t));
-         group->entries_size *= 2;
+   if(num_coalesced > 0){
+      int result = MPI_SUCCESS;
+      if(group->raid_mode == 1){
+         result = __imr_raid1_store_coalesced(group, mentries, members, subsets, num_coalesced);
+      } else {
+         result = __imr_raid5_store_coalesced(group, mentries, members, subsets, num_coalesced);
       }
 
-      fenix_imr_mentry_t* new_imr_mentry;
-      if(found_memberid == __FENIX_IMR_NO_MEMBERS){
-         //This is the first member, it goes at the beginning.
-         new_imr_mentry = group->entries;
+      if(result != MPI_SUCCESS){
+         debug_print("ERROR Fenix_Data_member_store: coalesced store of <%d> members failed on rank <%d>\n",
+               num_coalesced, g->current_rank);
+         retval = FENIX_ERROR_DATA_WAIT;
       } else {
-         int closest_index = closest_imr_mentry - group->entries;
-         //Do we want to place this new member before or after
-         //the closest member?
-         if(mentry->memberid > closest_imr_mentry->memberid){
-            //Move all entries after the closest  to one farther to right, b/c I belong
-            //right after the closest.
-            memmove(group->entries+closest_index +1, group->entries+closest_index +2, 
-                  group->entries_size - closest_index+1);
-            new_imr_mentry = group->entries+closest_index+1;
-         } else {
-            //Move all entries starting w/ closest  to one farther to right, b/c I belong
-            //right before the closest.
-            memmove(group->entries+closest_index, group->entries+closest_index +1, 
-                  group->entries_size - closest_index);
-            new_imr_mentry = group->entries+closest_index;
-         }
+         __imr_coalesced_finish(group, mentries, subsets, num_coalesced);
       }
+   }
 
-      //Now I've got the location to store this member,
-      //so I just need to actually fill in the data.
-      new_imr_mentry->current_head = 0;
-      new_imr_mentry->memberid = mentry->memberid;
-      
-      new_imr_mentry->data = (void**) malloc( (group->base.depth+2) * sizeof(void*));
-      int local_data_size = mentry->datatype_size * mentry->current_count;
-      new_imr_mentry->data_regions = 
-         (Fenix_Data_subset *)malloc(sizeof(Fenix_Data_subset) * (group->base.depth+2) );
-      new_imr_mentry->timestamp = (int*) malloc(sizeof(int) * (group->base.depth + 2));
-      
-      for(int i = 0; i < group->base.depth + 2; i++){
-         __imr_alloc_data_region(new_imr_mentry->data + i, group->raid_mode, local_data_size, group->set_size);
+   free(mentries);
+   free(members);
+   free(subsets);
+   return retval;
+}
 
-         //Initialize to smallest # blocks allowed.
-         __fenix_data_subset_init(1, new_imr_mentry->data_regions + i);
-         new_imr_mentry->data_regions[i].specifier = __FENIX_SUBSET_EMPTY;
+//Drops everything a plan built on top of the members it resolved.
+void __imr_plan_release(fenix_imr_group_t* group, fenix_imr_plan_t* plan){
+   for(int slot = 0; slot < plan->num_slots; slot++){
+      if(plan->requests[2*slot] == MPI_REQUEST_NULL) continue;
+      MPI_Request_free(plan->requests + 2*slot);
+      MPI_Request_free(plan->requests + 2*slot + 1);
+      MPI_Type_free(plan->types + 2*slot);
+      MPI_Type_free(plan->types + 2*slot + 1);
+   }
+   if(plan->reductions != NULL){
+#if MPI_VERSION >= 4
+      for(int s = 0; s < group->set_size; s++){
+         MPI_Request_free(plan->reductions + s);
+      }
+#endif
+      __imr_raid5_free_layout(&(plan->layout));
+   }
+   free(plan->slot_data);
+   free(plan->types);
+   free(plan->requests);
+   free(plan->reductions);
+   free(plan->mentries);
+   free(plan->members);
+   free(plan->subsets);
+   free(plan->counts);
+   free(plan->unplanned);
+   plan->slot_data = NULL;
+   plan->types = NULL;
+   plan->requests = NULL;
+   plan->reductions = NULL;
+   plan->mentries = NULL;
+   plan->members = NULL;
+   plan->subsets = NULL;
+   plan->counts = NULL;
+   plan->unplanned = NULL;
+}
 
-        //-1 is not a valid timestamp, use as an indicator that the data isn't valid.
-        new_imr_mentry->timestamp[i] = -1;
+//Looks the plan's members up, and splits them into the ones it coalesces and
+//the ones it stores on their own. Redone whenever members come and go.
+void __imr_plan_resolve(fenix_imr_group_t* group, fenix_imr_plan_t* plan){
+   __imr_plan_release(group, plan);
+
+   plan->mentries = (fenix_imr_mentry_t**) s_malloc((plan->num_memberids+1) * sizeof(fenix_imr_mentry_t*));
+   plan->members = (fenix_member_entry_t**) s_malloc((plan->num_memberids+1) * sizeof(fenix_member_entry_t*));
+   plan->subsets = (Fenix_Data_subset**) s_malloc((plan->num_memberids+1) * sizeof(Fenix_Data_subset*));
+   plan->counts = (int*) s_malloc((plan->num_memberids+1) * sizeof(int));
+   plan->unplanned = (int*) s_malloc((plan->num_memberids+1) * sizeof(int));
+   plan->num_coalesced = 0;
+   plan->num_unplanned = 0;
+
+   //Member ids are sorted, walk them alongside the entries so every rank
+   //orders the members the same way.
+   for(int i = 0, j = 0; i < group->entries_count && j < plan->num_memberids; i++){
+      fenix_imr_mentry_t* mentry = group->entries + i;
+      while(j < plan->num_memberids && plan->memberids[j] < mentry->memberid) j++;
+      if(j == plan->num_memberids || plan->memberids[j] != mentry->memberid) continue;
+
+      int member_data_index = __fenix_search_memberid(group->base.member, mentry->memberid);
+      fenix_member_entry_t* member_data = &(group->base.member->member_entry[member_data_index]);
+      if(__imr_can_coalesce(group, mentry, member_data, &(plan->subset))){
+         plan->mentries[plan->num_coalesced] = mentry;
+         plan->members[plan->num_coalesced] = member_data;
+         plan->subsets[plan->num_coalesced] = &(plan->subset);
+         plan->counts[plan->num_coalesced] = member_data->current_count;
+         plan->num_coalesced++;
+      } else {
+         plan->unplanned[plan->num_unplanned++] = mentry->memberid;
       }
-      //The first commit's timestamp is the group's timestart.
-      new_imr_mentry->timestamp[0] = group->base.timestart;
+   }
 
-      group->entries_count++;
+   plan->num_slots = group->base.depth + 2;
+   plan->slot_data = (void**) s_calloc((size_t)plan->num_slots * plan->num_coalesced + 1, sizeof(void*));
+   plan->types = (MPI_Datatype*) s_malloc(2 * plan->num_slots * sizeof(MPI_Datatype));
+   plan->requests = (MPI_Request*) s_malloc(2 * plan->num_slots * sizeof(MPI_Request));
+   for(int slot = 0; slot < 2*plan->num_slots; slot++){
+      plan->requests[slot] = MPI_REQUEST_NULL;
+   }
 
-      retval = FENIX_SUCCESS;
+   if(group->raid_mode == 5 && plan->num_coalesced > 0){
+      //The packed stripes never move, so their reductions can be set up once.
+      __imr_raid5_coalesced_layout(group, plan->members, plan->num_coalesced, &(plan->layout));
+      plan->reductions = (MPI_Request*) s_malloc(group->set_size * sizeof(MPI_Request));
+#if MPI_VERSION >= 4
+      int my_set_rank;
+      MPI_Comm_rank(group->set_comm, &my_set_rank);
+      for(int s = 0; s < group->set_size; s++){
+         char* stripe = plan->layout.packed + plan->layout.stripe_offsets[s];
+         MPI_Reduce_init(s == my_set_rank ? MPI_IN_PLACE : stripe, stripe,
+               plan->layout.stripe_offsets[s+1] - plan->layout.stripe_offsets[s], MPI_BYTE,
+               fenix.xor_op, s, group->set_comm, MPI_INFO_NULL, plan->reductions + s);
+      }
+#endif
    }
 
-   return retval;
+   plan->layout_version = group->layout_version;
 }
 
-void __imr_member_free(fenix_imr_mentry_t* mentry, int depth){
-  //Start by clearing out the mentry's data pointers.
-  for(int i = 0; i < depth + 2; i++){
-     __fenix_data_subset_free(mentry->data_regions + i);
-     free(mentry->data[i]);
-  }
-
-  free(mentry->data);
-  free(mentry->data_regions);
-  free(mentry->timestamp);
+void* __imr_store_plan_create(fenix_group_t* g, int* memberids, int num_memberids,
+        Fenix_Data_subset* subset){
+   fenix_imr_plan_t* plan = (fenix_imr_plan_t*) s_calloc(1, sizeof(fenix_imr_plan_t));
+   plan->num_memberids = num_memberids;
+   plan->memberids = (int*) s_malloc((num_memberids+1) * sizeof(int));
+   memcpy(plan->memberids, memberids, num_memberids * sizeof(int));
+   qsort(plan->memberids, num_memberids, sizeof(int), __fenix_comparator);
+   __fenix_data_subset_deep_copy(subset, &(plan->subset));
+
+   __imr_plan_resolve((fenix_imr_group_t*)g, plan);
+   return plan;
 }
 
-int __imr_member_delete(fenix_group_t* g, int member_id){
-   int retval = -1;
-   fenix_imr_group_t* group = (fenix_imr_group_t*)g;
-   //Find the member first
-   fenix_imr_mentry_t *mentry;
-   int found_member = __imr_find_mentry(group, member_id, &mentry);
-   
-   if(found_member != FENIX_SUCCESS){
-      debug_print("ERROR Fenix_Data_member_delete: member_id <%d> does not exist!\n",
-                member_id);
-      retval = FENIX_ERROR_INVALID_MEMBERID;
-   } else {
-      
-      //Free all of the pointers in the mentry
-      __imr_member_free(mentry, group->base.depth);
-
-      //Now shift all the subsequent mentries back one, unless I'm already the last one.
-      int member_index = mentry - group->entries;
-      if(member_index != (group->entries_count-1) ){
-         memmove(mentry, mentry+1, group->entries_count - 1 - member_index);
-      }
+//RAID 1 keeps a persistent exchange per ring slot of the first member, all
+//members rotate together so the other members' slots follow along. Rebuilt
+//whenever one of the staging regions it was made for has moved.
+MPI_Request* __imr_plan_raid1_requests(fenix_imr_group_t* group, fenix_imr_plan_t* plan){
+   int key = __imr_slot(group, plan->mentries[0], plan->mentries[0]->current_head);
+   void** slot_data = plan->slot_data + (size_t)key*plan->num_coalesced;
+   MPI_Request* requests = plan->requests + 2*key;
+
+   int valid = requests[0] != MPI_REQUEST_NULL;
+   for(int i = 0; valid && i < plan->num_coalesced; i++){
+      fenix_imr_mentry_t* mentry = plan->mentries[i];
+      valid = slot_data[i] == mentry->data[__imr_slot(group, mentry, mentry->current_head)];
+   }
+   if(valid) return requests;
 
-      group->entries_count--;
+   if(requests[0] != MPI_REQUEST_NULL){
+      MPI_Request_free(requests);
+      MPI_Request_free(requests + 1);
+      MPI_Type_free(plan->types + 2*key);
+      MPI_Type_free(plan->types + 2*key + 1);
    }
-   return retval;
+   __imr_raid1_coalesced_types(group, plan->mentries, plan->members, plan->subsets,
+         plan->num_coalesced, plan->types + 2*key, plan->types + 2*key + 1);
+   MPI_Recv_init(MPI_BOTTOM, 1, plan->types[2*key + 1], group->partners[0],
+         group->base.groupid ^ STORE_PAYLOAD_TAG, group->base.comm, requests);
+   MPI_Send_init(MPI_BOTTOM, 1, plan->types[2*key], group->partners[1],
+         group->base.groupid ^ STORE_PAYLOAD_TAG, group->base.comm, requests + 1);
+   for(int i = 0; i < plan->num_coalesced; i++){
+      fenix_imr_mentry_t* mentry = plan->mentries[i];
+      slot_data[i] = mentry->data[__imr_slot(group, mentry, mentry->current_head)];
+   }
+   return requests;
 }
 
+int __imr_store_plan_start(fenix_group_t* g, void* p){
+   fenix_imr_group_t* group = (fenix_imr_group_t*)g;
+   fenix_imr_plan_t* plan = (fenix_imr_plan_t*)p;
+   int retval = FENIX_SUCCESS;
 
+   //Any istores still in flight have to land before we overwrite the staging area.
+   __imr_complete_pending(group);
 
-int __imr_member_store(fenix_group_t* g, int member_id, 
-        Fenix_Data_subset subset_specifier){
-   int retval = -1;
-   fenix_imr_group_t* group = (fenix_imr_group_t*)g;
-   
-   fenix_imr_mentry_t* mentry;
-   int found_member = __imr_find_mentry(group, member_id, &mentry);
+   int stale = plan->layout_version != group->layout_version;
+   for(int i = 0; !stale && i < plan->num_coalesced; i++){
+      stale = plan->counts[i] != plan->members[i]->current_count;
+   }
+   if(stale) __imr_plan_resolve(group, plan);
 
-   fenix_member_entry_t* member_data;
-   //Shouldn't need to check for failure to find the member, that should be done before
-   //calling
-   int member_data_index = __fenix_search_memberid(group->base.member, member_id);
-   member_data = &(group->base.member->member_entry[member_data_index]);
-   
-   if(found_member != FENIX_SUCCESS){
-      debug_print("ERROR Fenix_Data_member_store: member_id <%d> does not exist on rank <%d>!\n",
-                member_id, g->current_rank);
-      retval = FENIX_ERROR_INVALID_MEMBERID;
-   } else {
-      //Copy my own data, trade data with partner, update data region
-      //Store my data at the beginning of the member's buffer, resiliency data after that.
-      __fenix_data_subset_copy_data(&subset_specifier, mentry->data[mentry->current_head],
-         member_data->user_data, member_data->datatype_size, member_data->current_count);
-      
+   for(int i = 0; i < plan->num_unplanned; i++){
+      int result = __imr_member_store(g, plan->unplanned[i], plan->subset);
+      if(result != FENIX_SUCCESS) retval = result;
+   }
+
+   if(plan->num_coalesced > 0){
+      int result;
+      __imr_coalesced_copy(group, plan->mentries, plan->members, plan->subsets, plan->num_coalesced);
       if(group->raid_mode == 1){
+         MPI_Request* requests = __imr_plan_raid1_requests(group, plan);
+         MPI_Startall(2, requests);
+         result = MPI_Waitall(2, requests, MPI_STATUSES_IGNORE);
+      } else {
+         __imr_raid5_coalesced_pack(group, plan->mentries, plan->num_coalesced, &(plan->layout));
+#if MPI_VERSION >= 4
+         MPI_Startall(group->set_size, plan->reductions);
+#else
+         __imr_raid5_start_coalesced(group, &(plan->layout), plan->reductions);
+#endif
+         result = MPI_Waitall(group->set_size, plan->reductions, MPI_STATUSES_IGNORE);
+         if(result == MPI_SUCCESS){
+            __imr_raid5_coalesced_unpack(group, plan->mentries, plan->members,
+                  plan->num_coalesced, &(plan->layout));
+         }
+      }
 
-         size_t serialized_size;
-         void* serialized = __fenix_data_subset_serialize(&subset_specifier, 
-               mentry->data[mentry->current_head], member_data->datatype_size, 
-               member_data->current_count, &serialized_size);
+      if(result != MPI_SUCCESS){
+         debug_print("ERROR Fenix_Data_plan_store: store of <%d> members failed on rank <%d>\n",
+               plan->num_coalesced, g->current_rank);
+         retval = FENIX_ERROR_DATA_WAIT;
+      } else {
+         __imr_coalesced_finish(group, plan->mentries, plan->subsets, plan->num_coalesced);
+      }
+   }
 
-         void* recv_buf = malloc(serialized_size * member_data->datatype_size);
+   return retval;
+}
 
-         MPI_Sendrecv(serialized, serialized_size * member_data->datatype_size, MPI_BYTE,
-               group->partners[1], group->base.groupid ^ STORE_PAYLOAD_TAG, recv_buf, 
-               serialized_size * member_data->datatype_size, MPI_BYTE, group->partners[0], 
-               group->base.groupid ^ STORE_PAYLOAD_TAG, group->base.comm, NULL); 
+void __imr_store_plan_free(fenix_group_t* g, void* p){
+   fenix_imr_plan_t* plan = (fenix_imr_plan_t*)p;
+   __imr_plan_release((fenix_imr_group_t*)g, plan);
+   __fenix_data_subset_free(&(plan->subset));
+   free(plan->memberids);
+   free(plan);
+}
 
-         //Expand the serialized data out and store into the partner's portion of this data entry.
-         __fenix_data_subset_deserialize(&subset_specifier, recv_buf, 
-               mentry->data[mentry->current_head] + member_data->datatype_size*member_data->current_count,
-               member_data->current_count, member_data->datatype_size);
+//Drives an istore's communication, and once it is done moves the received
+//redundancy data into place. Returns whether the request has completed.
+int __imr_request_progress(fenix_imr_group_t* group, fenix_imr_request_t* request, int blocking){
+   int flag = 1;
+   int result;
 
-         free(recv_buf);
-         free(serialized);
+   if(request->base.completed) return 1;
 
-      } else if(group->raid_mode == 5){
-         //TODO: Try to optimize for partial commits - currently does parity on the whole region regardless of commit area.
-         //TODO: I'm not sure if this is the best way to do this - could be a bottleneck if this is unoptimized since this 
-         //      could be running on a lot of data.
-         
-         //Why does this do it this way?
-         //In order to do recovery on a given block of data, we need to be missing only 1 of:
-         //    all of the data in the corresponding blocks and the parity for those blocks
-         //Standard RAID does this by having one disk store parity for a given block instead of data, but this assumes
-         //    that there is no benefit to data locality - in our case we want each node to have a local copy of its own 
-         //    data, preferably in a single (virtually) continuous memory range for data movement optomization. So we'll
-         //    store the local data, then put 1/N of the parity data at the bottom of the commit.
-         //The weirdness comes from the fact that a given node CANNOT contribute to the data being checked for parity which
-         //    will be stored on itself. IE, a node cannot save both a portion of the data and the parity for that data portion - 
-         //    doing so would mean if that node fails it is as if we lost two nodes for recovery semantics, making every failure
-         //    non-recoverable.
-         //    This means we need to do an XOR reduction across every node but myself, then store the result on myself - this is 
-         //    a little awkward with MPI's reductions which require full comm participation and do not recieve any information about
-         //    the source of a given chunk of data (IE we can't exclude data from node X, as we want to).
-         //This is easily doable using MPI send/recvs, but doing it that way neglects all of the data/comm size optimizations,
-         //    as well as any block XOR optimizations from MPI's reduction operations.
-         //We could do something like an alltoallv to send appropriate data to each node, then let them calculate parity info locally
-         //    However, we have to either allocate space to hold an extra copy of the entire data size, or we overwrite our
-         //    local buffer and have to re-distribute the data afterward.
-         //I think the best way to handle it will be to manipulate the XOR function. We will do a reduction which uses local data
-         //    that we do not actually want involved in calculating the parity. Then, we will XOR the local data with the result
-         //    to get the accurate parity info.
-         //    This involves computing the XOR on an extra 2/(set_size-1)*parity_size of data, but minimizes excess memory allocation
-         //    and network use. Scales well with higher set sizes.
-         int parity_size = (member_data->datatype_size * member_data->current_count)/(group->set_size - 1);
-         int remainder = (member_data->datatype_size * member_data->current_count)%(group->set_size - 1);
-
-         if(remainder != 0) remainder++;
-         
-         void* data_buf = mentry->data[mentry->current_head];
-         //store parity info after my data in data region.
-         //we always have a spare data buffer byte for rounding stuff, so store after that as well.
-         void* parity_buf = (void*)((char*)data_buf + member_data->datatype_size*member_data->current_count + 2);
-         
+   if(request->pipeline != NULL){
+      //Chunks are unpacked as they arrive, nothing left to do once it's done.
+      flag = __imr_raid1_pipeline_progress(request->pipeline, blocking);
+      result = flag < 0 ? MPI_ERR_OTHER : MPI_SUCCESS;
+   } else if(blocking){
+      result = MPI_Waitall(request->num_requests, request->requests, MPI_STATUSES_IGNORE);
+   } else {
+      result = MPI_Testall(request->num_requests, request->requests, &flag, MPI_STATUSES_IGNORE);
+   }
+
+   if(result != MPI_SUCCESS){
+      //Most likely a failure mid-store, there is nothing useful left to do with the request.
+      debug_print("ERROR Fenix_Data_member_istore: communication for member_id <%d> failed on rank <%d>\n",
+            request->memberid, group->base.current_rank);
+      request->error = 1;
+      flag = 1;
+   } else if(flag){
+      fenix_imr_mentry_t* mentry;
+      __imr_find_mentry(group, request->memberid, &mentry);
+      int member_data_index = __fenix_search_memberid(group->base.member, request->memberid);
+      fenix_member_entry_t* member_data = &(group->base.member->member_entry[member_data_index]);
+      void* data_buf = mentry->data[__imr_slot(group, mentry, mentry->current_head)];
+
+      if(request->delta != NULL){
+         __imr_raid5_finish_delta(group, request->delta,
+               (char*)data_buf + member_data->datatype_size*member_data->current_count + 2);
+      } else if(group->raid_mode == 5 && request->parity_update != NULL){
          int my_set_rank;
          MPI_Comm_rank(group->set_comm, &my_set_rank);
-         int offset = 0, rounding_compensator;
-         for(int i = 0; i < group->set_size; i++){
-            //Last node is an edge case.
-            if((my_set_rank == group->set_size-1) && i==my_set_rank){
-              offset = 0;
-            }
+         __imr_raid5_apply_update(request->parity_update,
+               (char*)data_buf + member_data->datatype_size*member_data->current_count + 2, my_set_rank);
+      } else if(group->raid_mode == 5){
+         int parity_size, remainder, my_set_rank;
+         __imr_raid5_stripe(group, member_data->datatype_size * member_data->current_count,
+               &parity_size, &remainder);
+         MPI_Comm_rank(group->set_comm, &my_set_rank);
+         void* parity_buf = (void*)((char*)data_buf + member_data->datatype_size*member_data->current_count + 2);
+         int offset = __imr_raid5_noise_offset(group, my_set_rank, parity_size, remainder);
 
-            MPI_Reduce((void*)((char*)data_buf) + offset, parity_buf, parity_size + (i < remainder ? 1 : 0), MPI_BYTE,
-                MPI_BXOR, i, group->set_comm);
-            if(i != my_set_rank){
-               offset += parity_size + (i < remainder ? 1 : 0);
-            }
-         }
+         __fenix_xor_region((void*)((char*)data_buf + offset), parity_buf, parity_size + (my_set_rank < remainder ? 1 : 0));
+      }
 
-         //Each node has buffer which contains parity^some_local_data, so now pull parity from that.
-         offset = my_set_rank * parity_size + (my_set_rank < remainder ? my_set_rank : remainder);
-         
-         //As above, last node is an edge case.
-         if(my_set_rank == group->set_size - 1){
-            offset = 0;
-         }
+      __fenix_data_subset_merge_inplace(mentry->data_regions + __imr_slot(group, mentry, mentry->current_head),
+            &(request->subset));
+   }
+
+   if(flag){
+      __fenix_arena_free(group->arena, request->send_buf);
+      free(request->recv_buf);
+      free(request->requests);
+      if(request->parity_update != NULL){
+         __imr_raid5_free_update(group, request->parity_update);
+         request->parity_update = NULL;
+      }
+      if(request->delta != NULL){
+         __imr_raid5_free_delta(group, request->delta);
+         request->delta = NULL;
+      }
+      if(request->pipeline != NULL){
+         __imr_raid1_free_pipeline(request->pipeline);
+         request->pipeline = NULL;
+      }
+      request->send_buf = NULL;
+      request->recv_buf = NULL;
+      request->requests = NULL;
+      request->base.completed = 1;
+   }
+
+   return flag;
+}
 
-         //Utilize MPI's local XOR function, assuming it is more optimized than a naive implementation would be.
-         MPI_Reduce_local((void*)((char*)data_buf + offset), parity_buf, parity_size + (my_set_rank < remainder ? 1 : 0),
-             MPI_BYTE, MPI_BXOR);
+//Anything which touches the staging snapshot needs all istores into it to be done.
+void __imr_complete_pending(fenix_imr_group_t* group){
+   for(fenix_imr_request_t* request = group->requests; request != NULL; request = request->next){
+      __imr_request_progress(group, request, 1);
+   }
+}
 
-         //Finally, each node has the right stuff.
+//Just the istores of one member, all that its staging snapshot depends on.
+void __imr_complete_member_pending(fenix_imr_group_t* group, int memberid){
+   for(fenix_imr_request_t* request = group->requests; request != NULL; request = request->next){
+      if(request->memberid == memberid){
+         __imr_request_progress(group, request, 1);
+      }
+   }
+}
 
+//Leaves at most max of the newest istores in flight, waiting on the older ones.
+void __imr_bound_pending(fenix_imr_group_t* group, int max){
+   int in_flight = 0;
+   for(fenix_imr_request_t* request = group->requests; request != NULL; request = request->next){
+      if(request->base.completed) continue;
+      if(in_flight < max){
+         in_flight++;
       } else {
-         debug_print("ERROR Fenix_Data_member_store: Raid mode <%d> is not supported yet!\n",
-                   group->raid_mode);
-         retval = FENIX_ERROR_UNINITIALIZED; 
+         __imr_request_progress(group, request, 1);
       }
+   }
+}
 
-      //Make sure to update which data regions this entry contains.
-      __fenix_data_subset_merge_inplace(mentry->data_regions + mentry->current_head, &subset_specifier);
-      
+int __imr_progress(fenix_group_t* g){
+   fenix_imr_group_t* group = (fenix_imr_group_t*)g;
+   int in_flight = 0;
+   for(fenix_imr_request_t* request = group->requests; request != NULL; request = request->next){
+      if(!__imr_request_progress(group, request, 0)) in_flight++;
    }
+   return in_flight;
+}
 
+void __imr_request_free(fenix_imr_group_t* group, fenix_imr_request_t* request){
+   fenix_imr_request_t** link = &(group->requests);
+   while(*link != NULL && *link != request){
+      link = &((*link)->next);
+   }
+   if(*link != NULL){
+      *link = request->next;
+   }
 
-   return retval;
+   __fenix_data_subset_free(&(request->subset));
+   free(request);
 }
 
+int __imr_request_wait(fenix_group_t* g, fenix_data_request_t* r){
+   fenix_imr_group_t* group = (fenix_imr_group_t*)g;
+   fenix_imr_request_t* request = (fenix_imr_request_t*)r;
 
+   __imr_request_progress(group, request, 1);
+   int retval = request->error ? FENIX_ERROR_DATA_WAIT : FENIX_SUCCESS;
 
+   __imr_request_free(group, request);
+   return retval;
+}
 
+int __imr_request_test(fenix_group_t* g, fenix_data_request_t* r, int* flag){
+   fenix_imr_group_t* group = (fenix_imr_group_t*)g;
+   fenix_imr_request_t* request = (fenix_imr_request_t*)r;
 
-int __imr_member_storev(fenix_group_t* group, int member_id, 
-        Fenix_Data_subset subset_specifier){return 0;}
-int __imr_member_istore(fenix_group_t* group, int member_id, 
-        Fenix_Data_subset subset_specifier, Fenix_Request *request){return 0;}
-int __imr_member_istorev(fenix_group_t* group, int member_id, 
-           Fenix_Data_subset subset_specifier, Fenix_Request *request){return 0;}
+   *flag = __imr_request_progress(group, request, 0);
+   return request->error ? FENIX_ERROR_DATA_WAIT : FENIX_SUCCESS;
+}
 
 
 
@@ -505,47 +2928,56 @@ int __imr_commit(fenix_group_t* g){
    
    fenix_imr_group_t *group = (fenix_imr_group_t*)g;
 
+   __imr_complete_pending(group);
+   __imr_rma_commit(group);
+
    //For each entry id (eid)
    for(int eid = 0; eid < group->entries_count; eid++){ 
       fenix_imr_mentry_t *mentry = &group->entries[eid];
 
       //Two cases for each member entry: 
-      //    (1) depth has been reached, shift out the oldest commit 
+      //    (1) depth has been reached, the oldest commit's slot is recycled
       //    (2) depth has not been reached, just commit and start filling a new location.
       if(mentry->current_head == group->base.depth + 1){
-         //The entry is full, one snapshot should be shifted out.
-         
-         //Save this pointer to reuse the allocated memory
-         void* first_data = mentry->data[0];
-         
-         for(int snapshot = 0; snapshot < group->base.depth + 1; snapshot++){
-            //lightweight movement, just moving the pointers about.
-            mentry->data[snapshot] = mentry->data[snapshot + 1];
-            __fenix_data_subset_deep_copy(mentry->data_regions + snapshot + 1,
-                     mentry->data_regions + snapshot);
-            mentry->timestamp[snapshot] = mentry->timestamp[snapshot + 1];
-         }
-
-         mentry->data[group->base.depth + 1] = first_data;
-         mentry->data_regions[group->base.depth + 1].specifier = __FENIX_SUBSET_EMPTY;
-         mentry->timestamp[group->base.depth + 1] = mentry->timestamp[group->base.depth] + 1;
-      
+         //The ring is full, drop the oldest snapshot. Its slot comes around as
+         //the new staging area, nothing needs to move.
+         mentry->oldest = __imr_slot(group, mentry, 1);
       } else {
          //The entry is not full, just shift the current head.
          mentry->current_head++;
-
-         //Everything is initialized to correct values, we just need to provide
-         //the correct timestamp for the next snapshot.
-         mentry->timestamp[mentry->current_head] = mentry->timestamp[mentry->current_head-1] + 1;
           
          if(eid == 0){
             //Only do this once
             group->num_snapshots++;
          }
       }
+
+      //Reset the staging area and give it the timestamp for the next snapshot.
+      __imr_unspill_staging(group, mentry);
+      int head = __imr_slot(group, mentry, mentry->current_head);
+      mentry->data_regions[head].specifier = __FENIX_SUBSET_EMPTY;
+      mentry->parity_full[head] = 0;
+      mentry->partner_size[head] = 0;
+      mentry->timestamp[head] = mentry->timestamp[__imr_slot(group, mentry, mentry->current_head - 1)] + 1;
+
+      if(mentry->snapshot_storage == FENIX_DATA_SNAPSHOT_STORAGE_INCREMENTAL){
+         __imr_compact_snapshots(group, mentry);
+      }
+
+      //Hashes of a hashed full store now describe the newest snapshot.
+      if(mentry->staged_hashed){
+         uint64_t* hashes = mentry->hashes;
+         mentry->hashes = mentry->staged_hashes;
+         mentry->staged_hashes = hashes;
+      }
+      mentry->hashes_valid = mentry->staged_hashed;
+      mentry->staged_hashed = 0;
    }
 
-   group->base.timestamp = group->entries[0].timestamp[group->entries[0].current_head - 1];
+   __imr_enforce_budget(group);
+
+   fenix_imr_mentry_t* first = group->entries;
+   group->base.timestamp = first->timestamp[__imr_slot(group, first, first->current_head - 1)];
 
    return to_return;
 }
@@ -556,31 +2988,66 @@ int __imr_snapshot_delete(fenix_group_t* g, int time_stamp){
 
    fenix_imr_group_t *group = (fenix_imr_group_t*)g;
 
+   __imr_complete_pending(group);
+   __imr_rma_flush(group);
+
    for(int entry_id = 0; entry_id < group->entries_count && retval == FENIX_SUCCESS; entry_id++){
       //Search for the timestamp in each group. Given how commits and deletes work, we know
       //the snapshots are sorted by timestamp in the arrays.
-      fenix_imr_mentry_t mentry = group->entries[entry_id];
+      fenix_imr_mentry_t* mentry = &group->entries[entry_id];
 
       //current_head is the staging area's entry, so start before that and work backwards.
       //We'll work backwards under the assumption that snapshots are likely to be deleted soon after creation.
       //  (Does this assumption seem valid?)
-      for(int snapshot = mentry.current_head - 1; snapshot >= 0 && retval == FENIX_SUCCESS; snapshot--){
-         if(mentry.timestamp[snapshot] < time_stamp){
+      for(int snapshot = mentry->current_head - 1; snapshot >= 0 && retval == FENIX_SUCCESS; snapshot--){
+         int slot = __imr_slot(group, mentry, snapshot);
+         if(mentry->timestamp[slot] < time_stamp){
             retval = FENIX_ERROR_INVALID_TIMESTAMP;
 
-         } else if(mentry.timestamp[snapshot] == time_stamp){
-            void* old_data = mentry.data[snapshot];
-
-            for(int to_shift = snapshot; to_shift < mentry.current_head; to_shift++){
-               mentry.timestamp[to_shift] = mentry.timestamp[to_shift + 1];
-               __fenix_data_subset_deep_copy(mentry.data_regions + to_shift+1,
-                     mentry.data_regions + to_shift);
-               mentry.data[to_shift] = mentry.data[to_shift + 1];
+         } else if(mentry->timestamp[slot] == time_stamp){
+            __imr_detach_snapshot(group, mentry, snapshot);
+            mentry->hashes_valid = 0;
+            mentry->staged_hashed = 0;
+            //Only once detached does the slot hold just what it still owns, its
+            //whole copy may have gone to the older snapshot.
+            void* old_data = mentry->data[slot];
+            int old_spilled = mentry->spilled[slot];
+            void** old_chunks = mentry->chunks[slot];
+            Fenix_Data_subset old_regions = mentry->data_regions[slot];
+
+            if(snapshot == 0){
+               //Oldest snapshot, just advance past it.
+               mentry->oldest = __imr_slot(group, mentry, 1);
+            } else {
+               //Move newer snapshots (and the staging area) down a position. Subsets
+               //are moved along with their slot rather than copied.
+               for(int to_shift = snapshot; to_shift < mentry->current_head; to_shift++){
+                  int to = __imr_slot(group, mentry, to_shift);
+                  int from = __imr_slot(group, mentry, to_shift + 1);
+                  mentry->timestamp[to] = mentry->timestamp[from];
+                  mentry->data_regions[to] = mentry->data_regions[from];
+                  mentry->data[to] = mentry->data[from];
+                  mentry->spilled[to] = mentry->spilled[from];
+                  mentry->chunks[to] = mentry->chunks[from];
+                  mentry->parity_full[to] = mentry->parity_full[from];
+                  mentry->partner_size[to] = mentry->partner_size[from];
+               }
+               //The deleted snapshot's slot comes around at the end of the ring.
+               slot = __imr_slot(group, mentry, mentry->current_head);
+               mentry->data[slot] = old_data;
+               mentry->spilled[slot] = old_spilled;
+               mentry->chunks[slot] = old_chunks;
+               mentry->data_regions[slot] = old_regions;
             }
-            mentry.data[mentry.current_head] = old_data;
-            mentry.data_regions[mentry.current_head].specifier = __FENIX_SUBSET_EMPTY;
-
-            mentry.current_head--;
+            mentry->data_regions[slot].specifier = __FENIX_SUBSET_EMPTY;
+            mentry->parity_full[slot] = 0;
+            mentry->partner_size[slot] = 0;
+
+            mentry->current_head--;
+            //The deleted snapshot's region may have come around as the staging area.
+            __imr_unspill_staging(group, mentry);
+            //Regions changed slots, partners trade addresses again.
+            mentry->rma_ready = 0;
             break;
          }
       }
@@ -615,7 +3082,8 @@ int __imr_get_snapshot_at_position(fenix_group_t* g, int position,
       //Each member ought to have the same snapshots, in the same order.
       //If this isn't true, some other bug has occured. Thus, we will just
       //query the first member.
-      *time_stamp = group->entries[0].timestamp[group->entries[0].current_head - 1 - position];
+      fenix_imr_mentry_t* first = group->entries;
+      *time_stamp = first->timestamp[__imr_slot(group, first, first->current_head - 1 - position)];
       retval = FENIX_SUCCESS;
    } 
 
@@ -628,14 +3096,34 @@ int __imr_member_restore(fenix_group_t* g, int member_id,
    int retval = -1;
 
    fenix_imr_group_t* group = (fenix_imr_group_t*)g;
+
+   __imr_complete_pending(group);
+   __imr_rma_flush(group);
    
    fenix_imr_mentry_t* mentry;
    //find_mentry returns the error status. We found the member (and corresponding data) if there are no errors.
    int found_member = !(__imr_find_mentry(group, member_id, &mentry));
+   if(found_member){
+      __imr_unwrap_ring(group, mentry);
+      //Recovery works on whole snapshots, the next commit compacts them again.
+      __imr_expand_snapshots(group, mentry);
+      //The partner may have rebuilt its copies, start the hashes over.
+      mentry->hashes_valid = 0;
+      mentry->staged_hashed = 0;
+      //Same for where they are.
+      mentry->rma_ready = 0;
+   }
 
    int member_data_index = __fenix_search_memberid(group->base.member, member_id);
    fenix_member_entry_t member_data = group->base.member->member_entry[member_data_index];
 
+   if(found_member){
+      //Partner copies are exchanged and rebuilt as plain data.
+      for(int slot = 0; slot < group->base.depth + 2; slot++){
+         __imr_inflate_partner(group, mentry, slot, member_data.datatype_size*member_data.current_count);
+      }
+   }
+
    int recovery_locally_possible;
 
    if(group->raid_mode == 1){
@@ -678,22 +3166,24 @@ int __imr_member_restore(fenix_group_t* g, int member_id,
             __fenix_data_subset_send(mentry->data_regions + snapshot, group->partners[0], 
                   __IMR_RECOVER_DATA_REGION_TAG ^ group->base.groupid, group->base.comm);
             
+            if(__fenix_data_subset_data_size(mentry->data_regions + snapshot,
+                  member_data.current_count) == 0){
+               continue;
+            }
+
+            //Both halves go out in place through the subset's datatype.
+            MPI_Datatype region_type;
+            __fenix_data_subset_get_type(mentry->data_regions + snapshot, member_data.datatype_size,
+                  member_data.current_count, &region_type);
+
             //send my data, to maintain resiliency on my data
-            size_t size;
-            void* toSend = __fenix_data_subset_serialize(mentry->data_regions+snapshot, 
-                  mentry->data[snapshot], member_data.datatype_size, member_data.current_count, 
-                  &size);
-            MPI_Send(toSend, member_data.datatype_size*size, MPI_BYTE, group->partners[0], 
+            MPI_Send(mentry->data[snapshot], 1, region_type, group->partners[0], 
                   RECOVER_MEMBER_ENTRY_TAG^group->base.groupid, group->base.comm);
             
             //send their data
-            toSend = __fenix_data_subset_serialize(mentry->data_regions+snapshot, 
-                  ((char*)mentry->data[snapshot]) + member_data.datatype_size*member_data.current_count,
-                  member_data.datatype_size, member_data.current_count, &size);
-            MPI_Send(toSend, member_data.datatype_size*size, MPI_BYTE, group->partners[0], 
+            MPI_Send(((char*)mentry->data[snapshot]) + member_data.datatype_size*member_data.current_count,
+                  1, region_type, group->partners[0], 
                   RECOVER_MEMBER_ENTRY_TAG^group->base.groupid, group->base.comm);
-            
-            free(toSend);
          }
 
       } else if(!found_member && partner_data_found) {
@@ -729,21 +3219,18 @@ int __imr_member_restore(fenix_group_t* g, int member_id,
                   member_data.current_count);
             
             if(recv_size > 0){
-               void* recv_buf = malloc(member_data.datatype_size * recv_size);
-               //first recieve their data, so store in the resiliency section.
-               MPI_Recv(recv_buf, recv_size*member_data.datatype_size, MPI_BYTE, group->partners[1],
-                     RECOVER_MEMBER_ENTRY_TAG^group->base.groupid, group->base.comm, NULL);
-               __fenix_data_subset_deserialize(mentry->data_regions + snapshot, recv_buf,
-                        ((char*)mentry->data[snapshot]) + member_data.current_count*member_data.datatype_size,
-                        member_data.current_count, member_data.datatype_size);
+               MPI_Datatype region_type;
+               __fenix_data_subset_get_type(mentry->data_regions + snapshot, member_data.datatype_size,
+                     member_data.current_count, &region_type);
 
                //first recieve their data, so store in the resiliency section.
-               MPI_Recv(recv_buf, recv_size*member_data.datatype_size, MPI_BYTE, group->partners[1],
+               MPI_Recv(((char*)mentry->data[snapshot]) + member_data.current_count*member_data.datatype_size,
+                     1, region_type, group->partners[1],
                      RECOVER_MEMBER_ENTRY_TAG^group->base.groupid, group->base.comm, NULL);
-               __fenix_data_subset_deserialize(mentry->data_regions + snapshot, recv_buf,
-                        mentry->data[snapshot], member_data.current_count, member_data.datatype_size);
 
-               free(recv_buf);
+               //then my own data, back into its usual place.
+               MPI_Recv(mentry->data[snapshot], 1, region_type, group->partners[1],
+                     RECOVER_MEMBER_ENTRY_TAG^group->base.groupid, group->base.comm, NULL);
             }
          }
       }
@@ -778,7 +3265,7 @@ int __imr_member_restore(fenix_group_t* g, int member_id,
         MPI_Comm_rank(group->set_comm, &my_set_rank);
 
         //The recovering node needs metadata on this member, just needs it from one partner.
-        if((recovering_node == 0 && my_set_rank == 1) || my_set_rank == 0){
+        if((recovering_node == 0 && my_set_rank == 1) || (recovering_node != 0 && my_set_rank == 0)){
            //I'm the node that's going to send metadata
            
            //This function pulls comm from the base group - so we need to give 
@@ -793,6 +3280,10 @@ int __imr_member_restore(fenix_group_t* g, int member_id,
            //They also need the timestamps for each snapshot, as well as the value for the next.
            MPI_Send((void*)mentry->timestamp, group->num_snapshots+1, MPI_INT, recovering_node,
                  RECOVER_MEMBER_ENTRY_TAG^group->base.groupid, group->set_comm);
+
+           //Every rank in the set has to agree on how parity gets updated.
+           MPI_Send((void*)&(mentry->update_mode), 1, MPI_INT, recovering_node,
+                 RECOVER_MEMBER_ENTRY_TAG^group->base.groupid, group->set_comm);
           
            for(int snapshot = 0; snapshot < group->num_snapshots; snapshot++){
               __fenix_data_subset_send(mentry->data_regions + snapshot, recovering_node, 
@@ -822,6 +3313,9 @@ int __imr_member_restore(fenix_group_t* g, int member_id,
            MPI_Recv((void*)(mentry->timestamp), group->num_snapshots + 1, MPI_INT, (my_set_rank==0 ? 1 : 0),
                  RECOVER_MEMBER_ENTRY_TAG^group->base.groupid, group->set_comm, NULL);
 
+           MPI_Recv((void*)&(mentry->update_mode), 1, MPI_INT, (my_set_rank==0 ? 1 : 0),
+                 RECOVER_MEMBER_ENTRY_TAG^group->base.groupid, group->set_comm, NULL);
+
            for(int snapshot = 0; snapshot < group->num_snapshots; snapshot++){
               __fenix_data_subset_free(mentry->data_regions+snapshot);
               __fenix_data_subset_recv(mentry->data_regions+snapshot, (my_set_rank==0 ? 1 : 0),
@@ -860,13 +3354,12 @@ int __imr_member_restore(fenix_group_t* g, int member_id,
                 
                void* recv_buf = (i == my_set_rank ? parity_buf : (void*)((char*)data_buf + offset));
 
-               MPI_Reduce(toSend, recv_buf, parity_size + (1<remainder? 1:0), MPI_BYTE, MPI_BXOR, 
+               MPI_Reduce(toSend, recv_buf, parity_size + (i<remainder? 1:0), MPI_BYTE, fenix.xor_op, 
                    recovering_node, group->set_comm);
 
                if(my_set_rank == recovering_node){
                   //Remove the random data I had to send from the result.
-                  MPI_Reduce_local(toSend, recv_buf, parity_size + (i<remainder? 1:0),
-                      MPI_BYTE, MPI_BXOR);
+                  __fenix_xor_region(toSend, recv_buf, parity_size + (i<remainder? 1:0));
                }
                
                if(i != my_set_rank){
@@ -874,6 +3367,9 @@ int __imr_member_restore(fenix_group_t* g, int member_id,
                }
             }
 
+            //The rebuilt data is whatever makes the parity work out, so the parity
+            //now covers the whole snapshot on every rank.
+            mentry->parity_full[snapshot] = 1;
          }
 
          retval = FENIX_SUCCESS;
@@ -891,6 +3387,87 @@ int __imr_member_restore(fenix_group_t* g, int member_id,
 
 
 
+   } else if (group->raid_mode == 6){
+      int* set_results = malloc(sizeof(int) * group->set_size);
+      MPI_Allgather((void*)&found_member, 1, MPI_INT, (void*)set_results, 1, MPI_INT, 
+          group->set_comm);
+
+      //Up to two lost ranks can be rebuilt, metadata comes from the first survivor.
+      int lost[2], num_lost = 0, sender = -1;
+      for(int i = 0; i < group->set_size; i++){
+        if(!set_results[i]){
+          if(num_lost < 2) lost[num_lost] = i;
+          num_lost++;
+        } else if(sender == -1){
+          sender = i;
+        }
+      }
+
+      free(set_results);
+
+      if(num_lost > 0 && num_lost <= 2 && sender != -1){
+        int my_set_rank;
+        MPI_Comm_rank(group->set_comm, &my_set_rank);
+
+        if(my_set_rank == sender){
+          for(int i = 0; i < num_lost; i++){
+            __fenix_data_member_send_metadata(group->base.groupid, member_id, group->partners[lost[i]]);
+
+            MPI_Send((void*) &(group->num_snapshots), 1, MPI_INT, lost[i], 
+                  RECOVER_MEMBER_ENTRY_TAG^group->base.groupid, group->set_comm);
+            MPI_Send((void*)mentry->timestamp, group->num_snapshots+1, MPI_INT, lost[i],
+                  RECOVER_MEMBER_ENTRY_TAG^group->base.groupid, group->set_comm);
+
+            for(int snapshot = 0; snapshot < group->num_snapshots; snapshot++){
+              __fenix_data_subset_send(mentry->data_regions + snapshot, lost[i], 
+                    __IMR_RECOVER_DATA_REGION_TAG ^ group->base.groupid, group->set_comm);
+            }
+          }
+
+        } else if(!found_member){
+          //Remake the member just like the user would, then fill in its entries.
+          fenix_member_entry_packet_t packet;
+          __fenix_data_member_recv_metadata(group->base.groupid, group->partners[sender], &packet);
+          __fenix_member_create(group->base.groupid, packet.memberid, NULL, packet.current_count,
+                packet.current_datatype);
+
+          __imr_find_mentry(group, member_id, &mentry);
+          int member_data_index = __fenix_search_memberid(group->base.member, member_id);
+          member_data = group->base.member->member_entry[member_data_index];
+
+          MPI_Recv((void*)&(group->num_snapshots), 1, MPI_INT, sender,
+                RECOVER_MEMBER_ENTRY_TAG^group->base.groupid, group->set_comm, NULL);
+
+          mentry->current_head = group->num_snapshots;
+
+          MPI_Recv((void*)(mentry->timestamp), group->num_snapshots + 1, MPI_INT, sender,
+                RECOVER_MEMBER_ENTRY_TAG^group->base.groupid, group->set_comm, NULL);
+
+          for(int snapshot = 0; snapshot < group->num_snapshots; snapshot++){
+            __fenix_data_subset_free(mentry->data_regions+snapshot);
+            __fenix_data_subset_recv(mentry->data_regions+snapshot, sender,
+                  __IMR_RECOVER_DATA_REGION_TAG ^ group->base.groupid, group->set_comm);
+          }
+        }
+
+        for(int snapshot = 0; snapshot < group->num_snapshots; snapshot++){
+          __imr_raid6_rebuild(group, mentry->data[snapshot], 
+                member_data.datatype_size*member_data.current_count, lost, num_lost);
+        }
+
+        retval = FENIX_SUCCESS;
+        recovery_locally_possible = 1;
+      } else if(!found_member){
+         debug_print("ERROR Fenix_Data_member_restore: member_id <%d> does not exist at <%d> and is not recoverable from RAID-6 set\n",
+               member_id, group->base.current_rank);
+         
+         retval = FENIX_ERROR_INVALID_MEMBERID;
+         recovery_locally_possible = 0;      
+      } else {
+         retval = FENIX_SUCCESS;
+         recovery_locally_possible = 1;
+      }
+
    } else {
       debug_print("ERROR Fenix_Data_member_store: Raid mode <%d> is not supported yet!\n",
                 group->raid_mode);
@@ -951,6 +3528,7 @@ int __imr_member_restore(fenix_group_t* g, int member_id,
 
    //Dont forget to clear the commit buffer
    mentry->data_regions[mentry->current_head].specifier = __FENIX_SUBSET_EMPTY;
+   mentry->parity_full[mentry->current_head] = 0;
 
 
    return retval;
@@ -962,25 +3540,208 @@ int __imr_member_restore_from_rank(fenix_group_t* group, int member_id,
         int source_rank){return 0;}
 
 
-int __imr_member_get_attribute(fenix_group_t* group, fenix_member_entry_t* member, 
-        int attributename, void* attributevalue, int* flag, int sourcerank){return 0;}
+int __imr_member_get_attribute(fenix_group_t* g, fenix_member_entry_t* member, 
+        int attributename, void* attributevalue, int* flag, int sourcerank){
+  fenix_imr_group_t* group = (fenix_imr_group_t*)g;
+  fenix_imr_mentry_t* mentry;
+  int retval = FENIX_SUCCESS;
+
+  if(__imr_find_mentry(group, member->memberid, &mentry) != FENIX_SUCCESS){
+    retval = FENIX_ERROR_INVALID_MEMBERID;
+  } else if(attributename == FENIX_DATA_MEMBER_ATTRIBUTE_PARITY_UPDATE){
+    *((int*)attributevalue) = mentry->update_mode;
+  } else if(attributename == FENIX_DATA_MEMBER_ATTRIBUTE_CHUNK_SIZE){
+    *((int*)attributevalue) = mentry->chunk_size;
+  } else if(attributename == FENIX_DATA_MEMBER_ATTRIBUTE_SNAPSHOT_STORAGE){
+    *((int*)attributevalue) = mentry->snapshot_storage;
+  } else if(attributename == FENIX_DATA_MEMBER_ATTRIBUTE_CONTENT_HASH){
+    *((int*)attributevalue) = mentry->content_hash;
+  } else if(attributename == FENIX_DATA_MEMBER_ATTRIBUTE_SKIPPED_BYTES){
+    *((size_t*)attributevalue) = mentry->skipped_bytes;
+  } else if(attributename == FENIX_DATA_MEMBER_ATTRIBUTE_COMPRESSION){
+    *((int*)attributevalue) = mentry->compression;
+  } else if(attributename == FENIX_DATA_MEMBER_ATTRIBUTE_NUMA_NODE){
+    //Where the newest snapshot's partner copy or parity ended up.
+    int member_data_index = __fenix_search_memberid(group->base.member, member->memberid);
+    fenix_member_entry_t* member_data = &(group->base.member->member_entry[member_data_index]);
+    int local_data_size = member_data->datatype_size * member_data->current_count;
+    size_t offset = local_data_size;
+    if(group->raid_mode == 5){
+      offset += 2;
+    } else if(group->raid_mode == 6){
+      offset = (size_t)(group->set_size-2) * __imr_raid6_chunk_size(local_data_size, group->set_size);
+    }
+    int newest = mentry->current_head > 0 ? mentry->current_head - 1 : 0;
+    *((int*)attributevalue) = __fenix_numa_node_of(
+          (char*)mentry->data[__imr_slot(group, mentry, newest)] + offset);
+  } else {
+    retval = FENIX_ERROR_INVALID_ATTRIBUTE_NAME;
+  }
+
+  return retval;
+}
 
 int __imr_member_set_attribute(fenix_group_t* g, fenix_member_entry_t* member, 
            int attributename, void* attributevalue, int* flag){ 
-  //No mutable attributes (as of now) require any changes to this policy's info
-  return FENIX_SUCCESS;
+  fenix_imr_group_t* group = (fenix_imr_group_t*)g;
+  int retval = FENIX_SUCCESS;
+
+  if(attributename == FENIX_DATA_MEMBER_ATTRIBUTE_PARITY_UPDATE){
+    int mode = *((int*)attributevalue);
+    fenix_imr_mentry_t* mentry;
+
+    if(__imr_find_mentry(group, member->memberid, &mentry) != FENIX_SUCCESS){
+      retval = FENIX_ERROR_INVALID_MEMBERID;
+    } else if(mode == FENIX_DATA_PARITY_UPDATE_REDUCE
+          || (mode == FENIX_DATA_PARITY_UPDATE_DELTA && group->raid_mode == 5)){
+      //Every rank in the set must pick the same mode.
+      __imr_complete_pending(group);
+      mentry->update_mode = mode;
+      group->layout_version++;
+    } else {
+      debug_print("ERROR Fenix_Data_member_attr_set: parity update mode <%d> is not valid for raid mode <%d>\n",
+            mode, group->raid_mode);
+      retval = FENIX_ERROR_INVALID_ATTRIBUTE_VALUE;
+    }
+  } else if(attributename == FENIX_DATA_MEMBER_ATTRIBUTE_CHUNK_SIZE){
+    int chunk_size = *((int*)attributevalue);
+    fenix_imr_mentry_t* mentry;
+
+    if(__imr_find_mentry(group, member->memberid, &mentry) != FENIX_SUCCESS){
+      retval = FENIX_ERROR_INVALID_MEMBERID;
+    } else {
+      //Partners must agree on the chunking, and on which members coalesce,
+      //so every rank sets the same size. Check that they did, a mismatch
+      //would otherwise show up as truncated receives or a hang mid-store.
+      __imr_complete_pending(group);
+      int sizes[2] = {chunk_size, -chunk_size};
+      MPI_Allreduce(MPI_IN_PLACE, sizes, 2, MPI_INT, MPI_MAX, group->base.comm);
+      if(sizes[0] != -sizes[1]){
+        debug_print("ERROR Fenix_Data_member_attr_set: chunk size <%d> differs from other ranks' (%d to %d)\n",
+              chunk_size, -sizes[1], sizes[0]);
+        retval = FENIX_ERROR_INVALID_ATTRIBUTE_VALUE;
+      } else if(chunk_size <= 0){
+        debug_print("ERROR Fenix_Data_member_attr_set: chunk size <%d> must be positive\n",
+              chunk_size);
+        retval = FENIX_ERROR_INVALID_ATTRIBUTE_VALUE;
+      } else {
+        mentry->chunk_size = chunk_size;
+        group->layout_version++;
+      }
+    }
+  } else if(attributename == FENIX_DATA_MEMBER_ATTRIBUTE_CONTENT_HASH){
+    int content_hash = *((int*)attributevalue);
+    fenix_imr_mentry_t* mentry;
+
+    if(__imr_find_mentry(group, member->memberid, &mentry) != FENIX_SUCCESS){
+      retval = FENIX_ERROR_INVALID_MEMBERID;
+    } else if(group->raid_mode == 1){
+      //Partners swap change lists, so every rank must pick the same.
+      __imr_complete_pending(group);
+      mentry->content_hash = content_hash != 0;
+      mentry->hashes_valid = 0;
+      mentry->staged_hashed = 0;
+      group->layout_version++;
+    } else {
+      debug_print("ERROR Fenix_Data_member_attr_set: content hashing is not valid for raid mode <%d>\n",
+            group->raid_mode);
+      retval = FENIX_ERROR_INVALID_ATTRIBUTE_VALUE;
+    }
+  } else if(attributename == FENIX_DATA_MEMBER_ATTRIBUTE_NUMA_NODE){
+    //Read only.
+    retval = FENIX_ERROR_INVALID_ATTRIBUTE_NAME;
+  } else if(attributename == FENIX_DATA_MEMBER_ATTRIBUTE_COMPRESSION){
+    int compression = *((int*)attributevalue);
+    fenix_imr_mentry_t* mentry;
+
+    if(__imr_find_mentry(group, member->memberid, &mentry) != FENIX_SUCCESS){
+      retval = FENIX_ERROR_INVALID_MEMBERID;
+    } else if(group->raid_mode == 1 && (compression == FENIX_DATA_COMPRESSION_NONE
+          || compression == FENIX_DATA_COMPRESSION_SHUFFLE_LZ)){
+      //Partners swap compressed sizes, so every rank must pick the same.
+      __imr_complete_pending(group);
+      mentry->compression = compression;
+      group->layout_version++;
+    } else {
+      debug_print("ERROR Fenix_Data_member_attr_set: compression <%d> is not valid for raid mode <%d>\n",
+            compression, group->raid_mode);
+      retval = FENIX_ERROR_INVALID_ATTRIBUTE_VALUE;
+    }
+  } else if(attributename == FENIX_DATA_MEMBER_ATTRIBUTE_SKIPPED_BYTES){
+    fenix_imr_mentry_t* mentry;
+
+    if(__imr_find_mentry(group, member->memberid, &mentry) != FENIX_SUCCESS){
+      retval = FENIX_ERROR_INVALID_MEMBERID;
+    } else {
+      //Usually to zero it before measuring.
+      mentry->skipped_bytes = *((size_t*)attributevalue);
+    }
+  } else if(attributename == FENIX_DATA_MEMBER_ATTRIBUTE_SNAPSHOT_STORAGE){
+    int storage = *((int*)attributevalue);
+    fenix_imr_mentry_t* mentry;
+
+    if(__imr_find_mentry(group, member->memberid, &mentry) != FENIX_SUCCESS){
+      retval = FENIX_ERROR_INVALID_MEMBERID;
+    } else if(storage == FENIX_DATA_SNAPSHOT_STORAGE_FULL){
+      //Storage is local, ranks need not agree on it.
+      __imr_complete_pending(group);
+      __imr_expand_snapshots(group, mentry);
+      mentry->snapshot_storage = storage;
+      //Regions moved, partners trade addresses on the next store.
+      mentry->rma_ready = 0;
+    } else if(storage == FENIX_DATA_SNAPSHOT_STORAGE_INCREMENTAL){
+      __imr_complete_pending(group);
+      __imr_compact_snapshots(group, mentry);
+      mentry->snapshot_storage = storage;
+    } else {
+      debug_print("ERROR Fenix_Data_member_attr_set: snapshot storage <%d> is not valid\n",
+            storage);
+      retval = FENIX_ERROR_INVALID_ATTRIBUTE_VALUE;
+    }
+  }
+
+  //Other mutable attributes (as of now) don't require any changes to this policy's info
+  return retval;
 }
 
 int __imr_reinit(fenix_group_t* g, int* flag){
   fenix_imr_group_t* group = (fenix_imr_group_t*)g;
 
-  if(group->raid_mode == 5){
+  //Stores interrupted by the failure will error out, they just need to be cleaned up.
+  __imr_complete_pending(group);
+
+  if(group->rank_separation == FENIX_DATA_RANK_SEPARATION_AUTO){
+    //Ranks that replaced failed ones are in __imr_place_partners too, and
+    //take over the failed ranks' partners from ours.
+    __imr_place_partners(group, g->comm, 1);
+  }
+
+  if(group->raid_mode == 5 || group->raid_mode == 6){
     //Rebuild the set comm to re-include the failed node(s).
     MPI_Group comm_group, set_group;
     MPI_Comm_group(g->comm, &comm_group);
     MPI_Group_incl(comm_group, group->set_size, group->partners, &set_group);
     MPI_Comm_create_group(g->comm, set_group, 0, &(group->set_comm));
   }
+  //Plans hold requests on the old comms.
+  group->layout_version++;
+
+  if(group->window != MPI_WIN_NULL){
+    //The old window spans the failed ranks and can't be freed collectively.
+    //Detaching is local, so only the window's handle is left behind, one per
+    //repair; commit notices on the old comm are dropped with it. Everything
+    //is exposed again in a new window on the new comm.
+    __fenix_arena_watch(group->arena, NULL, NULL);
+    for(int i = 0; i < group->num_attached; i++){
+      MPI_Win_detach(group->window, group->attached_bases[i]);
+    }
+    free(group->attached_bases);
+    free(group->attached_sizes);
+    __imr_rma_open(group, g->comm);
+    for(int eid = 0; eid < group->entries_count; eid++){
+      group->entries[eid].rma_ready = 0;
+    }
+  }
 
   *flag = FENIX_SUCCESS;
 
@@ -996,6 +3757,9 @@ int __imr_get_redundant_policy(fenix_group_t* group, int* policy_name,
    int* policy_vals = (int*) policy_value;
    policy_vals[0] = full_group->raid_mode;
    policy_vals[1] = full_group->rank_separation;
+   if(full_group->raid_mode == 5 || full_group->raid_mode == 6){
+      policy_vals[2] = full_group->set_size;
+   }
 
    *flag = FENIX_SUCCESS;
    return retval;   
@@ -1004,14 +3768,21 @@ int __imr_get_redundant_policy(fenix_group_t* group, int* policy_name,
 int __imr_group_delete(fenix_group_t* g){
    fenix_imr_group_t* group = (fenix_imr_group_t*) g;
 
+   __imr_complete_pending(group);
+   while(group->requests != NULL){
+     __imr_request_free(group, group->requests);
+   }
+
    for(int entry = 0; entry < group->base.member->count; entry++){
-     __imr_member_free(group->entries+entry, g->depth); 
+     __imr_member_free(group, group->entries+entry);
    }
    free(group->entries);
 
    //We have the responsibility of destroying the member array in the base group struct.
    __fenix_data_member_destroy(group->base.member);
    
+   __imr_rma_close(group);
+   __fenix_arena_destroy(group->arena);
    free(group->partners);
    free(group);
    return FENIX_SUCCESS;
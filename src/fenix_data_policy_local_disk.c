@@ -0,0 +1,1126 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//
+//            _|_|_|_|  _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//            _|        _|        _|_|    _|    _|      _|  _|
+//            _|_|_|    _|_|_|    _|  _|  _|    _|        _|
+//            _|        _|        _|    _|_|    _|      _|  _|
+//            _|        _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//
+//
+//
+//
+// Copyright (C) 2016 Rutgers University and Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author Marc Gamell, Eric Valenzuela, Keita Teranishi, Manish Parashar,
+//        Michael Heroux, and Matthew Whitlock
+//
+// Questions? Contact Keita Teranishi (knteran@sandia.gov) and
+//                    Marc Gamell (mgamell@cac.rutgers.edu)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#define _GNU_SOURCE
+#include <mpi.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "fenix.h"
+#include "fenix_opt.h"
+#include "fenix_util.h"
+#include "fenix_data_subset.h"
+#include "fenix_data_recovery.h"
+#include "fenix_data_policy.h"
+#include "fenix_data_group.h"
+#include "fenix_data_member.h"
+#include "fenix_ext.h"
+
+#define __FENIX_LD_DEFAULT_MENTRY_NUM 10
+#define __FENIX_LD_NO_MEMBERS 16000
+//O_DIRECT needs buffers, offsets and lengths aligned to the device's blocks.
+#define __FENIX_LD_ALIGNMENT 4096
+#define __FENIX_LD_MAGIC 0x464c4458
+#define __FENIX_LD_HEADER_INTS 4
+#define __FENIX_LD_FETCH_TAG 97856
+
+//Committed snapshots are kept on node-local disk, as files
+//<directory>/rank<rank>/g<groupid>_m<memberid>_t<timestamp>. A file is an int
+//header {magic, timestamp, datatype_size, count, subset...} then the member's
+//data laid out like the user's buffer, each padded to the alignment. Only the
+//subset's regions of the data are meaningful.
+//
+//Stores copy into a staging buffer, and commit hands the staging buffers to a
+//writer thread. It writes each under a temporary name and renames it once it
+//is on disk, so a file under its final name is always complete. A later job
+//whose group uses the same directory finds those files at member_create and
+//restores from them.
+
+typedef struct __fenix_ld_job{
+   char* path;
+   //NULL header means the job is removing the file at path.
+   void* header;
+   size_t header_size;
+   void* data;
+   size_t data_size;
+   struct __fenix_ld_job* next;
+} fenix_ld_job_t;
+
+//timestamp holds the snapshots on disk, oldest first.
+typedef struct __fenix_ld_mentry{
+   int memberid;
+   void* staging;
+   size_t staging_size;
+   Fenix_Data_subset staging_regions;
+   int* timestamp;
+   int num_snapshots;
+} fenix_ld_mentry_t;
+
+typedef struct __fenix_ld_group{
+   fenix_group_t base;
+   char* directory;
+   char* rank_directory;
+   int entries_size;
+   int entries_count;
+   fenix_ld_mentry_t* entries;
+   int next_timestamp;
+   //Everything below is shared with the writer thread, under lock.
+   pthread_t writer;
+   pthread_mutex_t lock;
+   pthread_cond_t work;
+   pthread_cond_t idle;
+   fenix_ld_job_t* jobs;
+   fenix_ld_job_t* last_job;
+   int in_flight;
+   int write_error;
+   int shutdown;
+} fenix_ld_group_t;
+
+int __ld_group_delete(fenix_group_t* group);
+int __ld_member_create(fenix_group_t* group, fenix_member_entry_t* mentry);
+int __ld_member_delete(fenix_group_t* group, int member_id);
+int __ld_get_redundant_policy(fenix_group_t*, int* policy_name, 
+        void* policy_value, int* flag);
+int __ld_member_store(fenix_group_t* group, int member_id, 
+        Fenix_Data_subset subset_specifier);
+int __ld_member_storev(fenix_group_t* group, int member_id, 
+        Fenix_Data_subset subset_specifier);
+int __ld_member_istore(fenix_group_t* group, int member_id, 
+        Fenix_Data_subset subset_specifier, Fenix_Request *request);
+int __ld_member_istorev(fenix_group_t* group, int member_id, 
+        Fenix_Data_subset subset_specifier, Fenix_Request *request);
+int __ld_request_wait(fenix_group_t* group, fenix_data_request_t* request);
+int __ld_request_test(fenix_group_t* group, fenix_data_request_t* request, int* flag);
+int __ld_commit(fenix_group_t* group);
+int __ld_snapshot_delete(fenix_group_t* group, int time_stamp);
+int __ld_barrier(fenix_group_t* group);
+int __ld_member_restore(fenix_group_t* group, int member_id,
+        void* target_buffer, int max_count, int time_stamp,
+        Fenix_Data_subset* data_found);
+int __ld_member_restore_from_rank(fenix_group_t* group, int member_id,
+        void* target_buffer, int max_count, int time_stamp, 
+        int source_rank);
+int __ld_member_get_attribute(fenix_group_t* group, fenix_member_entry_t* member, 
+        int attributename, void* attributevalue, int* flag, int sourcerank);
+int __ld_member_set_attribute(fenix_group_t* group, fenix_member_entry_t* member, 
+        int attributename, void* attributevalue, int* flag);
+int __ld_get_number_of_snapshots(fenix_group_t* group, int* number_of_snapshots);
+int __ld_get_snapshot_at_position(fenix_group_t* group, int position, int* time_stamp);
+int __ld_reinit(fenix_group_t* group, int* flag);
+
+void* __ld_writer(void* arg);
+
+int __ld_make_directory(const char* path){
+   if(mkdir(path, 0700) != 0 && errno != EEXIST){
+      debug_print("ERROR Fenix_Data_group_create: unable to make directory <%s>: %s\n",
+            path, strerror(errno));
+      return -1;
+   }
+   return 0;
+}
+
+void __fenix_policy_local_disk_get_group(fenix_group_t** group, MPI_Comm comm, 
+      int timestart, int depth, void* policy_value, int* flag){
+   *group = (fenix_group_t *)malloc(sizeof(fenix_ld_group_t));
+   fenix_ld_group_t *new_group = (fenix_ld_group_t *)(*group);
+   new_group->base.vtbl.group_delete = *__ld_group_delete;
+   new_group->base.vtbl.member_create = *__ld_member_create;
+   new_group->base.vtbl.member_delete = *__ld_member_delete;
+   new_group->base.vtbl.get_redundant_policy = *__ld_get_redundant_policy;
+   new_group->base.vtbl.member_store = *__ld_member_store;
+   new_group->base.vtbl.member_storev = *__ld_member_storev;
+   new_group->base.vtbl.member_istore = *__ld_member_istore;
+   new_group->base.vtbl.member_istorev = *__ld_member_istorev;
+   new_group->base.vtbl.member_store_all = NULL;
+   new_group->base.vtbl.store_plan_create = NULL;
+   new_group->base.vtbl.store_plan_start = NULL;
+   new_group->base.vtbl.store_plan_free = NULL;
+   new_group->base.vtbl.request_wait = *__ld_request_wait;
+   new_group->base.vtbl.request_test = *__ld_request_test;
+   new_group->base.vtbl.commit = *__ld_commit;
+   new_group->base.vtbl.snapshot_delete = *__ld_snapshot_delete;
+   new_group->base.vtbl.barrier = *__ld_barrier;
+   new_group->base.vtbl.member_restore = *__ld_member_restore;
+   new_group->base.vtbl.member_restore_from_rank = *__ld_member_restore_from_rank;
+   new_group->base.vtbl.member_get_attribute = *__ld_member_get_attribute;
+   new_group->base.vtbl.member_set_attribute = *__ld_member_set_attribute;
+   new_group->base.vtbl.get_number_of_snapshots = *__ld_get_number_of_snapshots;
+   new_group->base.vtbl.get_snapshot_at_position = *__ld_get_snapshot_at_position;
+   new_group->base.vtbl.reinit = *__ld_reinit;
+   new_group->base.vtbl.progress = NULL;
+
+   //policy_value is the directory, a path each rank can reach its node-local
+   //disk through. Rank r's snapshots go in its rank<r> subdirectory.
+   int my_rank;
+   MPI_Comm_rank(comm, &my_rank);
+   new_group->directory = strdup((char*)policy_value);
+   size_t path_size = strlen(new_group->directory) + 32;
+   new_group->rank_directory = (char*) s_malloc(path_size);
+   snprintf(new_group->rank_directory, path_size, "%s/rank%d", new_group->directory, my_rank);
+
+   *flag = FENIX_SUCCESS;
+   if(__ld_make_directory(new_group->directory) != 0 || 
+         __ld_make_directory(new_group->rank_directory) != 0){
+      *flag = FENIX_ERROR_GROUP_CREATE;
+   }
+
+   new_group->entries_size = __FENIX_LD_DEFAULT_MENTRY_NUM;
+   new_group->entries_count = 0;
+   new_group->entries = 
+      (fenix_ld_mentry_t*) malloc(sizeof(fenix_ld_mentry_t) * __FENIX_LD_DEFAULT_MENTRY_NUM);
+   new_group->next_timestamp = timestart;
+
+   pthread_mutex_init(&(new_group->lock), NULL);
+   pthread_cond_init(&(new_group->work), NULL);
+   pthread_cond_init(&(new_group->idle), NULL);
+   new_group->jobs = NULL;
+   new_group->last_job = NULL;
+   new_group->in_flight = 0;
+   new_group->write_error = 0;
+   new_group->shutdown = 0;
+   pthread_create(&(new_group->writer), NULL, __ld_writer, new_group);
+}
+
+size_t __ld_round(size_t size){
+   return (size + __FENIX_LD_ALIGNMENT - 1)/__FENIX_LD_ALIGNMENT*__FENIX_LD_ALIGNMENT;
+}
+
+void* __ld_alloc(size_t size){
+   void* buffer = NULL;
+   if(posix_memalign(&buffer, __FENIX_LD_ALIGNMENT, size > 0 ? size : __FENIX_LD_ALIGNMENT) != 0){
+      debug_print("Out of memory: posix_memalign failed on alloc %lu bytes.\n", (unsigned long) size);
+      return NULL;
+   }
+   return buffer;
+}
+
+//Snapshots kept on disk per member.
+int __ld_keep(fenix_ld_group_t* group){
+   return group->base.depth + 1 > 1 ? group->base.depth + 1 : 1;
+}
+
+//directory is one of the group's rank directories.
+char* __ld_snapshot_path_in(fenix_ld_group_t* group, const char* directory, int memberid,
+        int timestamp){
+   size_t path_size = strlen(directory) + 64;
+   char* path = (char*) s_malloc(path_size);
+   snprintf(path, path_size, "%s/g%d_m%d_t%d", directory, group->base.groupid,
+         memberid, timestamp);
+   return path;
+}
+
+char* __ld_snapshot_path(fenix_ld_group_t* group, int memberid, int timestamp){
+   return __ld_snapshot_path_in(group, group->rank_directory, memberid, timestamp);
+}
+
+//Not every file system takes O_DIRECT (tmpfs doesn't), fall back to buffered IO.
+int __ld_open(const char* path, int flags){
+   int fd = open(path, flags | O_DIRECT, 0600);
+   if(fd < 0 && errno == EINVAL){
+      fd = open(path, flags, 0600);
+   }
+   return fd;
+}
+
+int __ld_pwrite(int fd, void* buffer, size_t size, off_t offset){
+   char* position = (char*)buffer;
+   while(size > 0){
+      ssize_t written = pwrite(fd, position, size, offset);
+      if(written < 0){
+         if(errno == EINTR) continue;
+         return -1;
+      }
+      position += written;
+      offset += written;
+      size -= written;
+   }
+   return 0;
+}
+
+int __ld_pread(int fd, void* buffer, size_t size, off_t offset){
+   char* position = (char*)buffer;
+   while(size > 0){
+      ssize_t got = pread(fd, position, size, offset);
+      if(got < 0 && errno == EINTR) continue;
+      if(got <= 0) return -1;
+      position += got;
+      offset += got;
+      size -= got;
+   }
+   return 0;
+}
+
+//A rename is only sure to survive a crash once its directory is on disk.
+int __ld_sync_directory(const char* path){
+   char* directory = strdup(path);
+   char* slash = strrchr(directory, '/');
+   if(slash != NULL) *slash = '\0';
+
+   int retval = -1;
+   int fd = open(slash != NULL ? directory : ".", O_RDONLY | O_DIRECTORY);
+   if(fd >= 0){
+      //Some file systems can't sync directories, and have nothing to sync.
+      retval = (fsync(fd) == 0 || errno == EINVAL) ? 0 : -1;
+      close(fd);
+   }
+   free(directory);
+   return retval;
+}
+
+int __ld_write_file(fenix_ld_job_t* job){
+   size_t path_size = strlen(job->path) + 8;
+   char* tmp_path = (char*) s_malloc(path_size);
+   snprintf(tmp_path, path_size, "%s.tmp", job->path);
+
+   int retval = -1;
+   int fd = __ld_open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC);
+   if(fd >= 0){
+      if(__ld_pwrite(fd, job->header, job->header_size, 0) == 0 &&
+            __ld_pwrite(fd, job->data, job->data_size, job->header_size) == 0 &&
+            fdatasync(fd) == 0){
+         retval = 0;
+      }
+      close(fd);
+      if(retval == 0){
+         retval = rename(tmp_path, job->path);
+      }
+      if(retval == 0){
+         retval = __ld_sync_directory(job->path);
+      }
+   }
+
+   if(retval != 0){
+      debug_print("ERROR Fenix_Data_commit: unable to write snapshot <%s>: %s\n",
+            job->path, strerror(errno));
+      unlink(tmp_path);
+   }
+   free(tmp_path);
+   return retval;
+}
+
+void __ld_job_free(fenix_ld_job_t* job){
+   free(job->path);
+   free(job->header);
+   free(job->data);
+   free(job);
+}
+
+void* __ld_writer(void* arg){
+   fenix_ld_group_t* group = (fenix_ld_group_t*)arg;
+
+   pthread_mutex_lock(&(group->lock));
+   while(1){
+      while(group->jobs == NULL && !group->shutdown){
+         pthread_cond_wait(&(group->work), &(group->lock));
+      }
+      if(group->jobs == NULL) break;
+
+      fenix_ld_job_t* job = group->jobs;
+      group->jobs = job->next;
+      if(group->jobs == NULL) group->last_job = NULL;
+      pthread_mutex_unlock(&(group->lock));
+
+      int result;
+      if(job->header == NULL){
+         result = unlink(job->path);
+         if(result != 0 && errno == ENOENT) result = 0;
+      } else {
+         result = __ld_write_file(job);
+      }
+      __ld_job_free(job);
+
+      pthread_mutex_lock(&(group->lock));
+      if(result != 0) group->write_error = 1;
+      group->in_flight--;
+      if(group->in_flight == 0) pthread_cond_broadcast(&(group->idle));
+   }
+   pthread_mutex_unlock(&(group->lock));
+   return NULL;
+}
+
+//Jobs run in the order they are queued, so a snapshot's removal never
+//overtakes its write.
+void __ld_enqueue(fenix_ld_group_t* group, fenix_ld_job_t* job){
+   job->next = NULL;
+   pthread_mutex_lock(&(group->lock));
+   if(group->last_job == NULL){
+      group->jobs = job;
+   } else {
+      group->last_job->next = job;
+   }
+   group->last_job = job;
+   group->in_flight++;
+   pthread_cond_signal(&(group->work));
+   pthread_mutex_unlock(&(group->lock));
+}
+
+void __ld_enqueue_removal(fenix_ld_group_t* group, int memberid, int timestamp){
+   fenix_ld_job_t* job = (fenix_ld_job_t*) s_malloc(sizeof(fenix_ld_job_t));
+   job->path = __ld_snapshot_path(group, memberid, timestamp);
+   job->header = NULL;
+   job->data = NULL;
+   __ld_enqueue(group, job);
+}
+
+//Waits for the writer to finish everything queued.
+void __ld_drain(fenix_ld_group_t* group){
+   pthread_mutex_lock(&(group->lock));
+   while(group->in_flight > 0){
+      pthread_cond_wait(&(group->idle), &(group->lock));
+   }
+   pthread_mutex_unlock(&(group->lock));
+}
+
+//Whether any writes failed since the last check.
+int __ld_take_error(fenix_ld_group_t* group){
+   pthread_mutex_lock(&(group->lock));
+   int failed = group->write_error;
+   group->write_error = 0;
+   pthread_mutex_unlock(&(group->lock));
+   return failed;
+}
+
+//Same layout as __fenix_data_subset_send.
+int __ld_subset_ints(Fenix_Data_subset* ss){
+   return 3*ss->num_blocks + 3;
+}
+
+void __ld_pack_subset(Fenix_Data_subset* ss, int* packed){
+   packed[0] = ss->num_blocks;
+   for(int i = 0; i < ss->num_blocks; i++){
+      packed[1+3*i] = ss->start_offsets[i];
+      packed[2+3*i] = ss->end_offsets[i];
+      packed[3+3*i] = ss->num_repeats[i];
+   }
+   packed[1+3*ss->num_blocks] = ss->stride;
+   packed[2+3*ss->num_blocks] = ss->specifier;
+}
+
+void __ld_unpack_subset(Fenix_Data_subset* ss, int* packed){
+   __fenix_data_subset_init(packed[0], ss);
+   for(int i = 0; i < ss->num_blocks; i++){
+      ss->start_offsets[i] = packed[1+3*i];
+      ss->end_offsets[i] = packed[2+3*i];
+      ss->num_repeats[i] = packed[3+3*i];
+   }
+   ss->stride = packed[1+3*ss->num_blocks];
+   ss->specifier = packed[2+3*ss->num_blocks];
+}
+
+//Reads back a snapshot's regions and, unless data is NULL, its data. Fails if
+//the file is missing, damaged or holds a member of another size.
+int __ld_read_snapshot(fenix_ld_group_t* group, const char* directory, int memberid,
+        int timestamp, size_t data_size, Fenix_Data_subset* regions, void** data){
+   char* path = __ld_snapshot_path_in(group, directory, memberid, timestamp);
+   int fd = __ld_open(path, O_RDONLY);
+   free(path);
+   if(fd < 0) return -1;
+
+   int retval = -1;
+   size_t header_size = __FENIX_LD_ALIGNMENT;
+   int* header = (int*) __ld_alloc(header_size);
+   if(__ld_pread(fd, header, header_size, 0) == 0 && header[0] == __FENIX_LD_MAGIC && 
+         header[1] == timestamp && (size_t)header[2]*header[3] == data_size &&
+         header[__FENIX_LD_HEADER_INTS] >= 0){
+      retval = 0;
+
+      //Subsets with many blocks spill past the first block of the header.
+      size_t needed = __ld_round((__FENIX_LD_HEADER_INTS + 
+               3*(size_t)header[__FENIX_LD_HEADER_INTS] + 3)*sizeof(int));
+      if(needed > header_size){
+         free(header);
+         header_size = needed;
+         header = (int*) __ld_alloc(header_size);
+         retval = __ld_pread(fd, header, header_size, 0);
+      }
+   }
+   if(retval == 0){
+      __ld_unpack_subset(regions, header + __FENIX_LD_HEADER_INTS);
+   }
+
+   if(retval == 0 && data != NULL){
+      *data = NULL;
+      if(regions->specifier != __FENIX_SUBSET_EMPTY){
+         *data = __ld_alloc(__ld_round(data_size));
+         if(__ld_pread(fd, *data, __ld_round(data_size), header_size) != 0){
+            free(*data);
+            __fenix_data_subset_free(regions);
+            retval = -1;
+         }
+      }
+   }
+
+   free(header);
+   close(fd);
+   return retval;
+}
+
+//Sets mentry to point to the right index for a given memberid, or to where it
+//would be inserted. Returns FENIX_SUCCESS only if it was found.
+int __ld_find_mentry(fenix_ld_group_t* group, int memberid, fenix_ld_mentry_t** mentry){
+   if(group->entries_count == 0){
+      *mentry = group->entries;
+      return __FENIX_LD_NO_MEMBERS;
+   }
+
+   //List is sorted by member id, do binary search.
+   int lower_bound = 0, upper_bound = group->entries_count;
+   while(lower_bound < upper_bound){
+      int to_check = (lower_bound + upper_bound)/2;
+      if(group->entries[to_check].memberid < memberid){
+         lower_bound = to_check + 1;
+      } else {
+         upper_bound = to_check;
+      }
+   }
+
+   *mentry = group->entries + lower_bound;
+   if(lower_bound < group->entries_count && (*mentry)->memberid == memberid){
+      return FENIX_SUCCESS;
+   }
+   return -1;
+}
+
+//Adds a snapshot found on disk, keeping only the newest ones.
+void __ld_add_loaded(fenix_ld_group_t* group, fenix_ld_mentry_t* mentry, int timestamp){
+   int keep = __ld_keep(group);
+   int position = mentry->num_snapshots;
+   while(position > 0 && mentry->timestamp[position-1] > timestamp){
+      position--;
+   }
+
+   char* path;
+   if(mentry->num_snapshots == keep){
+      if(position == 0){
+         path = __ld_snapshot_path(group, mentry->memberid, timestamp);
+         unlink(path);
+         free(path);
+         return;
+      }
+      path = __ld_snapshot_path(group, mentry->memberid, mentry->timestamp[0]);
+      unlink(path);
+      free(path);
+      memmove(mentry->timestamp, mentry->timestamp + 1, (position - 1)*sizeof(int));
+      position--;
+   } else {
+      memmove(mentry->timestamp + position + 1, mentry->timestamp + position,
+            (mentry->num_snapshots - position)*sizeof(int));
+      mentry->num_snapshots++;
+   }
+   mentry->timestamp[position] = timestamp;
+}
+
+//Picks up the snapshots an earlier job left for this member.
+void __ld_load_snapshots(fenix_ld_group_t* group, fenix_ld_mentry_t* mentry){
+   DIR* dir = opendir(group->rank_directory);
+   if(dir == NULL) return;
+
+   struct dirent* file;
+   while((file = readdir(dir)) != NULL){
+      int groupid, memberid, timestamp, length = 0;
+      if(sscanf(file->d_name, "g%d_m%d_t%d%n", &groupid, &memberid, &timestamp, &length) != 3 ||
+            groupid != group->base.groupid || memberid != mentry->memberid){
+         continue;
+      }
+
+      if(strcmp(file->d_name + length, "") == 0){
+         __ld_add_loaded(group, mentry, timestamp);
+      } else if(strcmp(file->d_name + length, ".tmp") == 0){
+         //Left behind by a write the job didn't live to finish.
+         size_t path_size = strlen(group->rank_directory) + strlen(file->d_name) + 2;
+         char* path = (char*) s_malloc(path_size);
+         snprintf(path, path_size, "%s/%s", group->rank_directory, file->d_name);
+         unlink(path);
+         free(path);
+      }
+   }
+   closedir(dir);
+
+   if(mentry->num_snapshots > 0){
+      int newest = mentry->timestamp[mentry->num_snapshots - 1];
+      if(newest > group->base.timestamp) group->base.timestamp = newest;
+      if(newest >= group->next_timestamp) group->next_timestamp = newest + 1;
+   }
+}
+
+int __ld_member_create(fenix_group_t* g, fenix_member_entry_t* mentry){
+   fenix_ld_group_t* group = (fenix_ld_group_t*)g;
+
+   fenix_ld_mentry_t* new_mentry;
+   if(__ld_find_mentry(group, mentry->memberid, &new_mentry) == FENIX_SUCCESS){
+      debug_print("Error Fenix_Data_member_create: member_id <%d> already exists in this policy\n",
+            mentry->memberid);
+      return -1;
+   }
+
+   //Double check that we have room for the member.
+   int index = new_mentry - group->entries;
+   if(group->entries_count >= group->entries_size){
+      group->entries = (fenix_ld_mentry_t*) s_realloc(group->entries,
+            group->entries_size * 2 * sizeof(fenix_ld_mentry_t));
+      group->entries_size *= 2;
+   }
+   new_mentry = group->entries + index;
+   memmove(new_mentry + 1, new_mentry, (group->entries_count - index) * sizeof(fenix_ld_mentry_t));
+
+   new_mentry->memberid = mentry->memberid;
+   new_mentry->staging = NULL;
+   new_mentry->staging_size = 0;
+   __fenix_data_subset_init(1, &(new_mentry->staging_regions));
+   new_mentry->staging_regions.specifier = __FENIX_SUBSET_EMPTY;
+   new_mentry->timestamp = (int*) s_malloc(__ld_keep(group) * sizeof(int));
+   new_mentry->num_snapshots = 0;
+   group->entries_count++;
+
+   //A member deleted and made again may still have removals queued.
+   __ld_drain(group);
+   __ld_load_snapshots(group, new_mentry);
+
+   return FENIX_SUCCESS;
+}
+
+void __ld_member_free(fenix_ld_mentry_t* mentry){
+   __fenix_data_subset_free(&(mentry->staging_regions));
+   free(mentry->staging);
+   free(mentry->timestamp);
+}
+
+int __ld_member_delete(fenix_group_t* g, int member_id){
+   fenix_ld_group_t* group = (fenix_ld_group_t*)g;
+
+   fenix_ld_mentry_t* mentry;
+   if(__ld_find_mentry(group, member_id, &mentry) != FENIX_SUCCESS){
+      debug_print("ERROR Fenix_Data_member_delete: member_id <%d> does not exist!\n",
+                member_id);
+      return FENIX_ERROR_INVALID_MEMBERID;
+   }
+
+   for(int snapshot = 0; snapshot < mentry->num_snapshots; snapshot++){
+      __ld_enqueue_removal(group, member_id, mentry->timestamp[snapshot]);
+   }
+   __ld_member_free(mentry);
+
+   int member_index = mentry - group->entries;
+   memmove(mentry, mentry + 1, (group->entries_count - 1 - member_index) * sizeof(fenix_ld_mentry_t));
+   group->entries_count--;
+
+   return FENIX_SUCCESS;
+}
+
+int __ld_member_store_common(fenix_group_t* g, int member_id, 
+        Fenix_Data_subset* subset, int vectored){
+   fenix_ld_group_t* group = (fenix_ld_group_t*)g;
+
+   fenix_ld_mentry_t* mentry;
+   if(__ld_find_mentry(group, member_id, &mentry) != FENIX_SUCCESS){
+      debug_print("ERROR Fenix_Data_member_store: member_id <%d> does not exist on rank <%d>!\n",
+                member_id, g->current_rank);
+      return FENIX_ERROR_INVALID_MEMBERID;
+   }
+
+   int member_data_index = __fenix_search_memberid(group->base.member, member_id);
+   fenix_member_entry_t* member_data = &(group->base.member->member_entry[member_data_index]);
+
+   //Staging buffers go to the writer at commit, so each snapshot starts a new one.
+   size_t data_size = (size_t)member_data->datatype_size * member_data->current_count;
+   size_t padded_size = __ld_round(data_size);
+   if(mentry->staging == NULL || mentry->staging_size < padded_size){
+      void* staging = __ld_alloc(padded_size);
+      if(mentry->staging != NULL){
+         memcpy(staging, mentry->staging, mentry->staging_size);
+         free(mentry->staging);
+      } else if(!__fenix_data_subset_is_full(subset, member_data->current_count)){
+         //Don't write out whatever the allocation held.
+         memset(staging, 0, data_size);
+      }
+      memset((char*)staging + data_size, 0, padded_size - data_size);
+      mentry->staging = staging;
+      mentry->staging_size = padded_size;
+   }
+
+   if(vectored){
+      __fenix_data_member_gather_buffers(member_data, subset, mentry->staging);
+   } else {
+      __fenix_data_subset_copy_data(subset, mentry->staging, member_data->user_data,
+            member_data->datatype_size, member_data->current_count);
+   }
+   __fenix_data_subset_merge_inplace(&(mentry->staging_regions), subset);
+
+   return FENIX_SUCCESS;
+}
+
+int __ld_member_store(fenix_group_t* g, int member_id, 
+        Fenix_Data_subset subset_specifier){
+   return __ld_member_store_common(g, member_id, &subset_specifier, 0);
+}
+
+int __ld_member_storev(fenix_group_t* g, int member_id, 
+        Fenix_Data_subset subset_specifier){
+   return __ld_member_store_common(g, member_id, &subset_specifier, 1);
+}
+
+//Stores only copy to memory, the disk is written behind commits.
+int __ld_member_istore(fenix_group_t* g, int member_id, 
+        Fenix_Data_subset subset_specifier, Fenix_Request *request){
+   request->mpi_send_req = MPI_REQUEST_NULL;
+   request->mpi_recv_req = MPI_REQUEST_NULL;
+   request->data_request = NULL;
+   return __ld_member_store_common(g, member_id, &subset_specifier, 0);
+}
+
+int __ld_member_istorev(fenix_group_t* g, int member_id, 
+        Fenix_Data_subset subset_specifier, Fenix_Request *request){
+   request->mpi_send_req = MPI_REQUEST_NULL;
+   request->mpi_recv_req = MPI_REQUEST_NULL;
+   request->data_request = NULL;
+   return __ld_member_store_common(g, member_id, &subset_specifier, 1);
+}
+
+int __ld_request_wait(fenix_group_t* group, fenix_data_request_t* request){
+   return FENIX_SUCCESS;
+}
+
+int __ld_request_test(fenix_group_t* group, fenix_data_request_t* request, int* flag){
+   *flag = 1;
+   return FENIX_SUCCESS;
+}
+
+int __ld_commit(fenix_group_t* g){
+   fenix_ld_group_t* group = (fenix_ld_group_t*)g;
+   int timestamp = group->next_timestamp++;
+
+   for(int eid = 0; eid < group->entries_count; eid++){ 
+      fenix_ld_mentry_t* mentry = &group->entries[eid];
+      int member_data_index = __fenix_search_memberid(group->base.member, mentry->memberid);
+      fenix_member_entry_t* member_data = &(group->base.member->member_entry[member_data_index]);
+
+      fenix_ld_job_t* job = (fenix_ld_job_t*) s_malloc(sizeof(fenix_ld_job_t));
+      job->path = __ld_snapshot_path(group, mentry->memberid, timestamp);
+      job->header_size = __ld_round((__FENIX_LD_HEADER_INTS + 
+               __ld_subset_ints(&(mentry->staging_regions)))*sizeof(int));
+      int* header = (int*) __ld_alloc(job->header_size);
+      memset(header, 0, job->header_size);
+      header[0] = __FENIX_LD_MAGIC;
+      header[1] = timestamp;
+      header[2] = member_data->datatype_size;
+      header[3] = member_data->current_count;
+      __ld_pack_subset(&(mentry->staging_regions), header + __FENIX_LD_HEADER_INTS);
+      job->header = header;
+
+      //Every member gets a file, even with nothing stored, so that each
+      //snapshot is on disk for all of them.
+      if(mentry->staging_regions.specifier == __FENIX_SUBSET_EMPTY){
+         job->data = NULL;
+         job->data_size = 0;
+         free(mentry->staging);
+      } else {
+         job->data = mentry->staging;
+         job->data_size = __ld_round((size_t)member_data->datatype_size * member_data->current_count);
+      }
+      mentry->staging = NULL;
+      mentry->staging_size = 0;
+      mentry->staging_regions.specifier = __FENIX_SUBSET_EMPTY;
+      __ld_enqueue(group, job);
+
+      if(mentry->num_snapshots == __ld_keep(group)){
+         __ld_enqueue_removal(group, mentry->memberid, mentry->timestamp[0]);
+         memmove(mentry->timestamp, mentry->timestamp + 1, (mentry->num_snapshots - 1)*sizeof(int));
+         mentry->num_snapshots--;
+      }
+      mentry->timestamp[mentry->num_snapshots++] = timestamp;
+   }
+
+   group->base.timestamp = timestamp;
+
+   //Report writes of earlier commits which have failed since.
+   return __ld_take_error(group) ? FENIX_ERROR_COMMIT_BARRIER : FENIX_SUCCESS;
+}
+
+int __ld_snapshot_delete(fenix_group_t* g, int time_stamp){
+   int retval = FENIX_ERROR_INVALID_TIMESTAMP;
+   fenix_ld_group_t* group = (fenix_ld_group_t*)g;
+
+   for(int entry_id = 0; entry_id < group->entries_count; entry_id++){
+      fenix_ld_mentry_t* mentry = &group->entries[entry_id];
+
+      for(int snapshot = 0; snapshot < mentry->num_snapshots; snapshot++){
+         if(mentry->timestamp[snapshot] == time_stamp){
+            __ld_enqueue_removal(group, mentry->memberid, time_stamp);
+            memmove(mentry->timestamp + snapshot, mentry->timestamp + snapshot + 1,
+                  (mentry->num_snapshots - snapshot - 1)*sizeof(int));
+            mentry->num_snapshots--;
+            retval = FENIX_SUCCESS;
+            break;
+         }
+      }
+   }
+
+   return retval;
+}
+
+//Waits for committed snapshots to reach the disk.
+int __ld_barrier(fenix_group_t* g){
+   fenix_ld_group_t* group = (fenix_ld_group_t*)g;
+   __ld_drain(group);
+   return __ld_take_error(group) ? FENIX_ERROR_COMMIT_BARRIER : FENIX_SUCCESS;
+}
+
+int __ld_get_number_of_snapshots(fenix_group_t* g, int* number_of_snapshots){
+   fenix_ld_group_t* group = (fenix_ld_group_t*)g;
+   return group->entries_count > 0 ? group->entries[0].num_snapshots : 0;
+}
+
+int __ld_get_snapshot_at_position(fenix_group_t* g, int position, int* time_stamp){
+   fenix_ld_group_t* group = (fenix_ld_group_t*)g;
+
+   //Each member has the same snapshots, so just query the first.
+   fenix_ld_mentry_t* first = group->entries;
+   if(group->entries_count == 0 || position < 0 || !(position < first->num_snapshots)){
+      return FENIX_ERROR_INVALID_POSITION;
+   }
+
+   *time_stamp = first->timestamp[first->num_snapshots - 1 - position];
+   return FENIX_SUCCESS;
+}
+
+int __ld_compare_ints(const void* a, const void* b){
+   int x = *(const int*)a, y = *(const int*)b;
+   return (x > y) - (x < y);
+}
+
+//Lists, oldest first, the timestamps of a member's snapshots in one of the
+//group's rank directories. The caller frees *timestamps.
+int __ld_scan_snapshots(fenix_ld_group_t* group, const char* directory, int memberid,
+        int** timestamps){
+   int count = 0, size = __ld_keep(group);
+   *timestamps = (int*) s_malloc(size * sizeof(int));
+
+   DIR* dir = opendir(directory);
+   if(dir == NULL) return 0;
+
+   struct dirent* file;
+   while((file = readdir(dir)) != NULL){
+      int groupid, file_memberid, timestamp, length = 0;
+      if(sscanf(file->d_name, "g%d_m%d_t%d%n", &groupid, &file_memberid, &timestamp, &length) != 3 ||
+            groupid != group->base.groupid || file_memberid != memberid ||
+            file->d_name[length] != '\0'){
+         continue;
+      }
+      if(count == size){
+         size *= 2;
+         *timestamps = (int*) s_realloc(*timestamps, size * sizeof(int));
+      }
+      (*timestamps)[count++] = timestamp;
+   }
+   closedir(dir);
+
+   qsort(*timestamps, count, sizeof(int), __ld_compare_ints);
+   return count;
+}
+
+//Restores a member from the snapshots listed in timestamps, oldest first, up
+//to the newest one no later than newest. Reads go back only as far as it
+//takes to cover the member, data_found gets the regions covered.
+void __ld_restore_from(fenix_ld_group_t* group, const char* directory, int member_id,
+        int* timestamps, int num_snapshots, int newest, int datatype_size, int count,
+        void* target_buffer, Fenix_Data_subset* data_found){
+   size_t data_size = (size_t)datatype_size * count;
+
+   int newest_snapshot = num_snapshots - 1;
+   while(newest_snapshot >= 0 && timestamps[newest_snapshot] > newest){
+      newest_snapshot--;
+   }
+
+   Fenix_Data_subset regions;
+   int oldest_snapshot = newest_snapshot + 1;
+   while(oldest_snapshot > 0 && !__fenix_data_subset_is_full(data_found, count)){
+      if(__ld_read_snapshot(group, directory, member_id, timestamps[oldest_snapshot - 1],
+               data_size, &regions, NULL) != 0){
+         debug_print("ERROR Fenix_Data_member_restore: unable to read snapshot <%d> of member_id <%d> in <%s>\n",
+               timestamps[oldest_snapshot - 1], member_id, directory);
+         break;
+      }
+      __fenix_data_subset_merge_inplace(data_found, &regions);
+      __fenix_data_subset_free(&regions);
+      oldest_snapshot--;
+   }
+
+   for(int snapshot = oldest_snapshot; snapshot <= newest_snapshot; snapshot++){
+      void* data;
+      if(__ld_read_snapshot(group, directory, member_id, timestamps[snapshot], data_size,
+               &regions, &data) != 0){
+         continue;
+      }
+      if(data != NULL){
+         __fenix_data_subset_copy_data(&regions, target_buffer, data, datatype_size, count);
+         free(data);
+      }
+      __fenix_data_subset_free(&regions);
+   }
+}
+
+//Ranks that found none of a member's snapshots on disk, like a spare on
+//another node than the rank it replaced, get them through a rank that can
+//still read the replaced rank's directory, like one on its old node.
+void __ld_fetch_missing(fenix_ld_group_t* group, int member_id, int newest, int missing,
+        fenix_member_entry_t* member_data, void* target_buffer, Fenix_Data_subset* data_found){
+   MPI_Comm comm = group->base.comm;
+   int my_rank, num_ranks;
+   MPI_Comm_rank(comm, &my_rank);
+   MPI_Comm_size(comm, &num_ranks);
+
+   int* missing_ranks = (int*) s_malloc(num_ranks * sizeof(int));
+   MPI_Allgather(&missing, 1, MPI_INT, missing_ranks, 1, MPI_INT, comm);
+
+   size_t path_size = strlen(group->directory) + 32;
+   char* directory = (char*) s_malloc(path_size);
+   for(int rank = 0; rank < num_ranks; rank++){
+      if(!missing_ranks[rank]) continue;
+      snprintf(directory, path_size, "%s/rank%d", group->directory, rank);
+
+      //The lowest rank that sees the agreed snapshot serves it.
+      int server = INT_MAX;
+      if(!missing_ranks[my_rank]){
+         char* path = __ld_snapshot_path_in(group, directory, member_id, newest);
+         if(access(path, R_OK) == 0) server = my_rank;
+         free(path);
+      }
+      MPI_Allreduce(MPI_IN_PLACE, &server, 1, MPI_INT, MPI_MIN, comm);
+
+      if(server == INT_MAX){
+         if(rank == my_rank){
+            debug_print("ERROR Fenix_Data_member_restore: no rank can read snapshot <%d> of member_id <%d> for <%d>\n",
+                  newest, member_id, rank);
+         }
+      } else if(my_rank == server){
+         int shape[2];
+         MPI_Recv(shape, 2, MPI_INT, rank, __FENIX_LD_FETCH_TAG, comm, MPI_STATUS_IGNORE);
+         size_t data_size = (size_t)shape[0] * shape[1];
+         void* data = __ld_alloc(data_size);
+
+         Fenix_Data_subset found;
+         __fenix_data_subset_init(1, &found);
+         found.specifier = __FENIX_SUBSET_EMPTY;
+         int* timestamps;
+         int num_snapshots = __ld_scan_snapshots(group, directory, member_id, &timestamps);
+         __ld_restore_from(group, directory, member_id, timestamps, num_snapshots, newest,
+               shape[0], shape[1], data, &found);
+         free(timestamps);
+
+         int num_ints = __ld_subset_ints(&found);
+         int* packed = (int*) s_malloc(num_ints * sizeof(int));
+         __ld_pack_subset(&found, packed);
+         MPI_Send(&num_ints, 1, MPI_INT, rank, __FENIX_LD_FETCH_TAG, comm);
+         MPI_Send(packed, num_ints, MPI_INT, rank, __FENIX_LD_FETCH_TAG, comm);
+         MPI_Send(data, (int)data_size, MPI_BYTE, rank, __FENIX_LD_FETCH_TAG, comm);
+         free(packed);
+         free(data);
+         __fenix_data_subset_free(&found);
+      } else if(my_rank == rank){
+         int shape[2] = {member_data->datatype_size, member_data->current_count};
+         MPI_Send(shape, 2, MPI_INT, server, __FENIX_LD_FETCH_TAG, comm);
+         size_t data_size = (size_t)shape[0] * shape[1];
+
+         int num_ints;
+         MPI_Recv(&num_ints, 1, MPI_INT, server, __FENIX_LD_FETCH_TAG, comm, MPI_STATUS_IGNORE);
+         int* packed = (int*) s_malloc(num_ints * sizeof(int));
+         MPI_Recv(packed, num_ints, MPI_INT, server, __FENIX_LD_FETCH_TAG, comm, MPI_STATUS_IGNORE);
+         void* data = __ld_alloc(data_size);
+         MPI_Recv(data, (int)data_size, MPI_BYTE, server, __FENIX_LD_FETCH_TAG, comm, MPI_STATUS_IGNORE);
+
+         Fenix_Data_subset found;
+         __ld_unpack_subset(&found, packed);
+         __fenix_data_subset_copy_data(&found, target_buffer, data, shape[0], shape[1]);
+         __fenix_data_subset_merge_inplace(data_found, &found);
+         __fenix_data_subset_free(&found);
+         free(packed);
+         free(data);
+      }
+   }
+   free(directory);
+   free(missing_ranks);
+}
+
+int __ld_member_restore(fenix_group_t* g, int member_id,
+        void* target_buffer, int max_count, int time_stamp, Fenix_Data_subset* data_found){ 
+   int retval = -1;
+   fenix_ld_group_t* group = (fenix_ld_group_t*)g;
+
+   __ld_drain(group);
+
+   fenix_ld_mentry_t* mentry;
+   int found_member = !(__ld_find_mentry(group, member_id, &mentry));
+   int has_data = found_member && mentry->num_snapshots > 0;
+
+   //A job can die with some ranks' latest writes unfinished, so everyone
+   //restores from the newest snapshot all ranks with data have. Ranks with
+   //none don't hold the others back, they fetch theirs below.
+   int newest = has_data ? mentry->timestamp[mentry->num_snapshots - 1] : INT_MAX;
+   int agreed;
+   MPI_Allreduce(&newest, &agreed, 1, MPI_INT, MPI_MIN, g->comm);
+
+   int return_found_data;
+   if(data_found == NULL){
+      data_found = (Fenix_Data_subset*) malloc(sizeof(Fenix_Data_subset));
+      return_found_data = 0;
+   } else {
+      return_found_data = 1;   
+   }
+   __fenix_data_subset_init(1, data_found);
+   data_found->specifier = __FENIX_SUBSET_EMPTY;
+
+   fenix_member_entry_t* member_data = NULL;
+   if(found_member){
+      int member_data_index = __fenix_search_memberid(group->base.member, member_id);
+      member_data = &(group->base.member->member_entry[member_data_index]);
+   }
+
+   if(has_data){
+      __ld_restore_from(group, group->rank_directory, member_id, mentry->timestamp,
+            mentry->num_snapshots, agreed, member_data->datatype_size, member_data->current_count,
+            target_buffer, data_found);
+   }
+   if(agreed != INT_MAX){
+      __ld_fetch_missing(group, member_id, agreed, found_member && !has_data, member_data,
+            target_buffer, data_found);
+   }
+
+   if(!found_member){
+      debug_print("ERROR Fenix_Data_member_restore: member_id <%d> does not exist at <%d>\n",
+            member_id, g->current_rank);
+      retval = FENIX_ERROR_INVALID_MEMBERID;
+   } else if(__fenix_data_subset_is_full(data_found, member_data->current_count)){
+      retval = FENIX_SUCCESS;
+   } else {
+      retval = FENIX_WARNING_PARTIAL_RESTORE;
+   }
+
+   if(!return_found_data){
+      __fenix_data_subset_free(data_found);
+      free(data_found);
+   }
+
+   return retval;
+}
+
+int __ld_member_restore_from_rank(fenix_group_t* group, int member_id,
+        void* target_buffer, int max_count, int time_stamp, 
+        int source_rank){return 0;}
+
+int __ld_member_get_attribute(fenix_group_t* group, fenix_member_entry_t* member, 
+        int attributename, void* attributevalue, int* flag, int sourcerank){
+   //No attributes of its own (as of now)
+   return FENIX_ERROR_INVALID_ATTRIBUTE_NAME;
+}
+
+int __ld_member_set_attribute(fenix_group_t* group, fenix_member_entry_t* member, 
+        int attributename, void* attributevalue, int* flag){ 
+   //No mutable attributes (as of now) require any changes to this policy's info
+   return FENIX_SUCCESS;
+}
+
+int __ld_reinit(fenix_group_t* g, int* flag){
+   //Nothing is shared between ranks, a failure leaves the survivors' state as it was.
+   *flag = FENIX_SUCCESS;
+   return FENIX_SUCCESS;
+}
+
+//policy_value needs room for the directory's path.
+int __ld_get_redundant_policy(fenix_group_t* g, int* policy_name, 
+        void* policy_value, int* flag){
+   fenix_ld_group_t* group = (fenix_ld_group_t*)g;
+
+   *policy_name = FENIX_DATA_POLICY_LOCAL_DISK;
+   strcpy((char*)policy_value, group->directory);
+
+   *flag = FENIX_SUCCESS;
+   return FENIX_SUCCESS;
+}
+
+int __ld_group_delete(fenix_group_t* g){
+   fenix_ld_group_t* group = (fenix_ld_group_t*)g;
+
+   //Snapshots stay on disk for a later job, let the writer finish them.
+   __ld_drain(group);
+   pthread_mutex_lock(&(group->lock));
+   group->shutdown = 1;
+   pthread_cond_signal(&(group->work));
+   pthread_mutex_unlock(&(group->lock));
+   pthread_join(group->writer, NULL);
+   pthread_mutex_destroy(&(group->lock));
+   pthread_cond_destroy(&(group->work));
+   pthread_cond_destroy(&(group->idle));
+
+   for(int entry = 0; entry < group->entries_count; entry++){
+      __ld_member_free(group->entries + entry);
+   }
+   free(group->entries);
+
+   //We have the responsibility of destroying the member array in the base group struct.
+   __fenix_data_member_destroy(group->base.member);
+
+   free(group->directory);
+   free(group->rank_directory);
+   free(group);
+   return FENIX_SUCCESS;
+}
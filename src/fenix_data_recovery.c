@@ -62,6 +62,7 @@
 //#include "fenix_process_recovery.h"
 #include "fenix_util.h"
 #include "fenix_ext.h"
+#include "fenix_progress.h"
 
 
 /**
@@ -123,6 +124,11 @@ int __fenix_group_create( int groupid, MPI_Comm comm, int timestart, int depth,
       /* Initialize Group */
       __fenix_policy_get_group(data_recovery->group + group_index, comm, timestart, 
               depth, policy_name, policy_value, flag);
+
+      //Policies refuse values they can't work with, and leave no group behind.
+      if (data_recovery->group[ group_index ] == NULL) {
+        return *flag;
+      }
       
       //The group has filled any group-specific details, we need to fill in the core details.
       group = (data_recovery->group[ group_index ] );
@@ -131,6 +137,7 @@ int __fenix_group_create( int groupid, MPI_Comm comm, int timestart, int depth,
       group->timestamp = -1; //indicates no commits yet
       group->depth = depth;
       group->member = __fenix_data_member_init();
+      group->plans = NULL;
       group->comm = comm;
       MPI_Comm_rank(comm, &(group->current_rank));
 
@@ -231,15 +238,38 @@ int __fenix_member_create(int groupid, int memberid, void *data, int count, MPI_
 }
 
 
+/**
+ * @brief Repairs from a failure the progress thread ran into, if it did. The
+ *        thread only flags the requests it was driving, see fenix_progress.h
+ */
+void __fenix_data_repair_deferred() {
+  int error = __fenix_progress_take_error();
+  if (error != MPI_SUCCESS) {
+    __fenix_test_MPI(fenix.user_world, &error);
+  }
+}
+
 /**
  * @brief
  * @param request
  */
 int __fenix_data_wait( Fenix_Request request ) {
   int retval = -1;
+
+  if (request.data_request != NULL) {
+    /* Issued by a policy, so the policy knows how to finish it */
+    fenix_data_request_t *data_request = request.data_request;
+    fenix_group_t *group = data_request->group;
+    retval = group->vtbl.request_wait(group, data_request);
+    if (retval != FENIX_SUCCESS) {
+      __fenix_data_repair_deferred();
+    }
+    return retval;
+  }
+
   int result = __fenix_mpi_wait(&(request.mpi_recv_req));
 
-  if (result != MPI_SUCCESS) {
+  if (result == MPI_SUCCESS) {
     retval = FENIX_SUCCESS;
   } else {
     retval = FENIX_ERROR_DATA_WAIT;
@@ -248,8 +278,6 @@ int __fenix_data_wait( Fenix_Request request ) {
   result = __fenix_mpi_wait(&(request.mpi_send_req));
 
   if (result != MPI_SUCCESS) {
-    retval = FENIX_SUCCESS;
-  } else {
     retval = FENIX_ERROR_DATA_WAIT;
   }
 
@@ -263,6 +291,20 @@ int __fenix_data_wait( Fenix_Request request ) {
  */
 int __fenix_data_test(Fenix_Request request, int *flag) {
   int retval = -1;
+
+  if (request.data_request != NULL) {
+    fenix_data_request_t *data_request = request.data_request;
+    fenix_group_t *group = data_request->group;
+    retval = group->vtbl.request_test(group, data_request, flag);
+    if (retval != FENIX_SUCCESS) {
+      __fenix_data_repair_deferred();
+    }
+    if (retval == FENIX_SUCCESS && *flag == 0) {
+      retval = FENIX_ERROR_DATA_WAIT;
+    }
+    return retval;
+  }
+
   int result = ( __fenix_mpi_test(&(request.mpi_recv_req)) & __fenix_mpi_test(&(request.mpi_send_req))) ;
 
   if ( result == 1 ) {
@@ -277,7 +319,8 @@ int __fenix_data_test(Fenix_Request request, int *flag) {
 }
 
 /**
- * @brief // TODO: implement FENIX_DATA_MEMBER_ALL
+ * @brief FENIX_DATA_MEMBER_ALL stores every member of the group with
+ *        subset_specifier, see __fenix_member_store_all
  * @param group_id
  * @param member_id
  * @param subset_specifier
@@ -294,7 +337,8 @@ int __fenix_member_store(int groupid, int memberid, Fenix_Data_subset specifier)
     member_index = __fenix_search_memberid(fenix.data_recovery->group[group_index]->member, memberid );
   }
 
-  if (fenix.options.verbose == 18 && fenix.data_recovery->group[group_index]->current_rank== 0 ) {
+  if (fenix.options.verbose == 18 && group_index != -1 &&
+      fenix.data_recovery->group[group_index]->current_rank== 0 ) {
     verbose_print(
             "c-rank: %d, role: %d, group_index: %d, member_index: %d memberid: %d\n",
               __fenix_get_current_rank(fenix.new_world), fenix.role, group_index,
@@ -304,17 +348,87 @@ int __fenix_member_store(int groupid, int memberid, Fenix_Data_subset specifier)
   if (group_index == -1) {
     debug_print("ERROR Fenix_Data_member_store: group_id <%d> does not exist\n", groupid);
     retval = FENIX_ERROR_INVALID_GROUPID;
+  } else if (memberid == FENIX_DATA_MEMBER_ALL) {
+    retval = __fenix_member_store_all(fenix.data_recovery->group[group_index], specifier);
   } else if (member_index == -1) {
     debug_print("ERROR Fenix_Data_member_store: member_id <%d> does not exist\n",
                 memberid);
     retval = FENIX_ERROR_INVALID_MEMBERID;
   } else {
     fenix_group_t *group = (fenix.data_recovery->group[group_index]);
-    retval = group->vtbl.member_store(group, memberid, specifier);
+    fenix_member_entry_t *mentry = &(group->member->member_entry[member_index]);
+    if (__fenix_member_collect_dirty(group, mentry, &specifier)) {
+      retval = group->vtbl.member_store(group, memberid, specifier);
+      __fenix_data_subset_free(&specifier);
+    } else {
+      retval = group->vtbl.member_store(group, memberid, specifier);
+    }
   }
   return retval;
 }
 
+/**
+ * @brief Stores every member of a group with the same specifier. Policies
+ *        which can coalesce the members into one exchange get them all at
+ *        once, the others one member at a time.
+ * @param group
+ * @param specifier
+ */
+int __fenix_member_store_all(fenix_group_t *group, Fenix_Data_subset specifier) {
+  int retval = FENIX_SUCCESS;
+  fenix_member_t *member = group->member;
+  Fenix_Data_subset *specifiers =
+          (Fenix_Data_subset *) s_malloc((member->total_size + 1) * sizeof(Fenix_Data_subset));
+  int *collected = (int *) s_calloc(member->total_size + 1, sizeof(int));
+
+  size_t member_index;
+  for (member_index = 0; member_index < member->total_size; member_index++) {
+    fenix_member_entry_t *mentry = &(member->member_entry[member_index]);
+    if (mentry->state == EMPTY || mentry->state == DELETED) continue;
+    specifiers[member_index] = specifier;
+    collected[member_index] = __fenix_member_collect_dirty(group, mentry,
+            specifiers + member_index);
+  }
+
+  if (group->vtbl.member_store_all != NULL) {
+    retval = group->vtbl.member_store_all(group, specifiers);
+  } else {
+    for (member_index = 0; member_index < member->total_size; member_index++) {
+      fenix_member_entry_t *mentry = &(member->member_entry[member_index]);
+      if (mentry->state == EMPTY || mentry->state == DELETED) continue;
+      int result = group->vtbl.member_store(group, mentry->memberid, specifiers[member_index]);
+      if (result != FENIX_SUCCESS) retval = result;
+    }
+  }
+
+  for (member_index = 0; member_index < member->total_size; member_index++) {
+    if (collected[member_index]) __fenix_data_subset_free(specifiers + member_index);
+  }
+  free(collected);
+  free(specifiers);
+  return retval;
+}
+
+/**
+ * @brief With dirty tracking on, a full store only needs the pages written
+ *        since they were last stored. Replaces a FENIX_DATA_SUBSET_FULL
+ *        specifier with those, which the caller has to free. Collective
+ *        over the group.
+ * @param group
+ * @param mentry
+ * @param specifier
+ * @return whether specifier was replaced
+ */
+int __fenix_member_collect_dirty(fenix_group_t *group, fenix_member_entry_t *mentry,
+                         Fenix_Data_subset *specifier) {
+  if (mentry->dirty == NULL || specifier->specifier != __FENIX_SUBSET_FULL) {
+    return 0;
+  }
+  __fenix_dirty_collect(mentry->dirty, mentry->datatype_size, mentry->current_count,
+          group->depth, group->comm, specifier);
+  return 1;
+}
+
 /**
  * @brief
  * @param group_id
@@ -334,7 +448,8 @@ int __fenix_member_istore(int groupid, int memberid, Fenix_Data_subset specifier
     member_index = __fenix_search_memberid(fenix.data_recovery->group[group_index]->member, memberid );
   }
 
-  if (fenix.options.verbose == 18 && fenix.data_recovery->group[group_index]->current_rank== 0 ) {
+  if (fenix.options.verbose == 18 && group_index != -1 &&
+      fenix.data_recovery->group[group_index]->current_rank== 0 ) {
     verbose_print(
             "c-rank: %d, role: %d, group_index: %d, member_index: %d memberid: %d\n",
               __fenix_get_current_rank(fenix.new_world), fenix.role, group_index,
@@ -350,7 +465,13 @@ int __fenix_member_istore(int groupid, int memberid, Fenix_Data_subset specifier
     retval = FENIX_ERROR_INVALID_MEMBERID;
   } else {
     fenix_group_t *group = (fenix.data_recovery->group[group_index]);
-    retval = group->vtbl.member_istore(group, memberid, specifier, request);
+    fenix_member_entry_t *mentry = &(group->member->member_entry[member_index]);
+    if (__fenix_member_collect_dirty(group, mentry, &specifier)) {
+      retval = group->vtbl.member_istore(group, memberid, specifier, request);
+      __fenix_data_subset_free(&specifier);
+    } else {
+      retval = group->vtbl.member_istore(group, memberid, specifier, request);
+    }
   }
   return retval;
 }
@@ -456,46 +577,37 @@ void __fenix_subset(fenix_group_t *group, fenix_member_entry_t *me, Fenix_Data_s
 }
 
 
-#if 0
 /**
- * @brief
+ * @brief Store a member whose data is described by a buffer list
+ *        (FENIX_DATA_MEMBER_ATTRIBUTE_BUFFER_LIST). Without one this is
+ *        the same as a regular store.
  * @param group_id
  * @param member_id
  * @param subset_specifier
  */
-int __fenix_member_storev(int group_id, int member_id, Fenix_Data_subset subset_specifier) {
-
-/*
- * Using the same routine for v and non-v routine.
- */
+int __fenix_member_storev(int groupid, int memberid, Fenix_Data_subset specifier) {
   int retval = -1;
-  int group_index = __fenix_search_groupid( group_id, fenix.data_recovery );
-  int member_index = __fenix_search_memberid(group_index, member_id);
+  int group_index = __fenix_search_groupid(groupid, fenix.data_recovery );
+  int member_index = -1;
+
+  if (group_index !=-1 && memberid != FENIX_DATA_MEMBER_ALL) {
+    member_index = __fenix_search_memberid(fenix.data_recovery->group[group_index]->member, memberid );
+  }
+
   if (group_index == -1) {
-    debug_print("ERROR Fenix_Data_member_storev: group_id <%d> does not exist\n",
-                group_id);
+    debug_print("ERROR Fenix_Data_member_storev: group_id <%d> does not exist\n", groupid);
     retval = FENIX_ERROR_INVALID_GROUPID;
   } else if (member_index == -1) {
     debug_print("ERROR Fenix_Data_member_storev: member_id <%d> does not exist\n",
-                member_id);
+                memberid);
     retval = FENIX_ERROR_INVALID_MEMBERID;
   } else {
-    fenix_group_t *group = fenix.data_recovery;
-    fenix_group_entry_t *gentry = &(group->group_entry[group_index]);
-    fenix_member_t *member = &(gentry->member);
-    __fenix_ensure_version_capacity(member);
-    fenix_member_entry_t *mentry = &(member->member_entry[member_index]);
-    fenix_version_t *version = &(mentry->version);
-    fenix_local_entry_t *lentry = &(version->local_entry[version->position]);
-    fenix_remote_entry_t *rentry = &(version->remote_entry[version->position]);
-    retval = FENIX_SUCCESS;
+    fenix_group_t *group = (fenix.data_recovery->group[group_index]);
+    retval = group->vtbl.member_storev(group, memberid, specifier);
   }
   return retval;
-
 }
-#endif
 
-#if 0
 /**
  * @brief
  * @param group_id
@@ -503,35 +615,205 @@ int __fenix_member_storev(int group_id, int member_id, Fenix_Data_subset subset_
  * @param subset_specifier
  * @param request 
  */
-int __fenix_member_istorev(int group_id, int member_id, Fenix_Data_subset subset_specifier,
+int __fenix_member_istorev(int groupid, int memberid, Fenix_Data_subset specifier,
                    Fenix_Request *request) {
-
   int retval = -1;
-  int group_index = __fenix_search_groupid(group_id, __fenixi_g_data_recovery );
-  int member_index = __fenix_search_memberid(group_index, member_id);
+  int group_index = __fenix_search_groupid(groupid, fenix.data_recovery );
+  int member_index = -1;
+
+  if (group_index !=-1 && memberid != FENIX_DATA_MEMBER_ALL) {
+    member_index = __fenix_search_memberid(fenix.data_recovery->group[group_index]->member, memberid );
+  }
+
   if (group_index == -1) {
-    debug_print("ERROR Fenix_Data_member_istorev: group_id <%d> does not exist\n",
-                group_id);
+    debug_print("ERROR Fenix_Data_member_istorev: group_id <%d> does not exist\n", groupid);
     retval = FENIX_ERROR_INVALID_GROUPID;
   } else if (member_index == -1) {
     debug_print("ERROR Fenix_Data_member_istorev: member_id <%d> does not exist\n",
-                member_id);
+                memberid);
     retval = FENIX_ERROR_INVALID_MEMBERID;
   } else {
-    fenix_group_t *group = fenix.data_recovery;
-    fenix_group_entry_t *gentry = &(group->group_entry[group_index]);
-    fenix_member_t *member = &(gentry->member);
-    __fenix_ensure_version_capacity(member);
-    fenix_member_entry_t *mentry = &(member->member_entry[member_index]);
-    fenix_version_t *version = &(mentry->version);
-    fenix_local_entry_t *lentry = &(version->local_entry[version->position]);
-    fenix_remote_entry_t *rentry = &(version->remote_entry[version->position]);
-    retval = FENIX_SUCCESS;
+    fenix_group_t *group = (fenix.data_recovery->group[group_index]);
+    retval = group->vtbl.member_istorev(group, memberid, specifier, request);
+  }
+  return retval;
+}
+
+/**
+ * @brief Moves the dirty tracking of every member in the group on to the
+ *        next snapshot.
+ * @param group
+ */
+void __fenix_group_commit_dirty(fenix_group_t *group) {
+  for (int member_index = 0; member_index < group->member->total_size; member_index++) {
+    fenix_member_entry_t *mentry = &(group->member->member_entry[member_index]);
+    if (mentry->state == OCCUPIED && mentry->dirty != NULL) {
+      __fenix_dirty_commit(mentry->dirty);
+    }
+  }
+}
+
+/**
+ * @brief Plans storing member_id (or every member, with
+ *        FENIX_DATA_MEMBER_ALL) with subset_specifier, so repeated stores of
+ *        the same shape skip the lookups and setup a store normally does.
+ *        Plans have to be freed before their group is deleted.
+ * @param group_id
+ * @param member_id
+ * @param subset_specifier
+ * @param plan
+ */
+/**
+ * @brief Splits a plan's members into the ones with dirty tracking, stored
+ *        on their own, and the rest, planned by the policy.
+ * @param plan
+ */
+void __fenix_store_plan_split(fenix_store_plan_t *plan) {
+  fenix_group_t *group = plan->group;
+  if (plan->policy_plan != NULL) {
+    group->vtbl.store_plan_free(group, plan->policy_plan);
+    plan->policy_plan = NULL;
+  }
+
+  int *untracked = (int *) s_malloc((plan->num_members + 1) * sizeof(int));
+  int num_untracked = 0;
+  int index;
+  for (index = 0; index < plan->num_members; index++) {
+    int member_index = __fenix_search_memberid(group->member, plan->memberids[index]);
+    plan->tracked[index] = member_index != -1
+            && group->member->member_entry[member_index].dirty != NULL;
+    if (!plan->tracked[index]) untracked[num_untracked++] = plan->memberids[index];
+  }
+
+  if (group->vtbl.store_plan_create != NULL && num_untracked > 0) {
+    plan->policy_plan = group->vtbl.store_plan_create(group, untracked, num_untracked,
+            &(plan->subset));
+  }
+  free(untracked);
+  plan->stale = 0;
+}
+
+/**
+ * @brief Releases what the policy keeps for each of the group's plans, before
+ *        the group goes away. The plans themselves are the user's to free.
+ * @param group
+ */
+void __fenix_group_release_plans(fenix_group_t *group) {
+  fenix_store_plan_t *plan = group->plans;
+  while (plan != NULL) {
+    fenix_store_plan_t *next = plan->next;
+    if (plan->policy_plan != NULL) {
+      group->vtbl.store_plan_free(group, plan->policy_plan);
+      plan->policy_plan = NULL;
+    }
+    plan->group = NULL;
+    plan->next = NULL;
+    plan = next;
   }
+  group->plans = NULL;
+}
 
+int __fenix_store_plan_create(int groupid, int memberid, Fenix_Data_subset specifier,
+                              Fenix_Store_plan *plan) {
+  int retval = FENIX_SUCCESS;
+  int group_index = __fenix_search_groupid(groupid, fenix.data_recovery );
+  int member_index = -1;
+
+  if (group_index != -1 && memberid != FENIX_DATA_MEMBER_ALL) {
+    member_index = __fenix_search_memberid(fenix.data_recovery->group[group_index]->member, memberid );
+  }
+
+  if (group_index == -1) {
+    debug_print("ERROR Fenix_Data_store_plan_create: group_id <%d> does not exist\n", groupid);
+    return FENIX_ERROR_INVALID_GROUPID;
+  } else if (memberid != FENIX_DATA_MEMBER_ALL && member_index == -1) {
+    debug_print("ERROR Fenix_Data_store_plan_create: member_id <%d> does not exist\n",
+                memberid);
+    return FENIX_ERROR_INVALID_MEMBERID;
+  }
+
+  fenix_group_t *group = fenix.data_recovery->group[group_index];
+  fenix_member_t *member = group->member;
+  fenix_store_plan_t *new_plan = (fenix_store_plan_t *) s_malloc(sizeof(fenix_store_plan_t));
+  new_plan->groupid = groupid;
+  new_plan->group = group;
+  new_plan->num_members = 0;
+  new_plan->memberids = (int *) s_malloc((member->total_size + 1) * sizeof(int));
+  new_plan->tracked = (int *) s_malloc((member->total_size + 1) * sizeof(int));
+  __fenix_data_subset_deep_copy(&specifier, &(new_plan->subset));
+
+  size_t index;
+  for (index = 0; index < member->total_size; index++) {
+    fenix_member_entry_t *mentry = &(member->member_entry[index]);
+    if (mentry->state == EMPTY || mentry->state == DELETED) continue;
+    if (memberid != FENIX_DATA_MEMBER_ALL && index != member_index) continue;
+
+    new_plan->memberids[new_plan->num_members++] = mentry->memberid;
+  }
+
+  new_plan->policy_plan = NULL;
+  __fenix_store_plan_split(new_plan);
+  new_plan->next = group->plans;
+  group->plans = new_plan;
+
+  *plan = new_plan;
   return retval;
 }
-#endif
+
+/**
+ * @brief Stores every member of a plan, collective like a regular store.
+ * @param plan
+ */
+int __fenix_plan_store(Fenix_Store_plan plan) {
+  int retval = FENIX_SUCCESS;
+  if (plan->group == NULL) {
+    debug_print("ERROR Fenix_Data_plan_store: group_id <%d> no longer exists\n", plan->groupid);
+    return FENIX_ERROR_INVALID_GROUPID;
+  }
+
+  if (plan->stale) {
+    __fenix_store_plan_split(plan);
+  }
+
+  int index;
+  for (index = 0; index < plan->num_members; index++) {
+    if (plan->policy_plan != NULL && !plan->tracked[index]) continue;
+    int result = __fenix_member_store(plan->groupid, plan->memberids[index], plan->subset);
+    if (result != FENIX_SUCCESS) retval = result;
+  }
+
+  if (plan->policy_plan != NULL) {
+    int result = plan->group->vtbl.store_plan_start(plan->group, plan->policy_plan);
+    if (result != FENIX_SUCCESS) retval = result;
+  }
+  return retval;
+}
+
+/**
+ * @brief
+ * @param plan
+ */
+int __fenix_store_plan_free(Fenix_Store_plan *plan) {
+  fenix_store_plan_t *old_plan = *plan;
+
+  if (old_plan->group != NULL) {
+    fenix_store_plan_t **link = &(old_plan->group->plans);
+    while (*link != old_plan) {
+      link = &((*link)->next);
+    }
+    *link = old_plan->next;
+
+    if (old_plan->policy_plan != NULL) {
+      old_plan->group->vtbl.store_plan_free(old_plan->group, old_plan->policy_plan);
+    }
+  }
+  __fenix_data_subset_free(&(old_plan->subset));
+  free(old_plan->memberids);
+  free(old_plan->tracked);
+  free(old_plan);
+  *plan = NULL;
+  return FENIX_SUCCESS;
+}
 
 /**
  * @brief
@@ -553,6 +835,7 @@ int __fenix_data_commit(int groupid, int *timestamp) {
     fenix_group_t *group = (fenix.data_recovery->group[group_index]);
     
     group->vtbl.commit(group);
+    __fenix_group_commit_dirty(group);
 
     if (group->timestamp +1 -1) group->timestamp++;
     else group->timestamp = group->timestart;
@@ -585,6 +868,7 @@ int __fenix_data_commit_barrier(int groupid, int *timestamp) {
     fenix_group_t *group = (fenix.data_recovery->group[group_index]);
     
     retval = group->vtbl.commit(group);
+    __fenix_group_commit_dirty(group);
     
     int min_timestamp;
     MPI_Allreduce( &(group->timestamp), &min_timestamp, 1, MPI_INT, MPI_MIN,  group->comm );
@@ -626,6 +910,13 @@ int __fenix_member_restore(int groupid, int memberid, void *data, int maxcount,
     retval = FENIX_ERROR_INVALID_GROUPID;
   } else {
     fenix_group_t *group = (fenix.data_recovery->group[group_index]);
+
+    //Recovery can rebuild the snapshots, don't count on what they held. This
+    //also opens up the pages for restoring into.
+    if (member_index != -1 && group->member->member_entry[member_index].dirty != NULL) {
+      __fenix_dirty_reset(group->member->member_entry[member_index].dirty);
+    }
+
     retval = group->vtbl.member_restore(group, memberid, data, maxcount, timestamp, data_found);
   }
   return retval;
@@ -795,13 +1086,51 @@ int __fenix_member_get_attribute(int groupid, int memberid, int attributename,
     fenix_member_t *member = group->member;
     fenix_member_entry_t *mentry = &(member->member_entry[member_index]);
 
-    int retval = group->vtbl.member_get_attribute(group, mentry, attributename,
-            attributevalue, flag, sourcerank);
+    switch (attributename) {
+      case FENIX_DATA_MEMBER_ATTRIBUTE_BUFFER:
+        *((void **) (attributevalue)) = mentry->user_data;
+        retval = FENIX_SUCCESS;
+        break;
+      case FENIX_DATA_MEMBER_ATTRIBUTE_COUNT:
+        *((int *) (attributevalue)) = mentry->current_count;
+        retval = FENIX_SUCCESS;
+        break;
+      case FENIX_DATA_MEMBER_ATTRIBUTE_DATATYPE:
+        *((MPI_Datatype *) (attributevalue)) = mentry->current_datatype;
+        retval = FENIX_SUCCESS;
+        break;
+      case FENIX_DATA_MEMBER_ATTRIBUTE_DIRTY_TRACKING:
+        *((int *) (attributevalue)) = mentry->dirty != NULL;
+        retval = FENIX_SUCCESS;
+        break;
 
+      default:
+        //Anything else belongs to the policy.
+        retval = group->vtbl.member_get_attribute(group, mentry, attributename,
+                attributevalue, flag, sourcerank);
+        if (retval) {
+          debug_print("ERROR Fenix_Data_member_attr_get: invalid attribute_name <%d>\n",
+                      attributename);
+          retval = FENIX_ERROR_INVALID_ATTRIBUTE_NAME;
+        }
+        break;
+    }
   }
   return retval;
 }
 
+/**
+ * @brief Follows the member's buffer after its location or size changes,
+ *        if it is being tracked.
+ * @param mentry
+ */
+void __fenix_member_retrack_dirty(fenix_member_entry_t *mentry) {
+  if (mentry->dirty == NULL) return;
+  __fenix_dirty_untrack(mentry->dirty);
+  mentry->dirty = __fenix_dirty_track(mentry->user_data,
+          (size_t)mentry->current_count * mentry->datatype_size);
+}
+
 /**
  * @brief
  * @param group_id
@@ -850,9 +1179,16 @@ int __fenix_member_set_attribute(int groupid, int memberid, int attributename,
     switch (attributename) {
       case FENIX_DATA_MEMBER_ATTRIBUTE_BUFFER:
         mentry->user_data = attributevalue;
+        __fenix_member_retrack_dirty(mentry);
+        retval = FENIX_SUCCESS;
+        break;
+      case FENIX_DATA_MEMBER_ATTRIBUTE_BUFFER_LIST:
+        retval = __fenix_data_member_set_buffer_list(mentry,
+                (Fenix_Data_buffer_list *) attributevalue);
         break;
       case FENIX_DATA_MEMBER_ATTRIBUTE_COUNT:
         mentry->current_count = *((int *) (attributevalue));
+        __fenix_member_retrack_dirty(mentry);
         retval = FENIX_SUCCESS;
         break;
       case FENIX_DATA_MEMBER_ATTRIBUTE_DATATYPE:
@@ -868,6 +1204,20 @@ int __fenix_member_set_attribute(int groupid, int memberid, int attributename,
 
         mentry->current_datatype = *((MPI_Datatype *)(attributevalue));
         mentry->datatype_size = my_datatype_size;
+        __fenix_member_retrack_dirty(mentry);
+        retval = FENIX_SUCCESS;
+        break;
+      case FENIX_DATA_MEMBER_ATTRIBUTE_DIRTY_TRACKING:
+        __fenix_dirty_untrack(mentry->dirty);
+        mentry->dirty = NULL;
+        if (*((int *) (attributevalue))) {
+          mentry->dirty = __fenix_dirty_track(mentry->user_data,
+                  (size_t)mentry->current_count * mentry->datatype_size);
+        }
+        //Tracked members leave the policy's plans, untracked ones join them.
+        for (fenix_store_plan_t *plan = group->plans; plan != NULL; plan = plan->next) {
+          plan->stale = 1;
+        }
         retval = FENIX_SUCCESS;
         break;
       
@@ -904,6 +1254,14 @@ int __fenix_snapshot_delete(int group_id, int time_stamp) {
   } else {
     fenix_group_t *group = (fenix.data_recovery->group[group_index]);
     retval = group->vtbl.snapshot_delete(group, time_stamp);
+
+    //Pages last stored in the deleted snapshot have to be stored again.
+    for (int member_index = 0; member_index < group->member->total_size; member_index++) {
+      fenix_member_entry_t *mentry = &(group->member->member_entry[member_index]);
+      if (mentry->state == OCCUPIED && mentry->dirty != NULL) {
+        __fenix_dirty_reset(mentry->dirty);
+      }
+    }
   }
   return retval;
 }
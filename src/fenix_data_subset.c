@@ -673,7 +673,7 @@ void* __fenix_data_subset_serialize(Fenix_Data_subset* ss, void* src, size_t typ
    } else if(ss->specifier == __FENIX_SUBSET_EMPTY) {
 
       dest = NULL;
-      size = 0;
+      *size = 0;
 
    } else {
       //First, count up the number of entries to find a size.
@@ -746,6 +746,185 @@ void __fenix_data_subset_deserialize(Fenix_Data_subset* ss, void* src, void* des
 
 }
 
+int __fenix_data_subset_region_compare(const void* a, const void* b){
+   const int* first = (const int*)a;
+   const int* second = (const int*)b;
+   return (first[0] > second[0]) - (first[0] < second[0]);
+}
+
+//Lists the contiguous regions of subset ss (in elements) in ascending order, with
+//overlapping and adjacent ones merged. Without overlaps that is the order serialize
+//packs them in. starts and lengths are set to arrays the user is responsible for
+//freeing. Returns the number of regions.
+int __fenix_data_subset_get_regions(Fenix_Data_subset* ss, size_t max_size, int** starts, int** lengths){
+   int num_regions = 0;
+   *starts = NULL;
+   *lengths = NULL;
+
+   if(ss->specifier == __FENIX_SUBSET_FULL){
+      if(max_size > 0){
+         num_regions = 1;
+         *starts = (int*) s_malloc(sizeof(int));
+         *lengths = (int*) s_malloc(sizeof(int));
+         (*starts)[0] = 0;
+         (*lengths)[0] = max_size;
+      }
+   } else if(ss->specifier != __FENIX_SUBSET_EMPTY){
+      for(int i = 0; i < ss->num_blocks; i++){
+         num_regions += ss->num_repeats[i] + 1;
+      }
+
+      //Sort (start, length) pairs together.
+      int* regions = (int*) s_malloc(2 * num_regions * sizeof(int));
+      int index = 0;
+      for(int i = 0; i < ss->num_blocks; i++){
+         for(int j = 0; j <= ss->num_repeats[i]; j++){
+            regions[2*index] = ss->start_offsets[i] + j*ss->stride;
+            regions[2*index + 1] = ss->end_offsets[i] - ss->start_offsets[i] + 1;
+            index++;
+         }
+      }
+      qsort(regions, num_regions, 2*sizeof(int), __fenix_data_subset_region_compare);
+
+      //Datatypes built from these can't describe an element twice.
+      int merged = 0;
+      for(int i = 1; i < num_regions; i++){
+         int end = regions[2*merged] + regions[2*merged + 1];
+         if(regions[2*i] <= end){
+            int new_end = regions[2*i] + regions[2*i + 1];
+            if(new_end > end) regions[2*merged + 1] = new_end - regions[2*merged];
+         } else {
+            merged++;
+            regions[2*merged] = regions[2*i];
+            regions[2*merged + 1] = regions[2*i + 1];
+         }
+      }
+      if(num_regions > 0) num_regions = merged + 1;
+
+      *starts = (int*) s_malloc(num_regions * sizeof(int));
+      *lengths = (int*) s_malloc(num_regions * sizeof(int));
+      for(int i = 0; i < num_regions; i++){
+         (*starts)[i] = regions[2*i];
+         (*lengths)[i] = regions[2*i + 1];
+      }
+      free(regions);
+   }
+
+   return num_regions;
+}
+
+//Compiled subset datatypes, least recently used is evicted once full.
+#define __FENIX_SUBSET_TYPE_CACHE_SIZE 32
+
+typedef struct {
+   Fenix_Data_subset subset;
+   size_t type_size;
+   size_t max_size;
+   MPI_Datatype type;
+   unsigned long last_used;
+} fenix_subset_type_entry_t;
+
+static fenix_subset_type_entry_t __fenix_subset_type_cache[__FENIX_SUBSET_TYPE_CACHE_SIZE];
+static int __fenix_subset_type_cache_count = 0;
+static unsigned long __fenix_subset_type_cache_clock = 0;
+
+int __fenix_data_subset_equal(Fenix_Data_subset* first, Fenix_Data_subset* second){
+   if(first->specifier != second->specifier) return 0;
+   if(first->specifier == __FENIX_SUBSET_FULL || first->specifier == __FENIX_SUBSET_EMPTY) return 1;
+
+   return first->num_blocks == second->num_blocks && first->stride == second->stride
+      && !memcmp(first->start_offsets, second->start_offsets, first->num_blocks*sizeof(int))
+      && !memcmp(first->end_offsets, second->end_offsets, first->num_blocks*sizeof(int))
+      && !memcmp(first->num_repeats, second->num_repeats, first->num_blocks*sizeof(int));
+}
+
+//Builds a datatype selecting subset ss's regions of a buffer of max_size
+//elements, in the same order serialize would pack them but each element once.
+void __fenix_data_subset_build_type(Fenix_Data_subset* ss, size_t type_size, size_t max_size,
+      MPI_Datatype* type){
+   MPI_Datatype element;
+   MPI_Type_contiguous(type_size, MPI_BYTE, &element);
+
+   if(ss->specifier == __FENIX_SUBSET_FULL){
+      MPI_Type_contiguous(max_size, element, type);
+   } else if(ss->specifier == __FENIX_SUBSET_EMPTY){
+      MPI_Type_contiguous(0, element, type);
+   } else if(ss->num_blocks == 1 && (ss->num_repeats[0] == 0 ||
+         ss->end_offsets[0] - ss->start_offsets[0] < ss->stride)){
+      //A single repeated block is just a strided vector, if repeats don't overlap.
+      MPI_Datatype vector;
+      MPI_Aint displacement = (MPI_Aint)ss->start_offsets[0] * type_size;
+      MPI_Type_create_hvector(ss->num_repeats[0] + 1, ss->end_offsets[0] - ss->start_offsets[0] + 1,
+            (MPI_Aint)ss->stride * type_size, element, &vector);
+      MPI_Type_create_hindexed_block(1, 1, &displacement, vector, type);
+      MPI_Type_free(&vector);
+   } else {
+      int *starts, *lengths;
+      int num_regions = __fenix_data_subset_get_regions(ss, max_size, &starts, &lengths);
+
+      MPI_Aint* displacements = (MPI_Aint*) s_malloc(num_regions * sizeof(MPI_Aint));
+      for(int i = 0; i < num_regions; i++){
+         displacements[i] = (MPI_Aint)starts[i] * type_size;
+      }
+      MPI_Type_create_hindexed(num_regions, lengths, displacements, element, type);
+
+      free(displacements);
+      free(starts);
+      free(lengths);
+   }
+
+   MPI_Type_commit(type);
+   MPI_Type_free(&element);
+}
+
+//Sets type to a datatype which sends or receives subset ss of a buffer of
+//max_size elements of type_size bytes in place. Types are cached across calls
+//and owned by the cache, callers must not free them.
+void __fenix_data_subset_get_type(Fenix_Data_subset* ss, size_t type_size, size_t max_size,
+      MPI_Datatype* type){
+   fenix_subset_type_entry_t* entry = NULL;
+   for(int i = 0; i < __fenix_subset_type_cache_count; i++){
+      fenix_subset_type_entry_t* candidate = __fenix_subset_type_cache + i;
+      if(candidate->type_size == type_size && candidate->max_size == max_size
+            && __fenix_data_subset_equal(&(candidate->subset), ss)){
+         entry = candidate;
+         break;
+      }
+   }
+
+   if(entry == NULL){
+      if(__fenix_subset_type_cache_count < __FENIX_SUBSET_TYPE_CACHE_SIZE){
+         entry = __fenix_subset_type_cache + __fenix_subset_type_cache_count++;
+      } else {
+         entry = __fenix_subset_type_cache;
+         for(int i = 1; i < __FENIX_SUBSET_TYPE_CACHE_SIZE; i++){
+            if(__fenix_subset_type_cache[i].last_used < entry->last_used){
+               entry = __fenix_subset_type_cache + i;
+            }
+         }
+         //Any communication still using the type completes normally.
+         MPI_Type_free(&(entry->type));
+         __fenix_data_subset_free(&(entry->subset));
+      }
+
+      __fenix_data_subset_deep_copy(ss, &(entry->subset));
+      entry->type_size = type_size;
+      entry->max_size = max_size;
+      __fenix_data_subset_build_type(ss, type_size, max_size, &(entry->type));
+   }
+
+   entry->last_used = ++__fenix_subset_type_cache_clock;
+   *type = entry->type;
+}
+
+void __fenix_data_subset_free_type_cache(){
+   for(int i = 0; i < __fenix_subset_type_cache_count; i++){
+      MPI_Type_free(&(__fenix_subset_type_cache[i].type));
+      __fenix_data_subset_free(&(__fenix_subset_type_cache[i].subset));
+   }
+   __fenix_subset_type_cache_count = 0;
+}
+
 void __fenix_data_subset_send(Fenix_Data_subset* ss, int dest, int tag, MPI_Comm comm){
    int* toSend = (int*)malloc(sizeof(int) * (3 + 3*ss->num_blocks));
    toSend[0] = ss->num_blocks;
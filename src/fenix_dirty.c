@@ -0,0 +1,287 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//
+//            _|_|_|_|  _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//            _|        _|        _|_|    _|    _|      _|  _|
+//            _|_|_|    _|_|_|    _|  _|  _|    _|        _|
+//            _|        _|        _|    _|_|    _|      _|  _|
+//            _|        _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//
+//
+//
+//
+// Copyright (C) 2016 Rutgers University and Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author Marc Gamell, Eric Valenzuela, Keita Teranishi, Manish Parashar,
+//        Michael Heroux, and Matthew Whitlock
+//
+// Questions? Contact Keita Teranishi (knteran@sandia.gov) and
+//                    Marc Gamell (mgamell@cac.rutgers.edu)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "fenix_opt.h"
+#include "fenix_util.h"
+#include "fenix_dirty.h"
+
+typedef struct __fenix_dirty_region {
+   //Page aligned start of the pages the buffer touches. The first and last
+   //may be shared with other allocations, only pages in [first_full,
+   //end_full) lie wholly inside the buffer and are ever protected. The rest
+   //always count as dirty.
+   char* base;
+   size_t num_pages;
+   size_t first_full, end_full;
+   char* data;
+   size_t size;
+   //Written by the fault handler. Both live in a mapping of their own, so
+   //they are never on a protected page.
+   volatile unsigned char* dirty;
+   //Commit the page was last stored for, -1 if it hasn't been.
+   int* stored_at;
+   void* metadata;
+   size_t metadata_size;
+   int epoch;
+   struct __fenix_dirty_region* next;
+} fenix_dirty_region_t;
+
+static fenix_dirty_region_t* __fenix_dirty_regions = NULL;
+static struct sigaction __fenix_dirty_previous;
+static size_t __fenix_dirty_page_size = 0;
+
+static int __fenix_dirty_full(fenix_dirty_region_t* region, size_t page){
+   return page >= region->first_full && page < region->end_full;
+}
+
+//Sets the protection of the region's full pages.
+static void __fenix_dirty_protect_full(fenix_dirty_region_t* region, int protection){
+   if(region->end_full > region->first_full){
+      mprotect(region->base + region->first_full*__fenix_dirty_page_size,
+            (region->end_full - region->first_full)*__fenix_dirty_page_size, protection);
+   }
+}
+
+static void __fenix_dirty_handler(int sig, siginfo_t* info, void* context){
+   char* address = (char*)info->si_addr;
+   int handled = 0;
+
+   for(fenix_dirty_region_t* region = __fenix_dirty_regions; region != NULL; region = region->next){
+      if(address < region->base) continue;
+      size_t page = (address - region->base)/__fenix_dirty_page_size;
+      if(!__fenix_dirty_full(region, page)) continue;
+      region->dirty[page] = 1;
+      mprotect(region->base + page*__fenix_dirty_page_size, __fenix_dirty_page_size,
+            PROT_READ | PROT_WRITE);
+      handled = 1;
+   }
+   if(handled) return;
+
+   //Not one of ours, pass it along to whatever was there before.
+   if(__fenix_dirty_previous.sa_flags & SA_SIGINFO){
+      __fenix_dirty_previous.sa_sigaction(sig, info, context);
+   } else if(__fenix_dirty_previous.sa_handler == SIG_DFL
+         || __fenix_dirty_previous.sa_handler == SIG_IGN){
+      //Retrying the access with the old action in place fails as it would have.
+      sigaction(SIGSEGV, &__fenix_dirty_previous, NULL);
+   } else {
+      __fenix_dirty_previous.sa_handler(sig);
+   }
+}
+
+fenix_dirty_region_t* __fenix_dirty_track(void* data, size_t size){
+   if(__fenix_dirty_page_size == 0){
+      __fenix_dirty_page_size = sysconf(_SC_PAGESIZE);
+   }
+
+   fenix_dirty_region_t* region = (fenix_dirty_region_t*) s_malloc(sizeof(fenix_dirty_region_t));
+   region->data = (char*)data;
+   region->size = size;
+   region->base = (char*)((size_t)data - (size_t)data%__fenix_dirty_page_size);
+   region->num_pages = (region->data + size - region->base + __fenix_dirty_page_size - 1)
+         / __fenix_dirty_page_size;
+   region->first_full = region->data == region->base ? 0 : 1;
+   region->end_full = (region->data + size - region->base)/__fenix_dirty_page_size;
+   if(region->end_full < region->first_full) region->end_full = region->first_full;
+   region->epoch = 0;
+
+   //A heap allocation could end up next to, or inside, a tracked buffer's
+   //edge pages, so the handler's bookkeeping gets a mapping of its own.
+   region->metadata_size = region->num_pages * (sizeof(int) + 1);
+   if(region->metadata_size == 0) region->metadata_size = 1;
+   region->metadata = mmap(NULL, region->metadata_size, PROT_READ | PROT_WRITE,
+         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+   if(region->metadata == MAP_FAILED){
+      debug_print("Out of memory: mmap failed on %lu bytes of dirty tracking.\n",
+            (unsigned long) region->metadata_size);
+      free(region);
+      return NULL;
+   }
+   region->stored_at = (int*) region->metadata;
+   region->dirty = (volatile unsigned char*)(region->stored_at + region->num_pages);
+
+   //Pages stay writable until they are first stored.
+   memset((void*)region->dirty, 1, region->num_pages);
+   for(size_t page = 0; page < region->num_pages; page++){
+      region->stored_at[page] = -1;
+   }
+
+   if(__fenix_dirty_regions == NULL){
+      struct sigaction action;
+      memset(&action, 0, sizeof(action));
+      action.sa_sigaction = __fenix_dirty_handler;
+      action.sa_flags = SA_SIGINFO;
+      sigemptyset(&action.sa_mask);
+      sigaction(SIGSEGV, &action, &__fenix_dirty_previous);
+   }
+   region->next = __fenix_dirty_regions;
+   __fenix_dirty_regions = region;
+
+   return region;
+}
+
+void __fenix_dirty_untrack(fenix_dirty_region_t* region){
+   if(region == NULL) return;
+
+   fenix_dirty_region_t** link = &__fenix_dirty_regions;
+   while(*link != region) link = &((*link)->next);
+   *link = region->next;
+
+   __fenix_dirty_protect_full(region, PROT_READ | PROT_WRITE);
+   if(__fenix_dirty_regions == NULL){
+      sigaction(SIGSEGV, &__fenix_dirty_previous, NULL);
+   }
+
+   munmap(region->metadata, region->metadata_size);
+   free(region);
+}
+
+//Whether a page has to go into the next store.
+int __fenix_dirty_needed(fenix_dirty_region_t* region, size_t page, int depth){
+   return !__fenix_dirty_full(region, page) || region->dirty[page] || region->stored_at[page] < 0
+         || region->epoch - region->stored_at[page] > depth;
+}
+
+//Range of elements with bytes on a page.
+void __fenix_dirty_page_elements(fenix_dirty_region_t* region, size_t page, int type_size,
+        int* first, int* last){
+   char* start = region->base + page*__fenix_dirty_page_size;
+   char* end = start + __fenix_dirty_page_size;
+   if(start < region->data) start = region->data;
+   if(end > region->data + region->size) end = region->data + region->size;
+   *first = (start - region->data)/type_size;
+   *last = (end - region->data - 1)/type_size;
+}
+
+void __fenix_dirty_collect(fenix_dirty_region_t* region, int type_size, int count,
+        int depth, MPI_Comm comm, Fenix_Data_subset* subset){
+   //Ranks' buffers sit differently within pages, so they agree on blocks of
+   //about a page worth of elements instead.
+   int block_size = __fenix_dirty_page_size/type_size;
+   if(block_size == 0) block_size = 1;
+   int num_blocks = (count + block_size - 1)/block_size;
+   unsigned char* blocks = (unsigned char*) s_calloc(num_blocks, 1);
+
+   int first, last;
+   for(size_t page = 0; page < region->num_pages; page++){
+      if(!__fenix_dirty_needed(region, page, depth)) continue;
+      __fenix_dirty_page_elements(region, page, type_size, &first, &last);
+      memset(blocks + first/block_size, 1, last/block_size - first/block_size + 1);
+   }
+   MPI_Allreduce(MPI_IN_PLACE, blocks, num_blocks, MPI_UNSIGNED_CHAR, MPI_BOR, comm);
+
+   //Full pages wholly inside the stored blocks are up to date again.
+   size_t protect_from = 0;
+   for(size_t page = 0; page <= region->num_pages; page++){
+      int stored = 0;
+      if(page < region->num_pages && __fenix_dirty_full(region, page)){
+         __fenix_dirty_page_elements(region, page, type_size, &first, &last);
+         stored = memchr(blocks + first/block_size, 0, last/block_size - first/block_size + 1) == NULL;
+      }
+      if(stored){
+         region->dirty[page] = 0;
+         region->stored_at[page] = region->epoch;
+         continue;
+      }
+      if(page > protect_from){
+         mprotect(region->base + protect_from*__fenix_dirty_page_size,
+               (page - protect_from)*__fenix_dirty_page_size, PROT_READ);
+      }
+      protect_from = page + 1;
+   }
+
+   int num_runs = 0;
+   int* starts = (int*) s_malloc(num_blocks * sizeof(int));
+   int* ends = (int*) s_malloc(num_blocks * sizeof(int));
+   for(int block = 0; block < num_blocks; block++){
+      if(!blocks[block]) continue;
+      if(num_runs > 0 && ends[num_runs-1] == block*block_size - 1){
+         ends[num_runs-1] += block_size;
+      } else {
+         starts[num_runs] = block*block_size;
+         ends[num_runs] = block*block_size + block_size - 1;
+         num_runs++;
+      }
+   }
+   if(num_runs > 0 && ends[num_runs-1] >= count) ends[num_runs-1] = count - 1;
+
+   if(num_runs == 0){
+      __fenix_data_subset_init(1, subset);
+      subset->specifier = __FENIX_SUBSET_EMPTY;
+   } else {
+      __fenix_data_subset_createv(num_runs, starts, ends, subset);
+   }
+
+   free(blocks);
+   free(starts);
+   free(ends);
+}
+
+void __fenix_dirty_commit(fenix_dirty_region_t* region){
+   region->epoch++;
+}
+
+void __fenix_dirty_reset(fenix_dirty_region_t* region){
+   __fenix_dirty_protect_full(region, PROT_READ | PROT_WRITE);
+   for(size_t page = 0; page < region->num_pages; page++){
+      region->dirty[page] = 1;
+      region->stored_at[page] = -1;
+   }
+}
@@ -0,0 +1,254 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//
+//            _|_|_|_|  _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//            _|        _|        _|_|    _|    _|      _|  _|
+//            _|_|_|    _|_|_|    _|  _|  _|    _|        _|
+//            _|        _|        _|    _|_|    _|      _|  _|
+//            _|        _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//
+//
+//
+//
+// Copyright (C) 2016 Rutgers University and Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author Marc Gamell, Eric Valenzuela, Keita Teranishi, Manish Parashar,
+//        Michael Heroux, and Matthew Whitlock
+//
+// Questions? Contact Keita Teranishi (knteran@sandia.gov) and
+//                    Marc Gamell (mgamell@cac.rutgers.edu)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#include <string.h>
+#include "fenix_gf256.h"
+#include "fenix_xor.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define __FENIX_GF256_X86
+#include <immintrin.h>
+#endif
+
+#define __FENIX_GF256_SCALAR 0
+#define __FENIX_GF256_SSSE3  1
+#define __FENIX_GF256_AVX2   2
+
+static int __fenix_gf256_initialized = 0;
+static int __fenix_gf256_simd = __FENIX_GF256_SCALAR;
+//exp is doubled up so a product's log never needs reducing mod 255.
+static uint8_t __fenix_gf256_exp_table[510];
+static uint8_t __fenix_gf256_log_table[256];
+
+void __fenix_gf256_init(){
+   if(__fenix_gf256_initialized) return;
+
+   __fenix_xor_init();
+
+   int value = 1;
+   for(int power = 0; power < 255; power++){
+      __fenix_gf256_exp_table[power] = value;
+      __fenix_gf256_exp_table[power + 255] = value;
+      __fenix_gf256_log_table[value] = power;
+
+      value <<= 1;
+      if(value & 0x100) value ^= 0x11d;
+   }
+
+#ifdef __FENIX_GF256_X86
+   __builtin_cpu_init();
+   if(__builtin_cpu_supports("avx2")){
+      __fenix_gf256_simd = __FENIX_GF256_AVX2;
+   } else if(__builtin_cpu_supports("ssse3")){
+      __fenix_gf256_simd = __FENIX_GF256_SSSE3;
+   }
+#endif
+
+   __fenix_gf256_initialized = 1;
+}
+
+uint8_t __fenix_gf256_mul(uint8_t a, uint8_t b){
+   if(a == 0 || b == 0) return 0;
+   return __fenix_gf256_exp_table[__fenix_gf256_log_table[a] + __fenix_gf256_log_table[b]];
+}
+
+uint8_t __fenix_gf256_div(uint8_t a, uint8_t b){
+   if(a == 0) return 0;
+   return __fenix_gf256_exp_table[__fenix_gf256_log_table[a] + 255 - __fenix_gf256_log_table[b]];
+}
+
+uint8_t __fenix_gf256_exp(int power){
+   power %= 255;
+   if(power < 0) power += 255;
+   return __fenix_gf256_exp_table[power];
+}
+
+//c*x = c*(x & 0x0f) ^ c*(x & 0xf0), so two 16 entry tables cover every product
+//and fit in a vector register for byte shuffles.
+static void __fenix_gf256_nibble_tables(uint8_t c, uint8_t* low, uint8_t* high){
+   for(int x = 0; x < 16; x++){
+      low[x] = __fenix_gf256_mul(c, x);
+      high[x] = __fenix_gf256_mul(c, x << 4);
+   }
+}
+
+#ifdef __FENIX_GF256_X86
+__attribute__((target("ssse3")))
+static size_t __fenix_gf256_mul_ssse3(const uint8_t* low, const uint8_t* high, 
+        const uint8_t* in, uint8_t* out, size_t n, int accumulate){
+   __m128i low_table = _mm_loadu_si128((const __m128i*)low);
+   __m128i high_table = _mm_loadu_si128((const __m128i*)high);
+   __m128i mask = _mm_set1_epi8(0x0f);
+
+   size_t i = 0;
+   for(; i + 16 <= n; i += 16){
+      __m128i value = _mm_loadu_si128((const __m128i*)(in + i));
+      __m128i product = _mm_xor_si128(
+            _mm_shuffle_epi8(low_table, _mm_and_si128(value, mask)),
+            _mm_shuffle_epi8(high_table, _mm_and_si128(_mm_srli_epi64(value, 4), mask)));
+      if(accumulate) product = _mm_xor_si128(product, _mm_loadu_si128((const __m128i*)(out + i)));
+      _mm_storeu_si128((__m128i*)(out + i), product);
+   }
+   return i;
+}
+
+__attribute__((target("avx2")))
+static size_t __fenix_gf256_mul_avx2(const uint8_t* low, const uint8_t* high, 
+        const uint8_t* in, uint8_t* out, size_t n, int accumulate){
+   //Shuffles stay within 128 bit lanes, so each lane gets its own copy of the tables.
+   __m256i low_table = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)low));
+   __m256i high_table = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)high));
+   __m256i mask = _mm256_set1_epi8(0x0f);
+
+   size_t i = 0;
+   for(; i + 32 <= n; i += 32){
+      __m256i value = _mm256_loadu_si256((const __m256i*)(in + i));
+      __m256i product = _mm256_xor_si256(
+            _mm256_shuffle_epi8(low_table, _mm256_and_si256(value, mask)),
+            _mm256_shuffle_epi8(high_table, _mm256_and_si256(_mm256_srli_epi64(value, 4), mask)));
+      if(accumulate) product = _mm256_xor_si256(product, _mm256_loadu_si256((const __m256i*)(out + i)));
+      _mm256_storeu_si256((__m256i*)(out + i), product);
+   }
+   return i;
+}
+#endif
+
+static void __fenix_gf256_mul_region_common(uint8_t c, const void* src, void* dest, size_t n,
+        int accumulate){
+   const uint8_t* in = (const uint8_t*)src;
+   uint8_t* out = (uint8_t*)dest;
+
+   uint8_t low[16], high[16];
+   __fenix_gf256_nibble_tables(c, low, high);
+
+   size_t done = 0;
+#ifdef __FENIX_GF256_X86
+   if(__fenix_gf256_simd == __FENIX_GF256_AVX2){
+      done = __fenix_gf256_mul_avx2(low, high, in, out, n, accumulate);
+   } else if(__fenix_gf256_simd == __FENIX_GF256_SSSE3){
+      done = __fenix_gf256_mul_ssse3(low, high, in, out, n, accumulate);
+   }
+#endif
+
+   for(size_t i = done; i < n; i++){
+      uint8_t product = low[in[i] & 0x0f] ^ high[in[i] >> 4];
+      out[i] = accumulate ? out[i] ^ product : product;
+   }
+}
+
+void __fenix_gf256_mul_region(uint8_t c, const void* src, void* dest, size_t n){
+   if(c == 0){
+      memset(dest, 0, n);
+   } else if(c == 1){
+      memmove(dest, src, n);
+   } else {
+      __fenix_gf256_mul_region_common(c, src, dest, n, 0);
+   }
+}
+
+void __fenix_gf256_mul_region_xor(uint8_t c, const void* src, void* dest, size_t n){
+   if(c == 0){
+      return;
+   } else if(c == 1){
+      __fenix_xor_region(src, dest, n);
+   } else {
+      __fenix_gf256_mul_region_common(c, src, dest, n, 1);
+   }
+}
+
+int __fenix_gf256_invert_matrix(uint8_t* matrix, uint8_t* inverse, int size){
+   for(int row = 0; row < size; row++){
+      for(int col = 0; col < size; col++){
+         inverse[row*size + col] = (row == col);
+      }
+   }
+
+   //Gauss-Jordan elimination, matrix is reduced to the identity as we go.
+   for(int col = 0; col < size; col++){
+      int pivot = col;
+      while(pivot < size && matrix[pivot*size + col] == 0) pivot++;
+      if(pivot == size) return -1;
+
+      if(pivot != col){
+         for(int i = 0; i < size; i++){
+            uint8_t swap = matrix[col*size + i];
+            matrix[col*size + i] = matrix[pivot*size + i];
+            matrix[pivot*size + i] = swap;
+
+            swap = inverse[col*size + i];
+            inverse[col*size + i] = inverse[pivot*size + i];
+            inverse[pivot*size + i] = swap;
+         }
+      }
+
+      uint8_t scale = __fenix_gf256_div(1, matrix[col*size + col]);
+      for(int i = 0; i < size; i++){
+         matrix[col*size + i] = __fenix_gf256_mul(matrix[col*size + i], scale);
+         inverse[col*size + i] = __fenix_gf256_mul(inverse[col*size + i], scale);
+      }
+
+      for(int row = 0; row < size; row++){
+         uint8_t factor = matrix[row*size + col];
+         if(row == col || factor == 0) continue;
+         for(int i = 0; i < size; i++){
+            matrix[row*size + i] ^= __fenix_gf256_mul(factor, matrix[col*size + i]);
+            inverse[row*size + i] ^= __fenix_gf256_mul(factor, inverse[col*size + i]);
+         }
+      }
+   }
+
+   return 0;
+}
@@ -0,0 +1,142 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//
+//            _|_|_|_|  _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//            _|        _|        _|_|    _|    _|      _|  _|
+//            _|_|_|    _|_|_|    _|  _|  _|    _|        _|
+//            _|        _|        _|    _|_|    _|      _|  _|
+//            _|        _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//
+//
+//
+//
+// Copyright (C) 2016 Rutgers University and Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author Marc Gamell, Eric Valenzuela, Keita Teranishi, Manish Parashar,
+//        Michael Heroux, and Matthew Whitlock
+//
+// Questions? Contact Keita Teranishi (knteran@sandia.gov) and
+//                    Marc Gamell (mgamell@cac.rutgers.edu)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#include <string.h>
+#include "fenix_hash.h"
+
+//Straight port of the reference xxHash64, four independent lanes keep it
+//running close to memory bandwidth.
+#define __FENIX_HASH_PRIME1 0x9E3779B185EBCA87ULL
+#define __FENIX_HASH_PRIME2 0xC2B2AE3D27D4EB4FULL
+#define __FENIX_HASH_PRIME3 0x165667B19E3779F9ULL
+#define __FENIX_HASH_PRIME4 0x85EBCA77C2B2AE63ULL
+#define __FENIX_HASH_PRIME5 0x27D4EB2F165667C5ULL
+
+static inline uint64_t __fenix_hash_rotl(uint64_t x, int r){
+   return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t __fenix_hash_read64(const uint8_t* p){
+   uint64_t v;
+   memcpy(&v, p, sizeof(v));
+   return v;
+}
+
+static inline uint32_t __fenix_hash_read32(const uint8_t* p){
+   uint32_t v;
+   memcpy(&v, p, sizeof(v));
+   return v;
+}
+
+static inline uint64_t __fenix_hash_round(uint64_t acc, uint64_t input){
+   acc += input * __FENIX_HASH_PRIME2;
+   acc = __fenix_hash_rotl(acc, 31);
+   return acc * __FENIX_HASH_PRIME1;
+}
+
+static inline uint64_t __fenix_hash_merge(uint64_t acc, uint64_t lane){
+   acc ^= __fenix_hash_round(0, lane);
+   return acc * __FENIX_HASH_PRIME1 + __FENIX_HASH_PRIME4;
+}
+
+uint64_t __fenix_hash64(const void* data, size_t n){
+   const uint8_t* p = (const uint8_t*)data;
+   const uint8_t* end = p + n;
+   uint64_t hash;
+
+   if(n >= 32){
+      uint64_t v1 = __FENIX_HASH_PRIME1 + __FENIX_HASH_PRIME2;
+      uint64_t v2 = __FENIX_HASH_PRIME2;
+      uint64_t v3 = 0;
+      uint64_t v4 = -__FENIX_HASH_PRIME1;
+      for(; p + 32 <= end; p += 32){
+         v1 = __fenix_hash_round(v1, __fenix_hash_read64(p));
+         v2 = __fenix_hash_round(v2, __fenix_hash_read64(p + 8));
+         v3 = __fenix_hash_round(v3, __fenix_hash_read64(p + 16));
+         v4 = __fenix_hash_round(v4, __fenix_hash_read64(p + 24));
+      }
+      hash = __fenix_hash_rotl(v1, 1) + __fenix_hash_rotl(v2, 7)
+            + __fenix_hash_rotl(v3, 12) + __fenix_hash_rotl(v4, 18);
+      hash = __fenix_hash_merge(hash, v1);
+      hash = __fenix_hash_merge(hash, v2);
+      hash = __fenix_hash_merge(hash, v3);
+      hash = __fenix_hash_merge(hash, v4);
+   } else {
+      hash = __FENIX_HASH_PRIME5;
+   }
+   hash += n;
+
+   for(; p + 8 <= end; p += 8){
+      hash ^= __fenix_hash_round(0, __fenix_hash_read64(p));
+      hash = __fenix_hash_rotl(hash, 27) * __FENIX_HASH_PRIME1 + __FENIX_HASH_PRIME4;
+   }
+   if(p + 4 <= end){
+      hash ^= (uint64_t)__fenix_hash_read32(p) * __FENIX_HASH_PRIME1;
+      hash = __fenix_hash_rotl(hash, 23) * __FENIX_HASH_PRIME2 + __FENIX_HASH_PRIME3;
+      p += 4;
+   }
+   for(; p < end; p++){
+      hash ^= (*p) * __FENIX_HASH_PRIME5;
+      hash = __fenix_hash_rotl(hash, 11) * __FENIX_HASH_PRIME1;
+   }
+
+   hash ^= hash >> 33;
+   hash *= __FENIX_HASH_PRIME2;
+   hash ^= hash >> 29;
+   hash *= __FENIX_HASH_PRIME3;
+   hash ^= hash >> 32;
+   return hash;
+}
@@ -0,0 +1,113 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//
+//            _|_|_|_|  _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//            _|        _|        _|_|    _|    _|      _|  _|
+//            _|_|_|    _|_|_|    _|  _|  _|    _|        _|
+//            _|        _|        _|    _|_|    _|      _|  _|
+//            _|        _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//
+//
+//
+//
+// Copyright (C) 2016 Rutgers University and Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author Marc Gamell, Eric Valenzuela, Keita Teranishi, Manish Parashar,
+//        Michael Heroux, and Matthew Whitlock
+//
+// Questions? Contact Keita Teranishi (knteran@sandia.gov) and
+//                    Marc Gamell (mgamell@cac.rutgers.edu)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#include <unistd.h>
+#include <sys/syscall.h>
+#include "fenix_opt.h"
+#include "fenix_numa.h"
+
+//From linux/mempolicy.h.
+#define __FENIX_MPOL_PREFERRED       1
+#define __FENIX_MPOL_INTERLEAVE      3
+#define __FENIX_MPOL_F_NODE          (1 << 0)
+#define __FENIX_MPOL_F_ADDR          (1 << 1)
+#define __FENIX_MPOL_F_MEMS_ALLOWED  (1 << 2)
+
+#define __FENIX_NUMA_MAX_NODES 1024
+#define __FENIX_NUMA_MASK_WORDS (__FENIX_NUMA_MAX_NODES/(8*sizeof(unsigned long)))
+
+#if defined(SYS_mbind) && defined(SYS_get_mempolicy) && defined(SYS_getcpu)
+
+void __fenix_numa_place(void* addr, size_t size, int placement){
+   unsigned long mask[__FENIX_NUMA_MASK_WORDS] = {0};
+   int mode;
+
+   if(placement == __FENIX_NUMA_LOCAL){
+      unsigned cpu, node;
+      if(syscall(SYS_getcpu, &cpu, &node, NULL) != 0) return;
+      mask[node / (8*sizeof(unsigned long))] |= 1UL << (node % (8*sizeof(unsigned long)));
+      mode = __FENIX_MPOL_PREFERRED;
+   } else if(placement == __FENIX_NUMA_INTERLEAVE){
+      if(syscall(SYS_get_mempolicy, NULL, mask, __FENIX_NUMA_MAX_NODES, NULL,
+            __FENIX_MPOL_F_MEMS_ALLOWED) != 0) return;
+      mode = __FENIX_MPOL_INTERLEAVE;
+   } else {
+      return;
+   }
+
+   if(syscall(SYS_mbind, addr, size, mode, mask, __FENIX_NUMA_MAX_NODES + 1, 0) != 0){
+      debug_print("Warning: NUMA placement <%d> could not be applied to %lu bytes.\n",
+            placement, (unsigned long) size);
+   }
+}
+
+int __fenix_numa_node_of(void* addr){
+   int node;
+   if(syscall(SYS_get_mempolicy, &node, NULL, 0, addr, __FENIX_MPOL_F_NODE | __FENIX_MPOL_F_ADDR) != 0){
+      return -1;
+   }
+   return node;
+}
+
+#else
+
+void __fenix_numa_place(void* addr, size_t size, int placement){}
+
+int __fenix_numa_node_of(void* addr){
+   return -1;
+}
+
+#endif
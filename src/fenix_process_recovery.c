@@ -64,8 +64,17 @@
 #include "fenix_data_recovery.h"
 #include "fenix_opt.h"
 #include "fenix_util.h"
+#include "fenix_xor.h"
+#include "fenix_arena.h"
+#include "fenix_numa.h"
+#include "fenix_progress.h"
+#include "fenix_data_policy_in_memory_raid.h"
 #include <mpi.h>
 #include <mpi-ext.h>
+#ifdef __linux__
+#include <sys/vfs.h>
+#include <linux/magic.h>
+#endif
 
 int __fenix_preinit(int *role, MPI_Comm comm, MPI_Comm *new_comm, int *argc, char ***argv,
                     int spare_ranks,
@@ -92,6 +101,13 @@ int __fenix_preinit(int *role, MPI_Comm comm, MPI_Comm *new_comm, int *argc, cha
     fenix.fail_world_size = 0;
     fenix.ignore_errs = 0;
     fenix.resume_mode = __FENIX_RESUME_AT_INIT;
+    fenix.data_pages = __FENIX_ARENA_PAGES_DEFAULT;
+    fenix.data_placement = __FENIX_NUMA_FIRST_TOUCH;
+    fenix.data_spill_dir = NULL;
+    fenix.data_memory_budget = 0;
+    fenix.data_progress = 0;
+    fenix.data_progress_queue = 0;
+    fenix.data_transport = __FENIX_IMR_TRANSPORT_MESSAGE;
     fenix.repair_result = 0;
     fenix.ret_role = role;
     fenix.ret_error = error;
@@ -109,6 +125,9 @@ int __fenix_preinit(int *role, MPI_Comm comm, MPI_Comm *new_comm, int *argc, cha
 
     MPI_Op_create((MPI_User_function *) __fenix_ranks_agree, 1, &fenix.agree_op);
 
+    __fenix_xor_init();
+    MPI_Op_create((MPI_User_function *) __fenix_xor_op, 1, &fenix.xor_op);
+
     /* Check the values in info */
     if (info != MPI_INFO_NULL) {
         char value[MPI_MAX_INFO_VAL + 1];
@@ -157,6 +176,107 @@ int __fenix_preinit(int *role, MPI_Comm comm, MPI_Comm *new_comm, int *argc, cha
                 fenix.print_unhandled = 0;
             }
         }
+
+        MPI_Info_get(info, "FENIX_DATA_HUGE_PAGES", vallen, value, &flag);
+        if (flag == 1) {
+            if (strcmp(value, "ADVISE") == 0) {
+                fenix.data_pages = __FENIX_ARENA_PAGES_ADVISE;
+            } else if (strcmp(value, "HUGETLB") == 0) {
+                fenix.data_pages = __FENIX_ARENA_PAGES_HUGETLB;
+            } else {
+                /* No support. Setting it to regular pages */
+                fenix.data_pages = __FENIX_ARENA_PAGES_DEFAULT;
+            }
+            if (fenix.options.verbose == 0) {
+                verbose_print("rank: %d, role: %d, DATA_HUGE_PAGES: %s\n",
+                              __fenix_get_current_rank(fenix.world), fenix.role, value);
+            }
+        }
+
+        MPI_Info_get(info, "FENIX_DATA_NUMA_PLACEMENT", vallen, value, &flag);
+        if (flag == 1) {
+            if (strcmp(value, "LOCAL") == 0) {
+                fenix.data_placement = __FENIX_NUMA_LOCAL;
+            } else if (strcmp(value, "INTERLEAVE") == 0) {
+                fenix.data_placement = __FENIX_NUMA_INTERLEAVE;
+            } else {
+                /* No support. Setting it to first touch */
+                fenix.data_placement = __FENIX_NUMA_FIRST_TOUCH;
+            }
+            if (fenix.options.verbose == 0) {
+                verbose_print("rank: %d, role: %d, DATA_NUMA_PLACEMENT: %s\n",
+                              __fenix_get_current_rank(fenix.world), fenix.role, value);
+            }
+        }
+
+        MPI_Info_get(info, "FENIX_DATA_SPILL_DIR", vallen, value, &flag);
+        if (flag == 1) {
+            fenix.data_spill_dir = strdup(value);
+            if (fenix.options.verbose == 0) {
+                verbose_print("rank: %d, role: %d, DATA_SPILL_DIR: %s\n",
+                              __fenix_get_current_rank(fenix.world), fenix.role, value);
+            }
+#ifdef __linux__
+            /* Spilled pages on tmpfs stay in memory, just as swappable shmem */
+            struct statfs spill_fs;
+            if (statfs(value, &spill_fs) == 0 && spill_fs.f_type == TMPFS_MAGIC) {
+                debug_print("WARNING Fenix_Init: spill directory <%s> is on tmpfs, spilling won't free any memory\n",
+                            value);
+            }
+#endif
+        }
+
+        MPI_Info_get(info, "FENIX_DATA_MEMORY_BUDGET", vallen, value, &flag);
+        if (flag == 1) {
+            /* Bytes, optionally followed by K, M or G */
+            char *suffix;
+            fenix.data_memory_budget = strtoull(value, &suffix, 10);
+            if (*suffix == 'K' || *suffix == 'k') fenix.data_memory_budget <<= 10;
+            if (*suffix == 'M' || *suffix == 'm') fenix.data_memory_budget <<= 20;
+            if (*suffix == 'G' || *suffix == 'g') fenix.data_memory_budget <<= 30;
+            if (fenix.options.verbose == 0) {
+                verbose_print("rank: %d, role: %d, DATA_MEMORY_BUDGET: %s\n",
+                              __fenix_get_current_rank(fenix.world), fenix.role, value);
+            }
+        }
+
+        MPI_Info_get(info, "FENIX_DATA_PROGRESS_THREAD", vallen, value, &flag);
+        if (flag == 1) {
+            if (strcmp(value, "ON") == 0) {
+                fenix.data_progress = 1;
+            } else {
+                /* No support. Setting it to off */
+                fenix.data_progress = 0;
+            }
+            if (fenix.options.verbose == 0) {
+                verbose_print("rank: %d, role: %d, DATA_PROGRESS_THREAD: %s\n",
+                              __fenix_get_current_rank(fenix.world), fenix.role, value);
+            }
+        }
+
+        MPI_Info_get(info, "FENIX_DATA_PROGRESS_QUEUE", vallen, value, &flag);
+        if (flag == 1) {
+            fenix.data_progress_queue = atoi(value);
+            if (fenix.data_progress_queue < 0) fenix.data_progress_queue = 0;
+            if (fenix.options.verbose == 0) {
+                verbose_print("rank: %d, role: %d, DATA_PROGRESS_QUEUE: %s\n",
+                              __fenix_get_current_rank(fenix.world), fenix.role, value);
+            }
+        }
+
+        MPI_Info_get(info, "FENIX_DATA_TRANSPORT", vallen, value, &flag);
+        if (flag == 1) {
+            if (strcmp(value, "RMA") == 0) {
+                fenix.data_transport = __FENIX_IMR_TRANSPORT_RMA;
+            } else {
+                /* No support. Setting it to messages */
+                fenix.data_transport = __FENIX_IMR_TRANSPORT_MESSAGE;
+            }
+            if (fenix.options.verbose == 0) {
+                verbose_print("rank: %d, role: %d, DATA_TRANSPORT: %s\n",
+                              __fenix_get_current_rank(fenix.world), fenix.role, value);
+            }
+        }
     }
 
     if (fenix.spare_ranks >= __fenix_get_world_size(comm)) {
@@ -165,6 +285,7 @@ int __fenix_preinit(int *role, MPI_Comm comm, MPI_Comm *new_comm, int *argc, cha
     }
 
     fenix.data_recovery = __fenix_data_recovery_init();
+    __fenix_progress_start();
 
     /*****************************************************/
     /* Note: fenix.new_world is only valid for the   */
@@ -687,6 +808,8 @@ void __fenix_finalize()
     }
     
     MPI_Op_free( &fenix.agree_op );
+    MPI_Op_free( &fenix.xor_op );
+    __fenix_data_subset_free_type_cache();
     MPI_Comm_set_errhandler( fenix.world, MPI_ERRORS_ARE_FATAL );
     MPI_Comm_free( &fenix.world );
     MPI_Comm_free( &fenix.new_world );
@@ -699,8 +822,12 @@ void __fenix_finalize()
     __fenix_callback_destroy( fenix.callback_list );
 
     /* Free data recovery interface */
+    __fenix_progress_stop();
     __fenix_data_recovery_destroy( fenix.data_recovery );
 
+    free(fenix.data_spill_dir);
+    fenix.data_spill_dir = NULL;
+
     fenix.fenix_init_flag = 0;
 }
 
@@ -711,6 +838,8 @@ void __fenix_finalize_spare()
     if (ret != MPI_SUCCESS) { debug_print("MPI_Barrier: %d\n", ret); } 
  
     MPI_Op_free(&fenix.agree_op);
+    MPI_Op_free(&fenix.xor_op);
+    __fenix_data_subset_free_type_cache();
     MPI_Comm_set_errhandler(fenix.world, MPI_ERRORS_ARE_FATAL);
     MPI_Comm_free(&fenix.world);
 
@@ -718,8 +847,12 @@ void __fenix_finalize_spare()
     __fenix_callback_destroy( fenix.callback_list );
 
     /* Free data recovery interface */
+    __fenix_progress_stop();
     __fenix_data_recovery_destroy( fenix.data_recovery );
 
+    free(fenix.data_spill_dir);
+    fenix.data_spill_dir = NULL;
+
     fenix.fenix_init_flag = 0;
 
     /* Future version do not close MPI. Jump to where Fenix_Finalize is called. */
@@ -737,8 +870,17 @@ void __fenix_test_MPI(MPI_Comm *pcomm, int *pret, ...)
         return;
     }
 
+    //The progress thread only flags its requests and defers the error, the
+    //main thread repairs from it when it waits on or tests a request.
+    if(__fenix_progress_is_engine()) {
+        __fenix_progress_defer_error(ret);
+        return;
+    }
+
+    int held = 0;
     switch (ret) {
     case MPI_ERR_PROC_FAILED:
+        held = __fenix_progress_lock();
         MPIX_Comm_revoke(fenix.world);
         MPIX_Comm_revoke(fenix.new_world);
 
@@ -746,11 +888,15 @@ void __fenix_test_MPI(MPI_Comm *pcomm, int *pret, ...)
 
 
         __fenix_comm_list_destroy();
+        //This repair covers whatever the progress thread ran into too.
+        __fenix_progress_take_error();
 
         fenix.repair_result = __fenix_repair_ranks();
         break;
     case MPI_ERR_REVOKED:
+        held = __fenix_progress_lock();
         __fenix_comm_list_destroy();
+        __fenix_progress_take_error();
 
         fenix.repair_result = __fenix_repair_ranks();
         break;
@@ -777,11 +923,14 @@ void __fenix_test_MPI(MPI_Comm *pcomm, int *pret, ...)
     if(!fenix.finalized) {
         switch(fenix.resume_mode) {
             case __FENIX_RESUME_AT_INIT:
+                __fenix_progress_unlock();
                 longjmp(*fenix.recover_environment, 1);
                 break;
             case __FENIX_RESUME_NO_JUMP:
                 *(fenix.ret_role) = FENIX_ROLE_SURVIVOR_RANK;
+                __fenix_progress_unlock();
                 __fenix_postinit(fenix.ret_error);
+                if(held) __fenix_progress_lock();
                 break;
             default:
                 printf("Fenix detected error: Unknown resume mode\n");
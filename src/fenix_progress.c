@@ -0,0 +1,185 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//
+//            _|_|_|_|  _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//            _|        _|        _|_|    _|    _|      _|  _|
+//            _|_|_|    _|_|_|    _|  _|  _|    _|        _|
+//            _|        _|        _|    _|_|    _|      _|  _|
+//            _|        _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//
+//
+//
+//
+// Copyright (C) 2016 Rutgers University and Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author Marc Gamell, Eric Valenzuela, Keita Teranishi, Manish Parashar,
+//        Michael Heroux, and Matthew Whitlock
+//
+// Questions? Contact Keita Teranishi (knteran@sandia.gov) and
+//                    Marc Gamell (mgamell@cac.rutgers.edu)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#include <pthread.h>
+#include <time.h>
+#include <mpi.h>
+#include "fenix_ext.h"
+#include "fenix_opt.h"
+#include "fenix_data_group.h"
+#include "fenix_progress.h"
+
+//How long the thread sleeps between polls while traffic is in flight, short
+//enough to keep pipelined exchanges fed without hogging the lock.
+#define __FENIX_PROGRESS_INTERVAL_NS 100000
+
+typedef struct {
+   int running;
+   int shutdown;
+   pthread_t thread;
+   pthread_mutex_t lock;
+   pthread_cond_t work;
+} fenix_progress_t;
+
+static fenix_progress_t progress = {
+   .running = 0,
+   .shutdown = 0,
+   .lock = PTHREAD_MUTEX_INITIALIZER,
+   .work = PTHREAD_COND_INITIALIZER
+};
+
+//An MPI error the thread hit, waiting for the calling thread to repair.
+static int progress_error = MPI_SUCCESS;
+
+static __thread int progress_held = 0;
+static __thread int progress_engine = 0;
+
+static void* __fenix_progress_engine(void* arg){
+   (void)arg;
+   progress_engine = 1;
+   struct timespec interval = {0, __FENIX_PROGRESS_INTERVAL_NS};
+
+   __fenix_progress_lock();
+   while(!progress.shutdown){
+      int in_flight = 0;
+      fenix_data_recovery_t* data_recovery = fenix.data_recovery;
+      for(size_t i = 0; i < data_recovery->count; i++){
+         fenix_group_t* group = data_recovery->group[i];
+         if(group->vtbl.progress != NULL){
+            in_flight += group->vtbl.progress(group);
+         }
+      }
+
+      if(in_flight == 0){
+         //Nothing to drive until an istore kicks us.
+         progress_held = 0;
+         pthread_cond_wait(&progress.work, &progress.lock);
+         progress_held = 1;
+      } else {
+         __fenix_progress_unlock();
+         nanosleep(&interval, NULL);
+         __fenix_progress_lock();
+      }
+   }
+   __fenix_progress_unlock();
+
+   return NULL;
+}
+
+void __fenix_progress_start(){
+   if(!fenix.data_progress || progress.running) return;
+
+   int provided;
+   MPI_Query_thread(&provided);
+   if(provided != MPI_THREAD_MULTIPLE){
+      debug_print("WARNING Fenix_Init: data progress thread needs MPI_THREAD_MULTIPLE, progress stays on the calling thread%s\n", "");
+      fenix.data_progress = 0;
+      return;
+   }
+
+   progress.shutdown = 0;
+   progress.running = 1;
+   if(pthread_create(&progress.thread, NULL, __fenix_progress_engine, NULL) != 0){
+      debug_print("WARNING Fenix_Init: unable to start the data progress thread%s\n", "");
+      progress.running = 0;
+      fenix.data_progress = 0;
+   }
+}
+
+void __fenix_progress_stop(){
+   if(!progress.running) return;
+
+   __fenix_progress_lock();
+   progress.shutdown = 1;
+   pthread_cond_signal(&progress.work);
+   __fenix_progress_unlock();
+
+   pthread_join(progress.thread, NULL);
+   progress.running = 0;
+}
+
+int __fenix_progress_lock(){
+   if(!progress.running || progress_held) return progress_held;
+
+   pthread_mutex_lock(&progress.lock);
+   progress_held = 1;
+   return 0;
+}
+
+void __fenix_progress_unlock(){
+   if(!progress_held) return;
+
+   progress_held = 0;
+   pthread_mutex_unlock(&progress.lock);
+}
+
+void __fenix_progress_kick(){
+   if(progress.running) pthread_cond_signal(&progress.work);
+}
+
+int __fenix_progress_is_engine(){
+   return progress_engine;
+}
+
+void __fenix_progress_defer_error(int error){
+   if(progress_error == MPI_SUCCESS) progress_error = error;
+}
+
+int __fenix_progress_take_error(){
+   int error = progress_error;
+   progress_error = MPI_SUCCESS;
+   return error;
+}
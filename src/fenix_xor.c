@@ -0,0 +1,182 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//
+//            _|_|_|_|  _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//            _|        _|        _|_|    _|    _|      _|  _|
+//            _|_|_|    _|_|_|    _|  _|  _|    _|        _|
+//            _|        _|        _|    _|_|    _|      _|  _|
+//            _|        _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//
+//
+//
+//
+// Copyright (C) 2016 Rutgers University and Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author Marc Gamell, Eric Valenzuela, Keita Teranishi, Manish Parashar,
+//        Michael Heroux, and Matthew Whitlock
+//
+// Questions? Contact Keita Teranishi (knteran@sandia.gov) and
+//                    Marc Gamell (mgamell@cac.rutgers.edu)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#include <stdint.h>
+#include <string.h>
+#include "fenix_xor.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define __FENIX_XOR_X86
+#include <immintrin.h>
+#endif
+
+#define __FENIX_XOR_SCALAR 0
+#define __FENIX_XOR_SSE2   1
+#define __FENIX_XOR_AVX2   2
+#define __FENIX_XOR_AVX512 3
+
+static int __fenix_xor_initialized = 0;
+static int __fenix_xor_simd = __FENIX_XOR_SCALAR;
+
+void __fenix_xor_init(){
+   if(__fenix_xor_initialized) return;
+
+#ifdef __FENIX_XOR_X86
+   __builtin_cpu_init();
+   if(__builtin_cpu_supports("avx512f")){
+      __fenix_xor_simd = __FENIX_XOR_AVX512;
+   } else if(__builtin_cpu_supports("avx2")){
+      __fenix_xor_simd = __FENIX_XOR_AVX2;
+   } else if(__builtin_cpu_supports("sse2")){
+      __fenix_xor_simd = __FENIX_XOR_SSE2;
+   }
+#endif
+
+   __fenix_xor_initialized = 1;
+}
+
+//Each kernel does as many full vectors as it can and returns how many bytes
+//that covered. Four vectors per iteration keeps enough loads in flight to
+//run at memory bandwidth.
+#ifdef __FENIX_XOR_X86
+__attribute__((target("sse2")))
+static size_t __fenix_xor_sse2(const uint8_t* in, uint8_t* out, size_t n){
+   size_t i = 0;
+   for(; i + 64 <= n; i += 64){
+      for(int v = 0; v < 64; v += 16){
+         __m128i a = _mm_loadu_si128((const __m128i*)(in + i + v));
+         __m128i b = _mm_loadu_si128((const __m128i*)(out + i + v));
+         _mm_storeu_si128((__m128i*)(out + i + v), _mm_xor_si128(a, b));
+      }
+   }
+   for(; i + 16 <= n; i += 16){
+      __m128i a = _mm_loadu_si128((const __m128i*)(in + i));
+      __m128i b = _mm_loadu_si128((const __m128i*)(out + i));
+      _mm_storeu_si128((__m128i*)(out + i), _mm_xor_si128(a, b));
+   }
+   return i;
+}
+
+__attribute__((target("avx2")))
+static size_t __fenix_xor_avx2(const uint8_t* in, uint8_t* out, size_t n){
+   size_t i = 0;
+   for(; i + 128 <= n; i += 128){
+      for(int v = 0; v < 128; v += 32){
+         __m256i a = _mm256_loadu_si256((const __m256i*)(in + i + v));
+         __m256i b = _mm256_loadu_si256((const __m256i*)(out + i + v));
+         _mm256_storeu_si256((__m256i*)(out + i + v), _mm256_xor_si256(a, b));
+      }
+   }
+   for(; i + 32 <= n; i += 32){
+      __m256i a = _mm256_loadu_si256((const __m256i*)(in + i));
+      __m256i b = _mm256_loadu_si256((const __m256i*)(out + i));
+      _mm256_storeu_si256((__m256i*)(out + i), _mm256_xor_si256(a, b));
+   }
+   return i;
+}
+
+__attribute__((target("avx512f")))
+static size_t __fenix_xor_avx512(const uint8_t* in, uint8_t* out, size_t n){
+   size_t i = 0;
+   for(; i + 256 <= n; i += 256){
+      for(int v = 0; v < 256; v += 64){
+         __m512i a = _mm512_loadu_si512((const void*)(in + i + v));
+         __m512i b = _mm512_loadu_si512((const void*)(out + i + v));
+         _mm512_storeu_si512((void*)(out + i + v), _mm512_xor_si512(a, b));
+      }
+   }
+   for(; i + 64 <= n; i += 64){
+      __m512i a = _mm512_loadu_si512((const void*)(in + i));
+      __m512i b = _mm512_loadu_si512((const void*)(out + i));
+      _mm512_storeu_si512((void*)(out + i), _mm512_xor_si512(a, b));
+   }
+   return i;
+}
+#endif
+
+void __fenix_xor_region(const void* src, void* dest, size_t n){
+   const uint8_t* in = (const uint8_t*)src;
+   uint8_t* out = (uint8_t*)dest;
+
+   size_t done = 0;
+#ifdef __FENIX_XOR_X86
+   if(__fenix_xor_simd == __FENIX_XOR_AVX512){
+      done = __fenix_xor_avx512(in, out, n);
+   } else if(__fenix_xor_simd == __FENIX_XOR_AVX2){
+      done = __fenix_xor_avx2(in, out, n);
+   } else if(__fenix_xor_simd == __FENIX_XOR_SSE2){
+      done = __fenix_xor_sse2(in, out, n);
+   }
+#endif
+
+   //Whole words where we can, memcpy keeps unaligned access legal.
+   for(; done + 8 <= n; done += 8){
+      uint64_t a, b;
+      memcpy(&a, in + done, 8);
+      memcpy(&b, out + done, 8);
+      b ^= a;
+      memcpy(out + done, &b, 8);
+   }
+   for(; done < n; done++){
+      out[done] ^= in[done];
+   }
+}
+
+void __fenix_xor_op(void* invec, void* inoutvec, int* len, MPI_Datatype* datatype){
+   int type_size;
+   MPI_Type_size(*datatype, &type_size);
+   __fenix_xor_region(invec, inoutvec, (size_t)(*len) * type_size);
+}
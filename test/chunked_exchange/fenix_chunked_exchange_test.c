@@ -0,0 +1,179 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//
+//            _|_|_|_|  _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//            _|        _|        _|_|    _|    _|      _|  _|
+//            _|_|_|    _|_|_|    _|  _|  _|    _|        _|
+//            _|        _|        _|    _|_|    _|      _|  _|
+//            _|        _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//
+//
+//
+//
+// Copyright (C) 2016 Rutgers University and Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author Marc Gamell, Eric Valenzuela, Keita Teranishi, Manish Parashar,
+//        Michael Heroux, and Matthew Whitlock
+//
+// Questions? Contact Keita Teranishi (knteran@sandia.gov) and
+//                    Marc Gamell (mgamell@cac.rutgers.edu)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+
+#include <fenix.h>
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+const int kCount = 300001;
+const int kKillID = 1;
+const int kMember = 777;
+const int kCommits = 3;
+//Not a multiple of the element size, so chunks split elements.
+const int kChunkSize = 4099;
+const int kNumBlocks = 100;
+const int kBlock = 10;
+const int kStride = 1000;
+
+int value(int rank, int commit, int i) {
+  return rank*1000000 + commit*100000 + i%100000;
+}
+
+int in_subset(int i) {
+  return i < (kNumBlocks - 1)*kStride + kBlock && i%kStride < kBlock;
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+      printf("Usage: %s <# spare ranks> \n", *argv);
+      exit(0);
+  }
+
+  int fenix_role;
+  MPI_Comm world_comm;
+  MPI_Comm new_comm;
+  int spare_ranks = atoi(argv[1]);
+  int num_ranks;
+  int rank;
+  int error;
+  int recovered = 0;
+  int refused = 1;
+  int *data = (int *) malloc(kCount * sizeof(int));
+
+  MPI_Init(&argc, &argv);
+  MPI_Comm_dup(MPI_COMM_WORLD, &world_comm);
+  Fenix_Init(&fenix_role, world_comm, &new_comm, &argc, &argv,
+             spare_ranks, 0, MPI_INFO_NULL, &error);
+
+  MPI_Comm_size(new_comm, &num_ranks);
+  MPI_Comm_rank(new_comm, &rank);
+
+  Fenix_Data_group_create(0, new_comm, 0, 1, FENIX_DATA_POLICY_IN_MEMORY_RAID,
+          (int[]){1, 1}, &error);
+
+  if (fenix_role == FENIX_ROLE_INITIAL_RANK) {
+    Fenix_Data_member_create(0, kMember, data, kCount, MPI_INT);
+
+    //Every rank must be told when one picked a different size.
+    int chunk_size = rank == 0 ? kChunkSize/2 : kChunkSize;
+    if (Fenix_Data_member_attr_set(0, kMember, FENIX_DATA_MEMBER_ATTRIBUTE_CHUNK_SIZE,
+            &chunk_size, &error) == FENIX_SUCCESS) {
+      fprintf(stderr, "FAILURE rank %d accepted a chunk size other ranks don't share\n", rank);
+      refused = 0;
+    }
+
+    chunk_size = kChunkSize;
+    Fenix_Data_member_attr_set(0, kMember, FENIX_DATA_MEMBER_ATTRIBUTE_CHUNK_SIZE,
+            &chunk_size, &error);
+
+    //Full stores go out in chunks, blocking and not, and the strided subset
+    //is sent straight from the member's buffer.
+    Fenix_Data_subset subset;
+    Fenix_Data_subset_create(kNumBlocks, 0, kBlock - 1, kStride, &subset);
+    for (int commit = 0; commit < kCommits; commit++) {
+      for (int i = 0; i < kCount; i++) {
+        data[i] = value(rank, commit, i);
+      }
+
+      if (commit == 0) {
+        Fenix_Data_member_store(0, kMember, FENIX_DATA_SUBSET_FULL);
+      } else if (commit == 1) {
+        Fenix_Request request;
+        Fenix_Data_member_istore(0, kMember, FENIX_DATA_SUBSET_FULL, &request);
+        Fenix_Data_wait(request);
+      } else {
+        Fenix_Data_member_store(0, kMember, subset);
+      }
+      Fenix_Data_commit_barrier(0, NULL);
+    }
+    Fenix_Data_subset_delete(&subset);
+  } else {
+    recovered = 1;
+  }
+
+  if (rank == kKillID && recovered == 0) {
+    pid_t pid = getpid();
+    kill(pid, SIGTERM);
+  }
+
+  MPI_Barrier(new_comm);
+
+  Fenix_Data_member_restore(0, kMember, data, kCount, FENIX_TIME_STAMP_MAX, NULL);
+
+  int successful = refused;
+  for (int i = 0; i < kCount; i++) {
+    int commit = in_subset(i) ? kCommits - 1 : kCommits - 2;
+    if (data[i] != value(rank, commit, i)) {
+      fprintf(stderr, "FAILURE rank %d index %d. Found: %d\n", rank, i, data[i]);
+      successful = 0;
+      break;
+    }
+  }
+
+  if (successful) {
+    printf("Rank %d successfully recovered\n", rank);
+  }
+
+  free(data);
+  Fenix_Finalize();
+  MPI_Finalize();
+  return !successful;
+}
@@ -0,0 +1,175 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//
+//            _|_|_|_|  _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//            _|        _|        _|_|    _|    _|      _|  _|
+//            _|_|_|    _|_|_|    _|  _|  _|    _|        _|
+//            _|        _|        _|    _|_|    _|      _|  _|
+//            _|        _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//
+//
+//
+//
+// Copyright (C) 2016 Rutgers University and Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author Marc Gamell, Eric Valenzuela, Keita Teranishi, Manish Parashar,
+//        Michael Heroux, and Matthew Whitlock
+//
+// Questions? Contact Keita Teranishi (knteran@sandia.gov) and
+//                    Marc Gamell (mgamell@cac.rutgers.edu)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+
+#include <fenix.h>
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+const int kCount = 1001;
+const int kKillID = 1;
+const int kCommits = 5;
+//One member for each way RAID 5 can update its parity.
+const int kNumMembers = 2;
+const int kUpdates[2] = {FENIX_DATA_PARITY_UPDATE_REDUCE, FENIX_DATA_PARITY_UPDATE_DELTA};
+
+//The first commit stores everything, later ones a stretch of 100 elements.
+int stored_at(int commit, int i) {
+  return commit == 0 || (i >= commit*150 && i < commit*150 + 100);
+}
+
+int expected(int rank, int member, int i) {
+  int last = 0;
+  for (int commit = 0; commit < kCommits; commit++) {
+    if (stored_at(commit, i)) last = commit;
+  }
+  return rank*1000000 + member*100000 + last*10000 + i;
+}
+
+int main(int argc, char **argv) {
+  int data[2][1001];
+
+  if (argc < 2) {
+      printf("Usage: %s <# spare ranks> \n", *argv);
+      exit(0);
+  }
+
+  int fenix_role;
+  MPI_Comm world_comm;
+  MPI_Comm new_comm;
+  int spare_ranks = atoi(argv[1]);
+  int num_ranks;
+  int rank;
+  int error;
+  int recovered = 0;
+
+  MPI_Init(&argc, &argv);
+  MPI_Comm_dup(MPI_COMM_WORLD, &world_comm);
+  Fenix_Init(&fenix_role, world_comm, &new_comm, &argc, &argv,
+             spare_ranks, 0, MPI_INFO_NULL, &error);
+
+  MPI_Comm_size(new_comm, &num_ranks);
+  MPI_Comm_rank(new_comm, &rank);
+
+  //Deep enough to keep the first, full, snapshot around.
+  Fenix_Data_group_create(0, new_comm, 0, kCommits, FENIX_DATA_POLICY_IN_MEMORY_RAID,
+          (int[]){5, 1, num_ranks}, &error);
+
+  if (fenix_role == FENIX_ROLE_INITIAL_RANK) {
+    for (int member = 0; member < kNumMembers; member++) {
+      Fenix_Data_member_create(0, member, data[member], kCount, MPI_INT);
+      Fenix_Data_member_attr_set(0, member, FENIX_DATA_MEMBER_ATTRIBUTE_PARITY_UPDATE,
+              (void*)(kUpdates + member), &error);
+    }
+
+    for (int commit = 0; commit < kCommits; commit++) {
+      for (int member = 0; member < kNumMembers; member++) {
+        for (int i = 0; i < kCount; i++) {
+          data[member][i] = rank*1000000 + member*100000 + commit*10000 + i;
+        }
+
+        Fenix_Data_subset subset;
+        Fenix_Data_subset_create(1, commit*150, commit*150 + 99, 1, &subset);
+        if (Fenix_Data_member_store(0, member, commit == 0 ? FENIX_DATA_SUBSET_FULL : subset) != FENIX_SUCCESS) {
+          fprintf(stderr, "FAILURE on store of member %d commit %d\n", member, commit);
+        }
+        Fenix_Data_subset_delete(&subset);
+      }
+      Fenix_Data_commit_barrier(0, NULL);
+    }
+  } else {
+    for (int member = 0; member < kNumMembers; member++) {
+      Fenix_Data_member_restore(0, member, data[member], kCount, FENIX_TIME_STAMP_MAX, NULL);
+    }
+    recovered = 1;
+  }
+
+  if (rank == kKillID && recovered == 0) {
+    pid_t pid = getpid();
+    kill(pid, SIGTERM);
+  }
+
+  MPI_Barrier(new_comm);
+
+  if (!recovered) {
+    for (int member = 0; member < kNumMembers; member++) {
+      Fenix_Data_member_restore(0, member, data[member], kCount, FENIX_TIME_STAMP_MAX, NULL);
+    }
+  }
+
+  int successful = 1;
+  for (int member = 0; member < kNumMembers; member++) {
+    for (int i = 0; i < kCount; i++) {
+      if (data[member][i] != expected(rank, member, i)) {
+        fprintf(stderr, "FAILURE rank %d member %d index %d. Found: %d\n", rank, member, i, data[member][i]);
+        successful = 0;
+        break;
+      }
+    }
+  }
+
+  if (successful) {
+    printf("Rank %d successfully recovered\n", rank);
+  }
+
+  Fenix_Finalize();
+  MPI_Finalize();
+  return !successful;
+}
@@ -0,0 +1,179 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//
+//            _|_|_|_|  _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//            _|        _|        _|_|    _|    _|      _|  _|
+//            _|_|_|    _|_|_|    _|  _|  _|    _|        _|
+//            _|        _|        _|    _|_|    _|      _|  _|
+//            _|        _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//
+//
+//
+//
+// Copyright (C) 2016 Rutgers University and Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author Marc Gamell, Eric Valenzuela, Keita Teranishi, Manish Parashar,
+//        Michael Heroux, and Matthew Whitlock
+//
+// Questions? Contact Keita Teranishi (knteran@sandia.gov) and
+//                    Marc Gamell (mgamell@cac.rutgers.edu)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+
+#include <fenix.h>
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+const int kKillID = 1;
+const int kNumMembers = 3;
+//Small heap buffers share their pages with other allocations, the large one
+//spans plenty of whole pages.
+const int kCounts[3] = {7, 1000, 100000};
+const int kSteps = 3;
+
+//Every step writes part of the buffer: all of it, then every third element,
+//then the first half.
+int written_at(int step, int i, int count) {
+  return step == 0 || (step == 1 && i%3 == 0) || (step == 2 && i < count/2);
+}
+
+int expected(int rank, int member, int i, int count) {
+  int last = 0;
+  for (int step = 0; step < kSteps; step++) {
+    if (written_at(step, i, count)) last = step;
+  }
+  return rank*1000000 + member*100000 + last*1000 + i%1000;
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+      printf("Usage: %s <# spare ranks> \n", *argv);
+      exit(0);
+  }
+
+  int fenix_role;
+  MPI_Comm world_comm;
+  MPI_Comm new_comm;
+  int spare_ranks = atoi(argv[1]);
+  int rank;
+  int error;
+  int recovered = 0;
+
+  MPI_Init(&argc, &argv);
+  MPI_Comm_dup(MPI_COMM_WORLD, &world_comm);
+  Fenix_Init(&fenix_role, world_comm, &new_comm, &argc, &argv,
+             spare_ranks, 0, MPI_INFO_NULL, &error);
+
+  MPI_Comm_rank(new_comm, &rank);
+
+  //Allocated next to whatever Fenix allocates for the members, so the pages
+  //they share with the heap are in use while they are tracked.
+  int *data[3];
+  for (int member = 0; member < kNumMembers; member++) {
+    data[member] = (int *) malloc(kCounts[member] * sizeof(int));
+  }
+
+  Fenix_Data_group_create(0, new_comm, 0, 2, FENIX_DATA_POLICY_IN_MEMORY_RAID,
+          (int[]){1, 1}, &error);
+
+  if (fenix_role == FENIX_ROLE_INITIAL_RANK) {
+    for (int member = 0; member < kNumMembers; member++) {
+      Fenix_Data_member_create(0, member, data[member], kCounts[member], MPI_INT);
+      int track = 1;
+      if (Fenix_Data_member_attr_set(0, member, FENIX_DATA_MEMBER_ATTRIBUTE_DIRTY_TRACKING,
+              &track, &error) != FENIX_SUCCESS) {
+        fprintf(stderr, "FAILURE enabling dirty tracking on member %d\n", member);
+      }
+    }
+
+    for (int step = 0; step < kSteps; step++) {
+      for (int member = 0; member < kNumMembers; member++) {
+        for (int i = 0; i < kCounts[member]; i++) {
+          if (written_at(step, i, kCounts[member])) {
+            data[member][i] = rank*1000000 + member*100000 + step*1000 + i%1000;
+          }
+        }
+        if (Fenix_Data_member_store(0, member, FENIX_DATA_SUBSET_FULL) != FENIX_SUCCESS) {
+          fprintf(stderr, "FAILURE on store of member %d step %d\n", member, step);
+        }
+      }
+      Fenix_Data_commit_barrier(0, NULL);
+    }
+  } else {
+    for (int member = 0; member < kNumMembers; member++) {
+      Fenix_Data_member_restore(0, member, data[member], kCounts[member], FENIX_TIME_STAMP_MAX, NULL);
+    }
+    recovered = 1;
+  }
+
+  if (rank == kKillID && recovered == 0) {
+    pid_t pid = getpid();
+    kill(pid, SIGTERM);
+  }
+
+  MPI_Barrier(new_comm);
+
+  if (!recovered) {
+    for (int member = 0; member < kNumMembers; member++) {
+      Fenix_Data_member_restore(0, member, data[member], kCounts[member], FENIX_TIME_STAMP_MAX, NULL);
+    }
+  }
+
+  int successful = 1;
+  for (int member = 0; member < kNumMembers; member++) {
+    for (int i = 0; i < kCounts[member]; i++) {
+      if (data[member][i] != expected(rank, member, i, kCounts[member])) {
+        fprintf(stderr, "FAILURE rank %d member %d index %d. Found: %d\n", rank, member, i, data[member][i]);
+        successful = 0;
+        break;
+      }
+    }
+  }
+
+  if (successful) {
+    printf("Rank %d successfully recovered\n", rank);
+  }
+
+  Fenix_Finalize();
+  MPI_Finalize();
+  return !successful;
+}
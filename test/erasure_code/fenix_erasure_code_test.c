@@ -0,0 +1,169 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//
+//            _|_|_|_|  _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//            _|        _|        _|_|    _|    _|      _|  _|
+//            _|_|_|    _|_|_|    _|  _|  _|    _|        _|
+//            _|        _|        _|    _|_|    _|      _|  _|
+//            _|        _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//
+//
+//
+//
+// Copyright (C) 2016 Rutgers University and Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author Marc Gamell, Eric Valenzuela, Keita Teranishi, Manish Parashar,
+//        Michael Heroux, and Matthew Whitlock
+//
+// Questions? Contact Keita Teranishi (knteran@sandia.gov) and
+//                    Marc Gamell (mgamell@cac.rutgers.edu)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+
+#include <fenix.h>
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+const int kCount = 1001;
+//Both in the same stripe set, as many as its parity chunks.
+const int kKillIDs[2] = {1, 2};
+const int kMember = 777;
+
+//The second commit stores elements 100 through 599 again.
+int expected(int rank, int i) {
+  int commit = (i >= 100 && i < 600) ? 1 : 0;
+  return rank*1000000 + commit*10000 + i;
+}
+
+int main(int argc, char **argv) {
+  int data[1001];
+
+  if (argc < 2) {
+      printf("Usage: %s <# spare ranks> \n", *argv);
+      exit(0);
+  }
+
+  int fenix_role;
+  MPI_Comm world_comm;
+  MPI_Comm new_comm;
+  int spare_ranks = atoi(argv[1]);
+  int num_ranks;
+  int rank;
+  int error;
+  int recovered = 0;
+
+  MPI_Init(&argc, &argv);
+  MPI_Comm_dup(MPI_COMM_WORLD, &world_comm);
+  Fenix_Init(&fenix_role, world_comm, &new_comm, &argc, &argv,
+             spare_ranks, 0, MPI_INFO_NULL, &error);
+
+  MPI_Comm_size(new_comm, &num_ranks);
+  MPI_Comm_rank(new_comm, &rank);
+
+  //k data and 2 parity chunks per stripe, over all ranks.
+  Fenix_Data_group_create(0, new_comm, 0, 2, FENIX_DATA_POLICY_ERASURE_CODE,
+          (int[]){num_ranks - 2, 2, 1}, &error);
+
+  //k+2m over 256 leaves no room for distinct Cauchy points, and k must be positive.
+  int refused = 1;
+  if (Fenix_Data_group_create(1, new_comm, 0, 2, FENIX_DATA_POLICY_ERASURE_CODE,
+          (int[]){200, 30, 1}, &error) == FENIX_SUCCESS || error != FENIX_ERROR_GROUP_CREATE) {
+    fprintf(stderr, "FAILURE rank %d created an erasure code group with k+2m over 256\n", rank);
+    refused = 0;
+  }
+  if (Fenix_Data_group_create(2, new_comm, 0, 2, FENIX_DATA_POLICY_ERASURE_CODE,
+          (int[]){0, 2, 1}, &error) == FENIX_SUCCESS || error != FENIX_ERROR_GROUP_CREATE) {
+    fprintf(stderr, "FAILURE rank %d created an erasure code group with k of 0\n", rank);
+    refused = 0;
+  }
+
+  if (fenix_role == FENIX_ROLE_INITIAL_RANK) {
+    Fenix_Data_member_create(0, kMember, data, kCount, MPI_INT);
+
+    for (int commit = 0; commit < 2; commit++) {
+      for (int i = 0; i < kCount; i++) {
+        data[i] = rank*1000000 + commit*10000 + i;
+      }
+
+      Fenix_Data_subset subset;
+      Fenix_Data_subset_create(1, 100, 599, 1, &subset);
+      Fenix_Request request;
+      Fenix_Data_member_istore(0, kMember, commit == 0 ? FENIX_DATA_SUBSET_FULL : subset, &request);
+      if (Fenix_Data_wait(request) != FENIX_SUCCESS) {
+        fprintf(stderr, "FAILURE on Fenix_Data_wait for commit %d\n", commit);
+      }
+      Fenix_Data_subset_delete(&subset);
+      Fenix_Data_commit_barrier(0, NULL);
+    }
+  } else {
+    Fenix_Data_member_restore(0, kMember, data, kCount, FENIX_TIME_STAMP_MAX, NULL);
+    recovered = 1;
+  }
+
+  if ((rank == kKillIDs[0] || rank == kKillIDs[1]) && recovered == 0) {
+    pid_t pid = getpid();
+    kill(pid, SIGTERM);
+  }
+
+  MPI_Barrier(new_comm);
+
+  if (!recovered) {
+    Fenix_Data_member_restore(0, kMember, data, kCount, FENIX_TIME_STAMP_MAX, NULL);
+  }
+
+  int successful = refused;
+  for (int i = 0; i < kCount; i++) {
+    if (data[i] != expected(rank, i)) {
+      fprintf(stderr, "FAILURE rank %d index %d. Found: %d\n", rank, i, data[i]);
+      successful = 0;
+      break;
+    }
+  }
+
+  if (successful) {
+    printf("Rank %d successfully recovered\n", rank);
+  }
+
+  Fenix_Finalize();
+  MPI_Finalize();
+  return !successful;
+}
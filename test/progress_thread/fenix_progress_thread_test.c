@@ -0,0 +1,186 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//
+//            _|_|_|_|  _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//            _|        _|        _|_|    _|    _|      _|  _|
+//            _|_|_|    _|_|_|    _|  _|  _|    _|        _|
+//            _|        _|        _|    _|_|    _|      _|  _|
+//            _|        _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//
+//
+//
+//
+// Copyright (C) 2016 Rutgers University and Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author Marc Gamell, Eric Valenzuela, Keita Teranishi, Manish Parashar,
+//        Michael Heroux, and Matthew Whitlock
+//
+// Questions? Contact Keita Teranishi (knteran@sandia.gov) and
+//                    Marc Gamell (mgamell@cac.rutgers.edu)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+
+#include <fenix.h>
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+const int kCount = 200000;
+const int kKillID = 1;
+const int kNumGroups = 3;
+const int kNumMembers = 3;
+const int kCommits = 3;
+
+int value(int rank, int group, int member, int commit, int i) {
+  return rank*1000000 + group*100000 + member*10000 + commit*1000 + i%1000;
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+      printf("Usage: %s <# spare ranks> \n", *argv);
+      exit(0);
+  }
+
+  int fenix_role;
+  MPI_Comm world_comm;
+  MPI_Comm new_comm;
+  int spare_ranks = atoi(argv[1]);
+  int num_ranks;
+  int rank;
+  int error;
+  int provided;
+  int recovered = 0;
+  int *data[3][3];
+  for (int group = 0; group < kNumGroups; group++) {
+    for (int member = 0; member < kNumMembers; member++) {
+      data[group][member] = (int *) malloc(kCount * sizeof(int));
+    }
+  }
+
+  //Without MPI_THREAD_MULTIPLE the stores still finish, just in the waits.
+  MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &provided);
+  MPI_Comm_dup(MPI_COMM_WORLD, &world_comm);
+
+  //A queue of one makes every istore past the first wait on the last.
+  MPI_Info info;
+  MPI_Info_create(&info);
+  MPI_Info_set(info, "FENIX_DATA_PROGRESS_THREAD", "ON");
+  MPI_Info_set(info, "FENIX_DATA_PROGRESS_QUEUE", "1");
+
+  Fenix_Init(&fenix_role, world_comm, &new_comm, &argc, &argv,
+             spare_ranks, 0, info, &error);
+
+  MPI_Comm_size(new_comm, &num_ranks);
+  MPI_Comm_rank(new_comm, &rank);
+
+  Fenix_Data_group_create(0, new_comm, 0, 1, FENIX_DATA_POLICY_IN_MEMORY_RAID,
+          (int[]){1, 1}, &error);
+  Fenix_Data_group_create(1, new_comm, 0, 1, FENIX_DATA_POLICY_IN_MEMORY_RAID,
+          (int[]){5, 1, num_ranks}, &error);
+  Fenix_Data_group_create(2, new_comm, 0, 1, FENIX_DATA_POLICY_ERASURE_CODE,
+          (int[]){num_ranks - 1, 1, 1}, &error);
+
+  if (fenix_role == FENIX_ROLE_INITIAL_RANK) {
+    for (int group = 0; group < kNumGroups; group++) {
+      for (int member = 0; member < kNumMembers; member++) {
+        Fenix_Data_member_create(group, member, data[group][member], kCount, MPI_INT);
+      }
+
+      for (int commit = 0; commit < kCommits; commit++) {
+        Fenix_Request requests[3];
+        for (int member = 0; member < kNumMembers; member++) {
+          for (int i = 0; i < kCount; i++) {
+            data[group][member][i] = value(rank, group, member, commit, i);
+          }
+          Fenix_Data_member_istore(group, member, FENIX_DATA_SUBSET_FULL, &requests[member]);
+        }
+
+        //Stands in for a compute kernel that never enters MPI.
+        usleep(20000);
+
+        for (int member = 0; member < kNumMembers; member++) {
+          Fenix_Data_wait(requests[member]);
+        }
+        Fenix_Data_commit_barrier(group, NULL);
+      }
+    }
+  } else {
+    recovered = 1;
+  }
+
+  if (rank == kKillID && recovered == 0) {
+    pid_t pid = getpid();
+    kill(pid, SIGTERM);
+  }
+
+  MPI_Barrier(new_comm);
+
+  int successful = 1;
+  for (int group = 0; group < kNumGroups; group++) {
+    for (int member = 0; member < kNumMembers; member++) {
+      Fenix_Data_member_restore(group, member, data[group][member], kCount,
+              FENIX_TIME_STAMP_MAX, NULL);
+
+      for (int i = 0; i < kCount; i++) {
+        if (data[group][member][i] != value(rank, group, member, kCommits - 1, i)) {
+          fprintf(stderr, "FAILURE rank %d group %d member %d index %d. Found: %d\n",
+                  rank, group, member, i, data[group][member][i]);
+          successful = 0;
+          break;
+        }
+      }
+    }
+  }
+
+  if (successful) {
+    printf("Rank %d successfully recovered\n", rank);
+  }
+
+  for (int group = 0; group < kNumGroups; group++) {
+    for (int member = 0; member < kNumMembers; member++) {
+      free(data[group][member]);
+    }
+  }
+  MPI_Info_free(&info);
+  Fenix_Finalize();
+  MPI_Finalize();
+  return !successful;
+}
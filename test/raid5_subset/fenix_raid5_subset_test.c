@@ -0,0 +1,186 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//
+//            _|_|_|_|  _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//            _|        _|        _|_|    _|    _|      _|  _|
+//            _|_|_|    _|_|_|    _|  _|  _|    _|        _|
+//            _|        _|        _|    _|_|    _|      _|  _|
+//            _|        _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//
+//
+//
+//
+// Copyright (C) 2016 Rutgers University and Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author Marc Gamell, Eric Valenzuela, Keita Teranishi, Manish Parashar,
+//        Michael Heroux, and Matthew Whitlock
+//
+// Questions? Contact Keita Teranishi (knteran@sandia.gov) and
+//                    Marc Gamell (mgamell@cac.rutgers.edu)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+
+#include <fenix.h>
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+//Not a multiple of the set size, so the parity stripes are uneven.
+const int kCount = 10007;
+const int kKillID = 1;
+const int kMember = 777;
+const int kCommits = 5;
+
+int value(int rank, int commit, int i) {
+  return rank*1000000 + commit*100000 + i%100000;
+}
+
+//Which elements each commit stores: everything, one run inside a stripe,
+//short runs spread over every stripe, the last element, and a run across
+//a stripe boundary.
+Fenix_Data_subset make_subset(int commit, int num_ranks) {
+  Fenix_Data_subset subset;
+  int stripe = kCount/(num_ranks - 1);
+  if (commit == 1) {
+    Fenix_Data_subset_create(1, 100, 199, 100, &subset);
+  } else if (commit == 2) {
+    Fenix_Data_subset_create(10, 3, 5, 997, &subset);
+  } else if (commit == 3) {
+    Fenix_Data_subset_create(1, kCount - 1, kCount - 1, 1, &subset);
+  } else {
+    Fenix_Data_subset_create(1, stripe - 50, stripe + 49, 100, &subset);
+  }
+  return subset;
+}
+
+int stored_in(int commit, int num_ranks, int i) {
+  int stripe = kCount/(num_ranks - 1);
+  if (commit == 0) return 1;
+  if (commit == 1) return i >= 100 && i <= 199;
+  if (commit == 2) return i >= 3 && i < 9*997 + 6 && i%997 >= 3 && i%997 <= 5;
+  if (commit == 3) return i == kCount - 1;
+  return i >= stripe - 50 && i <= stripe + 49;
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+      printf("Usage: %s <# spare ranks> \n", *argv);
+      exit(0);
+  }
+
+  int fenix_role;
+  MPI_Comm world_comm;
+  MPI_Comm new_comm;
+  int spare_ranks = atoi(argv[1]);
+  int num_ranks;
+  int rank;
+  int error;
+  int recovered = 0;
+  int *data = (int *) malloc(kCount * sizeof(int));
+
+  MPI_Init(&argc, &argv);
+  MPI_Comm_dup(MPI_COMM_WORLD, &world_comm);
+  Fenix_Init(&fenix_role, world_comm, &new_comm, &argc, &argv,
+             spare_ranks, 0, MPI_INFO_NULL, &error);
+
+  MPI_Comm_size(new_comm, &num_ranks);
+  MPI_Comm_rank(new_comm, &rank);
+
+  //Deep enough that the first full store stays underneath the subsets.
+  Fenix_Data_group_create(0, new_comm, 0, kCommits, FENIX_DATA_POLICY_IN_MEMORY_RAID,
+          (int[]){5, 1, num_ranks}, &error);
+
+  if (fenix_role == FENIX_ROLE_INITIAL_RANK) {
+    Fenix_Data_member_create(0, kMember, data, kCount, MPI_INT);
+
+    for (int commit = 0; commit < kCommits; commit++) {
+      for (int i = 0; i < kCount; i++) {
+        data[i] = value(rank, commit, i);
+      }
+
+      if (commit == 0) {
+        Fenix_Data_member_store(0, kMember, FENIX_DATA_SUBSET_FULL);
+      } else {
+        Fenix_Data_subset subset = make_subset(commit, num_ranks);
+        if (commit % 2 == 0) {
+          Fenix_Request request;
+          Fenix_Data_member_istore(0, kMember, subset, &request);
+          Fenix_Data_wait(request);
+        } else {
+          Fenix_Data_member_store(0, kMember, subset);
+        }
+        Fenix_Data_subset_delete(&subset);
+      }
+      Fenix_Data_commit_barrier(0, NULL);
+    }
+  } else {
+    recovered = 1;
+  }
+
+  if (rank == kKillID && recovered == 0) {
+    pid_t pid = getpid();
+    kill(pid, SIGTERM);
+  }
+
+  MPI_Barrier(new_comm);
+
+  Fenix_Data_member_restore(0, kMember, data, kCount, FENIX_TIME_STAMP_MAX, NULL);
+
+  int successful = 1;
+  for (int i = 0; i < kCount; i++) {
+    int commit = kCommits - 1;
+    while (!stored_in(commit, num_ranks, i)) commit--;
+    if (data[i] != value(rank, commit, i)) {
+      fprintf(stderr, "FAILURE rank %d index %d. Found: %d\n", rank, i, data[i]);
+      successful = 0;
+      break;
+    }
+  }
+
+  if (successful) {
+    printf("Rank %d successfully recovered\n", rank);
+  }
+
+  free(data);
+  Fenix_Finalize();
+  MPI_Finalize();
+  return !successful;
+}
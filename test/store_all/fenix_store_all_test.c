@@ -0,0 +1,178 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//
+//            _|_|_|_|  _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//            _|        _|        _|_|    _|    _|      _|  _|
+//            _|_|_|    _|_|_|    _|  _|  _|    _|        _|
+//            _|        _|        _|    _|_|    _|      _|  _|
+//            _|        _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//
+//
+//
+//
+// Copyright (C) 2016 Rutgers University and Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author Marc Gamell, Eric Valenzuela, Keita Teranishi, Manish Parashar,
+//        Michael Heroux, and Matthew Whitlock
+//
+// Questions? Contact Keita Teranishi (knteran@sandia.gov) and
+//                    Marc Gamell (mgamell@cac.rutgers.edu)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+
+#include <fenix.h>
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+const int kKillID = 1;
+const int kNumGroups = 3;
+const int kNumMembers = 40;
+const int kSubsetCount = 5;
+
+//Many small members of uneven sizes, as the coalesced store is meant for.
+int member_count(int member) {
+  return 8 + (member*37)%200;
+}
+
+int value(int rank, int group, int member, int commit, int i) {
+  return rank*1000000 + group*100000 + commit*10000 + member*200 + i;
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+      printf("Usage: %s <# spare ranks> \n", *argv);
+      exit(0);
+  }
+
+  int fenix_role;
+  MPI_Comm world_comm;
+  MPI_Comm new_comm;
+  int spare_ranks = atoi(argv[1]);
+  int num_ranks;
+  int rank;
+  int error;
+  int recovered = 0;
+  int *data[3][40];
+  for (int group = 0; group < kNumGroups; group++) {
+    for (int member = 0; member < kNumMembers; member++) {
+      data[group][member] = (int *) malloc(member_count(member) * sizeof(int));
+    }
+  }
+
+  MPI_Init(&argc, &argv);
+  MPI_Comm_dup(MPI_COMM_WORLD, &world_comm);
+  Fenix_Init(&fenix_role, world_comm, &new_comm, &argc, &argv,
+             spare_ranks, 0, MPI_INFO_NULL, &error);
+
+  MPI_Comm_size(new_comm, &num_ranks);
+  MPI_Comm_rank(new_comm, &rank);
+
+  Fenix_Data_group_create(0, new_comm, 0, 2, FENIX_DATA_POLICY_IN_MEMORY_RAID,
+          (int[]){1, 1}, &error);
+  Fenix_Data_group_create(1, new_comm, 0, 2, FENIX_DATA_POLICY_IN_MEMORY_RAID,
+          (int[]){5, 1, num_ranks}, &error);
+  Fenix_Data_group_create(2, new_comm, 0, 2, FENIX_DATA_POLICY_ERASURE_CODE,
+          (int[]){num_ranks - 1, 1, 1}, &error);
+
+  if (fenix_role == FENIX_ROLE_INITIAL_RANK) {
+    for (int group = 0; group < kNumGroups; group++) {
+      for (int member = 0; member < kNumMembers; member++) {
+        Fenix_Data_member_create(group, member, data[group][member], member_count(member), MPI_INT);
+      }
+
+      //A full store of every member, then one of just the first few elements.
+      Fenix_Data_subset subset;
+      Fenix_Data_subset_create(1, 0, kSubsetCount - 1, kSubsetCount, &subset);
+      for (int commit = 0; commit < 2; commit++) {
+        for (int member = 0; member < kNumMembers; member++) {
+          for (int i = 0; i < member_count(member); i++) {
+            data[group][member][i] = value(rank, group, member, commit, i);
+          }
+        }
+        Fenix_Data_member_store(group, FENIX_DATA_MEMBER_ALL,
+                commit == 0 ? FENIX_DATA_SUBSET_FULL : subset);
+        Fenix_Data_commit_barrier(group, NULL);
+      }
+      Fenix_Data_subset_delete(&subset);
+    }
+  } else {
+    recovered = 1;
+  }
+
+  if (rank == kKillID && recovered == 0) {
+    pid_t pid = getpid();
+    kill(pid, SIGTERM);
+  }
+
+  MPI_Barrier(new_comm);
+
+  int successful = 1;
+  for (int group = 0; group < kNumGroups; group++) {
+    for (int member = 0; member < kNumMembers; member++) {
+      Fenix_Data_member_restore(group, member, data[group][member], member_count(member),
+              FENIX_TIME_STAMP_MAX, NULL);
+
+      for (int i = 0; i < member_count(member); i++) {
+        int commit = i < kSubsetCount ? 1 : 0;
+        if (data[group][member][i] != value(rank, group, member, commit, i)) {
+          fprintf(stderr, "FAILURE rank %d group %d member %d index %d. Found: %d\n",
+                  rank, group, member, i, data[group][member][i]);
+          successful = 0;
+          break;
+        }
+      }
+    }
+  }
+
+  if (successful) {
+    printf("Rank %d successfully recovered\n", rank);
+  }
+
+  for (int group = 0; group < kNumGroups; group++) {
+    for (int member = 0; member < kNumMembers; member++) {
+      free(data[group][member]);
+    }
+  }
+  Fenix_Finalize();
+  MPI_Finalize();
+  return !successful;
+}
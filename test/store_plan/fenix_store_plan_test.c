@@ -0,0 +1,232 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//
+//            _|_|_|_|  _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//            _|        _|        _|_|    _|    _|      _|  _|
+//            _|_|_|    _|_|_|    _|  _|  _|    _|        _|
+//            _|        _|        _|    _|_|    _|      _|  _|
+//            _|        _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//
+//
+//
+//
+// Copyright (C) 2016 Rutgers University and Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author Marc Gamell, Eric Valenzuela, Keita Teranishi, Manish Parashar,
+//        Michael Heroux, and Matthew Whitlock
+//
+// Questions? Contact Keita Teranishi (knteran@sandia.gov) and
+//                    Marc Gamell (mgamell@cac.rutgers.edu)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+
+#include <fenix.h>
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+const int kCount = 1000;
+const int kKillID = 1;
+const int kNumGroups = 3;
+const int kNumMembers = 2;
+const int kSubsetCount = 5;
+const int kCommits = 4;
+
+int value(int rank, int group, int member, int commit, int i) {
+  return rank*1000000 + group*100000 + commit*10000 + member*1000 + i;
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+      printf("Usage: %s <# spare ranks> \n", *argv);
+      exit(0);
+  }
+
+  int fenix_role;
+  MPI_Comm world_comm;
+  MPI_Comm new_comm;
+  int spare_ranks = atoi(argv[1]);
+  int num_ranks;
+  int rank;
+  int error;
+  int recovered = 0;
+  int *data[3][2];
+  for (int group = 0; group < kNumGroups; group++) {
+    for (int member = 0; member < kNumMembers; member++) {
+      data[group][member] = (int *) malloc(kCount * sizeof(int));
+    }
+  }
+
+  MPI_Init(&argc, &argv);
+  MPI_Comm_dup(MPI_COMM_WORLD, &world_comm);
+  Fenix_Init(&fenix_role, world_comm, &new_comm, &argc, &argv,
+             spare_ranks, 0, MPI_INFO_NULL, &error);
+
+  MPI_Comm_size(new_comm, &num_ranks);
+  MPI_Comm_rank(new_comm, &rank);
+
+  Fenix_Data_group_create(0, new_comm, 0, 1, FENIX_DATA_POLICY_IN_MEMORY_RAID,
+          (int[]){1, 1}, &error);
+  Fenix_Data_group_create(1, new_comm, 0, 1, FENIX_DATA_POLICY_IN_MEMORY_RAID,
+          (int[]){5, 1, num_ranks}, &error);
+  Fenix_Data_group_create(2, new_comm, 0, 1, FENIX_DATA_POLICY_ERASURE_CODE,
+          (int[]){num_ranks - 1, 1, 1}, &error);
+
+  if (fenix_role == FENIX_ROLE_INITIAL_RANK) {
+    for (int group = 0; group < kNumGroups; group++) {
+      for (int member = 0; member < kNumMembers; member++) {
+        Fenix_Data_member_create(group, member, data[group][member], kCount, MPI_INT);
+      }
+
+      //Plans are made once and reused: odd commits only store the head of
+      //member 0, with member 1 stored without a plan alongside.
+      Fenix_Store_plan all_plan, head_plan;
+      Fenix_Data_subset head;
+      Fenix_Data_subset_create(1, 0, kSubsetCount - 1, kSubsetCount, &head);
+      Fenix_Data_store_plan_create(group, FENIX_DATA_MEMBER_ALL, FENIX_DATA_SUBSET_FULL, &all_plan);
+      Fenix_Data_store_plan_create(group, 0, head, &head_plan);
+
+      for (int commit = 0; commit < kCommits; commit++) {
+        for (int member = 0; member < kNumMembers; member++) {
+          for (int i = 0; i < kCount; i++) {
+            data[group][member][i] = value(rank, group, member, commit, i);
+          }
+        }
+        if (commit % 2 == 0) {
+          Fenix_Data_plan_store(all_plan);
+        } else {
+          Fenix_Data_plan_store(head_plan);
+          Fenix_Data_member_store(group, 1, FENIX_DATA_SUBSET_FULL);
+        }
+        Fenix_Data_commit_barrier(group, NULL);
+      }
+
+      Fenix_Data_store_plan_free(&all_plan);
+      Fenix_Data_store_plan_free(&head_plan);
+      Fenix_Data_subset_delete(&head);
+    }
+  } else {
+    recovered = 1;
+  }
+
+  if (rank == kKillID && recovered == 0) {
+    pid_t pid = getpid();
+    kill(pid, SIGTERM);
+  }
+
+  MPI_Barrier(new_comm);
+
+  int successful = 1;
+  for (int group = 0; group < kNumGroups; group++) {
+    for (int member = 0; member < kNumMembers; member++) {
+      Fenix_Data_member_restore(group, member, data[group][member], kCount,
+              FENIX_TIME_STAMP_MAX, NULL);
+
+      for (int i = 0; i < kCount; i++) {
+        int commit = (member == 0 && i >= kSubsetCount) ? kCommits - 2 : kCommits - 1;
+        if (data[group][member][i] != value(rank, group, member, commit, i)) {
+          fprintf(stderr, "FAILURE rank %d group %d member %d index %d. Found: %d\n",
+                  rank, group, member, i, data[group][member][i]);
+          successful = 0;
+          break;
+        }
+      }
+    }
+  }
+
+  //Changing what plans coalesce by goes through to plans already made, and a
+  //plan outliving its group is refused, even once the group id is reused.
+  int *extra = (int *) malloc(kCount * sizeof(int));
+  Fenix_Store_plan extra_plan;
+  Fenix_Data_group_create(3, new_comm, 0, 1, FENIX_DATA_POLICY_IN_MEMORY_RAID,
+          (int[]){1, 1}, &error);
+  Fenix_Data_member_create(3, 0, extra, kCount, MPI_INT);
+  Fenix_Data_store_plan_create(3, FENIX_DATA_MEMBER_ALL, FENIX_DATA_SUBSET_FULL, &extra_plan);
+  int chunk_size = 64;
+  int tracking = 1;
+  for (int commit = 0; commit < 3; commit++) {
+    for (int i = 0; i < kCount; i++) {
+      extra[i] = value(rank, 3, 0, commit, i);
+    }
+    if (commit == 1) {
+      Fenix_Data_member_attr_set(3, 0, FENIX_DATA_MEMBER_ATTRIBUTE_CHUNK_SIZE, &chunk_size, &error);
+    } else if (commit == 2) {
+      Fenix_Data_member_attr_set(3, 0, FENIX_DATA_MEMBER_ATTRIBUTE_DIRTY_TRACKING, &tracking, &error);
+    }
+    Fenix_Data_plan_store(extra_plan);
+    Fenix_Data_commit_barrier(3, NULL);
+  }
+  memset(extra, 0, kCount * sizeof(int));
+  Fenix_Data_member_restore(3, 0, extra, kCount, FENIX_TIME_STAMP_MAX, NULL);
+  for (int i = 0; i < kCount; i++) {
+    if (extra[i] != value(rank, 3, 0, 2, i)) {
+      fprintf(stderr, "FAILURE rank %d planned store after attribute changes, index %d. Found: %d\n",
+              rank, i, extra[i]);
+      successful = 0;
+      break;
+    }
+  }
+
+  Fenix_Data_group_delete(3);
+  Fenix_Data_group_create(3, new_comm, 0, 1, FENIX_DATA_POLICY_IN_MEMORY_RAID,
+          (int[]){1, 1}, &error);
+  if (Fenix_Data_plan_store(extra_plan) != FENIX_ERROR_INVALID_GROUPID) {
+    fprintf(stderr, "FAILURE rank %d stored a plan of a deleted group\n", rank);
+    successful = 0;
+  }
+  Fenix_Data_store_plan_free(&extra_plan);
+  Fenix_Data_group_delete(3);
+  free(extra);
+
+  if (successful) {
+    printf("Rank %d successfully recovered\n", rank);
+  }
+
+  for (int group = 0; group < kNumGroups; group++) {
+    for (int member = 0; member < kNumMembers; member++) {
+      free(data[group][member]);
+    }
+  }
+  Fenix_Finalize();
+  MPI_Finalize();
+  return !successful;
+}
@@ -63,6 +63,7 @@
 #include <signal.h>
 #include <sys/types.h>
 #include <unistd.h>
+#include <string.h>
 
 int _verify_subset( double *data, int num_blocks, int start_offset, int end_offset, int stride,
                     Fenix_Data_subset *subset_specifier );
@@ -111,6 +112,95 @@ int _verify_subset( double *data, int num_repeats, int start_offset, int end_off
 }
 
 
+/* The subset's datatype must pick out the same bytes, in the same order, as serialize */
+int _verify_subset_type( double *data, int space_size, Fenix_Data_subset *sp )
+{
+   int flag = 0;
+   size_t serialized_size;
+   void *serialized = __fenix_data_subset_serialize(sp, data, sizeof(double), space_size,
+         &serialized_size);
+
+   MPI_Datatype type;
+   __fenix_data_subset_get_type(sp, sizeof(double), space_size, &type);
+
+   int pack_size, position = 0;
+   MPI_Pack_size(1, type, MPI_COMM_SELF, &pack_size);
+   char *packed = (char *)malloc(pack_size);
+   MPI_Pack(data, 1, type, packed, pack_size, &position, MPI_COMM_SELF);
+
+   if( position != serialized_size*sizeof(double) ||
+       memcmp(packed, serialized, position) != 0 ) {
+      flag = 6;
+      printf("subset datatype does not match serialized data\n");
+   }
+
+   free(packed);
+   free(serialized);
+   return flag;
+}
+
+
+/* Overlapping and adjacent blocks must come out of the datatype once, in order */
+int _verify_overlap_type( double *data, int space_size )
+{
+   int flag = 0;
+   int starts[4] = {50, 10, 15, 30};
+   int ends[4]   = {59, 19, 29, 34};
+   Fenix_Data_subset subsets[2];
+   Fenix_Data_subset_createv(4, starts, ends, &subsets[0]);
+   Fenix_Data_subset_create(3, 0, 9, 5, &subsets[1]);
+   int expected_starts[2][2]  = {{10, 50}, {0, 0}};
+   int expected_lengths[2][2] = {{25, 10}, {20, 0}};
+   int expected_regions[2]    = {2, 1};
+
+   for( int s = 0; s < 2 && flag == 0; s++ ) {
+      int *region_starts, *region_lengths;
+      int num_regions = __fenix_data_subset_get_regions(&subsets[s], space_size,
+            &region_starts, &region_lengths);
+      if( num_regions != expected_regions[s] ) {
+         flag = 7;
+      }
+      for( int i = 0; i < num_regions && flag == 0; i++ ) {
+         if( region_starts[i] != expected_starts[s][i] ||
+             region_lengths[i] != expected_lengths[s][i] ) {
+            flag = 7;
+         }
+      }
+      free(region_starts);
+      free(region_lengths);
+      if( flag != 0 ) {
+         printf("overlapping regions not merged\n");
+         break;
+      }
+
+      MPI_Datatype type;
+      __fenix_data_subset_get_type(&subsets[s], sizeof(double), space_size, &type);
+      int pack_size, position = 0, count = 0;
+      MPI_Pack_size(1, type, MPI_COMM_SELF, &pack_size);
+      double *packed = (double *)malloc(pack_size);
+      MPI_Pack(data, 1, type, packed, pack_size, &position, MPI_COMM_SELF);
+      for( int i = 0; i < expected_regions[s]; i++ ) {
+         for( int j = 0; j < expected_lengths[s][i]; j++ ) {
+            if( count*sizeof(double) >= position ||
+                packed[count] != data[expected_starts[s][i] + j] ) {
+               flag = 8;
+            }
+            count++;
+         }
+      }
+      if( flag != 0 || count*sizeof(double) != position ) {
+         flag = 8;
+         printf("overlapping subset datatype is wrong\n");
+      }
+      free(packed);
+   }
+
+   Fenix_Data_subset_delete(&subsets[0]);
+   Fenix_Data_subset_delete(&subsets[1]);
+   return flag;
+}
+
+
 int main(int argc, char **argv)
 {
    Fenix_Data_subset subset_specifier;
@@ -142,13 +232,25 @@ int main(int argc, char **argv)
       exit(0);
    }
    
+   MPI_Init(&argc, &argv);
    d_space = (double *)malloc(sizeof(double)*space_size);
+   for( int i = 0; i < space_size; i++ ) {
+      d_space[i] = i;
+   }
    Fenix_Data_subset_create(num_blocks, start_offset, end_offset, stride, &subset_specifier);
    //data_subset_create( num_blocks, start_offset, end_offset, stride, &subset_specifier );
    // Verification
    int err_code = _verify_subset( d_space, num_blocks, start_offset, end_offset, stride, &subset_specifier );
+   if( err_code == 0 ) {
+      err_code = _verify_subset_type( d_space, space_size, &subset_specifier );
+   }
+   if( err_code == 0 && space_size >= 60 ) {
+      err_code = _verify_overlap_type( d_space, space_size );
+   }
+   __fenix_data_subset_free_type_cache();
    // free_data_subset_fixed ( &subset_specifier);
    free(d_space);
+   MPI_Finalize();
    if( err_code == 0 ) {
       printf("Passed\n");
    }
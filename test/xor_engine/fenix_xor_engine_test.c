@@ -0,0 +1,129 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//
+//            _|_|_|_|  _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//            _|        _|        _|_|    _|    _|      _|  _|
+//            _|_|_|    _|_|_|    _|  _|  _|    _|        _|
+//            _|        _|        _|    _|_|    _|      _|  _|
+//            _|        _|_|_|_|  _|      _|  _|_|_|  _|      _|
+//
+//
+//
+//
+// Copyright (C) 2016 Rutgers University and Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author Marc Gamell, Eric Valenzuela, Keita Teranishi, Manish Parashar,
+//        Michael Heroux, and Matthew Whitlock
+//
+// Questions? Contact Keita Teranishi (knteran@sandia.gov) and
+//                    Marc Gamell (mgamell@cac.rutgers.edu)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#include <fenix_xor.h> // Never called explicitly by the  users
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//Bytes around each region that must come through untouched.
+#define GUARD 64
+
+/* XORs every length below max_length at every pair of src/dest alignments
+ * below max_offset, against a byte at a time reference */
+int _verify_xor( int max_length, int max_offset )
+{
+   int size = max_length + max_offset + 2*GUARD;
+   unsigned char *src      = (unsigned char *)malloc(size);
+   unsigned char *dest     = (unsigned char *)malloc(size);
+   unsigned char *expected = (unsigned char *)malloc(size);
+
+   for( int length = 0; length < max_length; length++ ) {
+      for( int src_offset = 0; src_offset < max_offset; src_offset += 7 ) {
+         for( int dest_offset = 0; dest_offset < max_offset; dest_offset += 5 ) {
+            for( int i = 0; i < size; i++ ) {
+               src[i]  = (unsigned char)rand();
+               dest[i] = (unsigned char)rand();
+            }
+            memcpy(expected, dest, size);
+            for( int i = 0; i < length; i++ ) {
+               expected[GUARD + dest_offset + i] ^= src[GUARD + src_offset + i];
+            }
+
+            __fenix_xor_region(src + GUARD + src_offset, dest + GUARD + dest_offset, length);
+
+            if( memcmp(dest, expected, size) != 0 ) {
+               printf("XOR of %d bytes, src offset %d, dest offset %d is wrong\n",
+                      length, src_offset, dest_offset);
+               free(src);
+               free(dest);
+               free(expected);
+               return 1;
+            }
+         }
+      }
+   }
+
+   free(src);
+   free(dest);
+   free(expected);
+   return 0;
+}
+
+
+int main(int argc, char **argv)
+{
+   if (argc < 3) {
+      printf("Usage: %s <max length> <max offset> \n", *argv);
+      exit(0);
+   }
+
+   int max_length = atoi(argv[1]);
+   int max_offset = atoi(argv[2]);
+   srand(1);
+
+   // Before init this is the scalar path, after it whichever kernel the CPU has
+   int err_code = _verify_xor( max_length, max_offset );
+   if( err_code == 0 ) {
+      __fenix_xor_init();
+      err_code = _verify_xor( max_length, max_offset );
+   }
+
+   if( err_code == 0 ) {
+      printf("Passed\n");
+   }
+   return err_code;
+}